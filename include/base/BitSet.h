@@ -0,0 +1,185 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : BitSet.h (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_BITSET_H
+#define INCLUDE_BASE_BITSET_H
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <iterator>
+
+namespace base {
+/** Dynamic bit set on 64-bit words with set algebra.
+ * The bulk operations (&=, |=, ^=, andNot, isSubsetOf,
+ * intersects, count) use vectorized kernels selected at
+ * run-time (see base/cpu.h), e.g., a subsumption check
+ * is one pass of vector loads.
+ * Sets of up to INLINE_BITS bits are stored in the object
+ * itself and do not allocate.
+ * Binary operations require sets of the same size.
+ * Invariant: the bits of the last word beyond size() are 0.
+ */
+class BitSet
+{
+public:
+    using word_t = uint64_t;
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t INLINE_WORDS = 4;
+    static constexpr size_t INLINE_BITS = INLINE_WORDS * WORD_BITS;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /** @param size: number of bits, all reset. */
+    explicit BitSet(size_t size = 0);
+    BitSet(const BitSet& other);
+    BitSet(BitSet&& other) noexcept;
+    BitSet& operator=(const BitSet& other);
+    BitSet& operator=(BitSet&& other) noexcept;
+    ~BitSet();
+
+    /** @return number of bits. */
+    size_t size() const { return nbBits; }
+
+    /** @return number of words in data(). */
+    size_t wordCount() const { return wordsFor(nbBits); }
+
+    /** Change the number of bits: the bits beyond the
+     * old size are reset, the ones beyond the new size lost.
+     */
+    void resize(size_t size);
+
+    const word_t* data() const { return words; }
+    word_t* data() { return words; }
+
+    bool test(size_t i) const
+    {
+        assert(i < nbBits);
+        return (words[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+    }
+    bool operator[](size_t i) const { return test(i); }
+    void set(size_t i)
+    {
+        assert(i < nbBits);
+        words[i / WORD_BITS] |= word_t{1} << (i % WORD_BITS);
+    }
+    void reset(size_t i)
+    {
+        assert(i < nbBits);
+        words[i / WORD_BITS] &= ~(word_t{1} << (i % WORD_BITS));
+    }
+    void flip(size_t i)
+    {
+        assert(i < nbBits);
+        words[i / WORD_BITS] ^= word_t{1} << (i % WORD_BITS);
+    }
+
+    /** Set or reset all bits. */
+    void set();
+    void reset();
+
+    /** @return number of set bits. */
+    size_t count() const;
+
+    /** @return true if no bit is set. */
+    bool none() const;
+    bool any() const { return !none(); }
+
+    /** Bulk operations, @pre other.size() == size(). */
+    BitSet& operator&=(const BitSet& other);
+    BitSet& operator|=(const BitSet& other);
+    BitSet& operator^=(const BitSet& other);
+
+    /** this = this & ~other */
+    BitSet& andNot(const BitSet& other);
+
+    /** @return true if all bits set in this are set in other. */
+    bool isSubsetOf(const BitSet& other) const;
+
+    /** @return true if this and other have a common set bit. */
+    bool intersects(const BitSet& other) const;
+
+    bool operator==(const BitSet& other) const;
+
+    /** @return position of the first set bit at or after i,
+     * or npos if there is none.
+     */
+    size_t findNext(size_t i) const;
+    size_t findFirst() const { return findNext(0); }
+
+    /** Call f(i) for every set bit i, in increasing order. */
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        const size_t n = wordCount();
+        for (size_t w = 0; w < n; ++w)
+            for (word_t b = words[w]; b != 0; b &= b - 1)
+                f(w * WORD_BITS + std::countr_zero(b));
+    }
+
+    /** Forward iterator over the positions of the set bits. */
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const size_t*;
+        using reference = size_t;
+
+        const_iterator() = default;
+        size_t operator*() const { return pos; }
+        const_iterator& operator++()
+        {
+            pos = set->findNext(pos + 1);
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            auto res = *this;
+            ++*this;
+            return res;
+        }
+        bool operator==(const const_iterator& other) const { return pos == other.pos; }
+
+    private:
+        friend class BitSet;
+        const_iterator(const BitSet* set, size_t pos): set{set}, pos{pos} {}
+        const BitSet* set{nullptr};
+        size_t pos{npos};
+    };
+
+    const_iterator begin() const { return {this, findFirst()}; }
+    const_iterator end() const { return {this, npos}; }
+
+private:
+    static constexpr size_t wordsFor(size_t bits) { return (bits + WORD_BITS - 1) / WORD_BITS; }
+    bool isInline() const { return words == local; }
+    /** reset the bits of the last word beyond size() */
+    void clearTail();
+
+    word_t* words;
+    size_t nbBits;
+    size_t capacity;  // in words
+    word_t local[INLINE_WORDS];
+};
+
+inline BitSet operator&(BitSet a, const BitSet& b) { return a &= b; }
+inline BitSet operator|(BitSet a, const BitSet& b) { return a |= b; }
+inline BitSet operator^(BitSet a, const BitSet& b) { return a ^= b; }
+
+/** Print as the list of set bits, e.g., {1,4,5}. */
+std::ostream& operator<<(std::ostream& os, const BitSet& set);
+
+}  // namespace base
+
+#endif  // INCLUDE_BASE_BITSET_H
@@ -0,0 +1,147 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : CycleTimer.h (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_CYCLETIMER_H
+#define INCLUDE_BASE_CYCLETIMER_H
+
+#include "base/cpu.h"
+
+#include <chrono>
+#include <cstdint>
+
+#ifdef BASE_X86_DISPATCH
+#include <x86intrin.h>
+#endif
+
+namespace base {
+/** A monotonic timer cheap enough for fine-grained phase timing:
+ * ticks of the invariant time-stamp counter (rdtsc), about 20 cycles
+ * per reading, calibrated against std::chrono::steady_clock on the
+ * first use. Without an invariant TSC (base_CPU_TSC in base/cpu.h,
+ * which can also be masked out before the first use) the ticks are
+ * steady_clock nanoseconds.
+ * The readings are not serializing: now() may be reordered with the
+ * neighbouring instructions, use now_precise() around short sections.
+ */
+class CycleTimer
+{
+public:
+    using ticks_t = uint64_t;
+
+    explicit CycleTimer(bool running = true): paused{!running}, started{now()} {}
+
+    /** @return the current tick count */
+    static ticks_t now()
+    {
+#ifdef BASE_X86_DISPATCH
+        if (calibration().tsc) [[likely]]
+            return __rdtsc();
+#endif
+        return steady_now();
+    }
+
+    /** @return the current tick count after all the earlier instructions (rdtscp) */
+    static ticks_t now_precise()
+    {
+#ifdef BASE_X86_DISPATCH
+        if (calibration().tsc) [[likely]] {
+            unsigned aux;
+            const ticks_t t = __rdtscp(&aux);
+            _mm_lfence();  // and before the later ones
+            return t;
+        }
+#endif
+        return steady_now();
+    }
+
+    /** @return true if the ticks come from the time-stamp counter */
+    static bool uses_tsc() { return calibration().tsc; }
+
+    /** @return ticks per second */
+    static double frequency() { return calibration().frequency; }
+
+    static double to_seconds(ticks_t ticks) { return ticks * calibration().seconds; }
+    static std::chrono::nanoseconds to_duration(ticks_t ticks)
+    {
+        return std::chrono::nanoseconds{static_cast<int64_t>(ticks * calibration().seconds * 1e9)};
+    }
+
+    void pause()
+    {
+        if (!paused) {
+            paused = true;
+            ticks += now() - started;
+        }
+    }
+
+    void start()
+    {
+        if (paused) {
+            paused = false;
+            started = now();
+        }
+    }
+
+    /** restart from zero, running */
+    void reset()
+    {
+        ticks = 0;
+        paused = false;
+        started = now();
+    }
+
+    /** @return the ticks while running */
+    ticks_t getTicks() const { return paused ? ticks : ticks + (now() - started); }
+
+    /** @return the time in seconds while running */
+    double getElapsed() const { return to_seconds(getTicks()); }
+
+    class AutoStartStop
+    {
+    public:
+        explicit AutoStartStop(CycleTimer& t): timer{t} { timer.start(); }
+        ~AutoStartStop() { timer.pause(); }
+
+    private:
+        CycleTimer& timer;
+    };
+
+private:
+    struct calibration_t
+    {
+        bool tsc;          // ticks of the time-stamp counter, nanoseconds otherwise
+        double frequency;  // ticks per second
+        double seconds;    // per tick
+    };
+
+    /** detected and calibrated on the first call, thread-safe */
+    static const calibration_t& calibration()
+    {
+        static const calibration_t value = calibrate();
+        return value;
+    }
+
+    static calibration_t calibrate();
+
+    static ticks_t steady_now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    bool paused;
+    ticks_t ticks{0};  // until the last pause
+    ticks_t started;
+};
+}  // namespace base
+
+#endif  // INCLUDE_BASE_CYCLETIMER_H
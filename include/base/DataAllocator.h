@@ -17,6 +17,7 @@
 #include "base/array_t.h"
 #include "base/c_allocator.h"
 
+#include <functional>
 #include <iosfwd>
 #include <memory>
 
@@ -96,6 +97,29 @@ public:
      */
     void reset();
 
+    /** Relocation of a live block.
+     * @param data: live memory returned by allocate.
+     * @param intSize: size in int units of the block.
+     * @return the address of the block after compaction,
+     * which is data if the block did not move.
+     */
+    using relocate_t = std::function<void*(void* data, size_t intSize)>;
+
+    /** Compact the memory: move the live blocks out of sparsely
+     * used pools and give those pools back to the system.
+     * The allocator does not know which blocks are live, so the
+     * caller enumerates them.
+     * @param forEachLive: calls the given relocation on every
+     * live block allocated by this allocator and replaces all
+     * references to the block by the returned address.
+     * @param maxUsage: pools with less than this fraction of
+     * their memory in use are evacuated.
+     * @return number of bytes released.
+     * @pre all live blocks are enumerated exactly once, otherwise
+     * the blocks that are not enumerated may be released.
+     */
+    size_t compact(const std::function<void(const relocate_t&)>& forEachLive, double maxUsage = 0.5);
+
     /** Print statistics, C style.
      * @param out: where to print.
      */
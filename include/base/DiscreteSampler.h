@@ -0,0 +1,141 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : DiscreteSampler.h (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_DISCRETESAMPLER_H
+#define INCLUDE_BASE_DISCRETESAMPLER_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace base {
+/** Weighted choice of an index in [0,n) with probability
+ * weight(i)/total() in O(1) (Walker's alias method with Vose's
+ * construction in O(n)).
+ * Every column of the table is a slot of probability 1/n split between
+ * its own index and an alias: a sample is one uniform double, whose
+ * integer part picks the column and the fraction picks the side.
+ * Weights can be updated without rebuilding the table:
+ * - a decrease is a rejection with probability (bound - weight)/bound,
+ * - an increase goes to a Fenwick tree of excess weights over the
+ *   bounds, sampled in O(log n) with the probability of its mass.
+ * The table is rebuilt in O(n) when rejections or the excess exceed a
+ * half of the mass, so sampling stays O(1) expected.
+ * @tparam Rng in the samplers is RandomGenerator (base/random.h) or
+ * FastRandom (base/fast_random.hpp), or anything with uni_1().
+ */
+class DiscreteSampler
+{
+public:
+    DiscreteSampler() = default;
+
+    /** @throw RuntimeException if a weight is negative or not finite,
+     * or if there are more than 2^32-1 weights.
+     */
+    explicit DiscreteSampler(std::vector<double> weights);
+
+    size_t size() const { return weights.size(); }
+    bool empty() const { return weights.empty(); }
+
+    double weight(size_t i) const
+    {
+        assert(i < size());
+        return weights[i];
+    }
+
+    /** @return the sum of weights */
+    double total() const { return weightTotal; }
+
+    /** @return weight(i)/total() */
+    double probability(size_t i) const { return weight(i) / weightTotal; }
+
+    /** Change one weight in O(log n), or O(n) if it triggers a rebuild.
+     * @throw RuntimeException if the weight is negative or not finite.
+     */
+    void set_weight(size_t i, double weight);
+
+    /** Replace all the weights and rebuild the table in O(n).
+     * @throw RuntimeException like the constructor.
+     */
+    void assign(std::vector<double> weights);
+
+    /** @return a random index with probability weight(i)/total().
+     * @pre total() > 0
+     */
+    template <typename Rng>
+    size_t operator()(Rng& rng) const
+    {
+        assert(weightTotal > 0);
+        const Column* table = columns.data();
+        const int64_t last = static_cast<int64_t>(columns.size()) - 1;
+        for (;;) {
+            const double u = rng.uni_1() * massTotal;
+            if (u < boundTotal) [[likely]] {
+                const double column = u * scale;
+                const int64_t c = std::min(static_cast<int64_t>(column), last);  // up to rounding
+                const Column& slot = table[c];
+                // indexed instead of a branch, which mispredicts up to half of the time
+                const uint32_t sides[2] = {slot.alias, static_cast<uint32_t>(c)};
+                const size_t i = sides[(column - c) < slot.prob];
+                const double accept = accepts[i];
+                if (accept >= 1 || rng.uni_1() < accept)
+                    return i;
+            } else {
+                const size_t i = excess.find(u - boundTotal);
+                if (weights[i] > bounds[i])  // not an empty index by rounding
+                    return i;
+            }
+        }
+    }
+
+private:
+    /** column of the alias table */
+    struct Column
+    {
+        double prob;     // probability of its own index
+        uint32_t alias;  // index for the rest
+    };
+
+    /** Fenwick tree of non-negative values with prefix search */
+    class FenwickTree
+    {
+    public:
+        void reset(size_t n);
+        void add(size_t i, double delta);
+        /** @return the smallest i with a prefix sum [0,i] > x, or the last one */
+        size_t find(double x) const;
+
+    private:
+        std::vector<double> tree;  // 1-based
+        size_t top{0};             // the highest power of 2 <= size
+    };
+
+    /** Vose's construction of the table for the current weights */
+    void rebuild();
+
+    static void check(double weight);
+
+    std::vector<double> weights;
+    std::vector<double> bounds;   // weights in the table
+    std::vector<double> accepts;  // min(weight, bound) / bound, 1 for no rejection
+    std::vector<Column> columns;
+    FenwickTree excess;           // max(weight - bound, 0)
+    double weightTotal{0};
+    double boundTotal{0};
+    double excessTotal{0};
+    double massTotal{0};  // boundTotal + excessTotal
+    double scale{0};      // columns per unit of bound mass
+};
+}  // namespace base
+
+#endif  // INCLUDE_BASE_DISCRETESAMPLER_H
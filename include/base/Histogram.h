@@ -0,0 +1,151 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : Histogram.h (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_HISTOGRAM_H
+#define INCLUDE_BASE_HISTOGRAM_H
+
+#include "base/CycleTimer.h"
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace base {
+/**
+ * Histogram of non-negative integer values (e.g. latencies in
+ * CycleTimer ticks or nanoseconds) in log-linear buckets, as the HDR
+ * histogram: the values below 2^(precision+1) are exact, the others
+ * fall in 2^precision buckets per power of two, so the relative error
+ * of the reported values is below 2^-precision. With the default
+ * precision of 7 bits (< 0.8%) the whole 64-bit range takes 7424
+ * buckets.
+ * Recording is lock-free and safe from any number of threads, the
+ * queries are made on snapshots, which can be merged and serialized.
+ */
+class Histogram
+{
+public:
+    static constexpr unsigned DEFAULT_PRECISION = 7;
+    static constexpr unsigned MAX_PRECISION = 14;
+
+    /** A copy of the counts at some point, also the sum of other snapshots */
+    class Snapshot
+    {
+    public:
+        explicit Snapshot(unsigned precision = DEFAULT_PRECISION);
+
+        unsigned precision() const { return bits; }
+        uint64_t count() const { return total; }
+        bool empty() const { return total == 0; }
+        /** @return the exact extreme values recorded, 0 when empty */
+        uint64_t min() const { return total ? minimum : 0; }
+        uint64_t max() const { return maximum; }
+        /** @return the mean of the bucket midpoints */
+        double mean() const;
+        /** @return the value at the given percentile in [0,100], e.g. 99.9:
+         * the highest value of the bucket at this rank, within the recorded extremes */
+        uint64_t percentile(double p) const;
+        /** @return the number of values in the buckets of [low, high] */
+        uint64_t count_between(uint64_t low, uint64_t high) const;
+
+        /** Add the counts of another snapshot of the same precision. */
+        Snapshot& operator+=(const Snapshot& other);
+
+        /** @return a compact binary form: the nonzero counts and runs of zeros in varints */
+        std::string serialize() const;
+        /** @return the snapshot of serialize(), throws RuntimeException on malformed data */
+        static Snapshot deserialize(std::string_view data);
+
+    private:
+        friend class Histogram;
+
+        unsigned bits;
+        std::vector<uint64_t> counts;  // up to the highest nonzero bucket
+        uint64_t total{0};
+        uint64_t minimum{UINT64_MAX};
+        uint64_t maximum{0};
+    };
+
+    /** Records the CycleTimer ticks of its scope */
+    class AutoRecord
+    {
+    public:
+        explicit AutoRecord(Histogram& h): histogram{h}, start{CycleTimer::now()} {}
+        ~AutoRecord() { histogram.record(CycleTimer::now() - start); }
+
+    private:
+        Histogram& histogram;
+        CycleTimer::ticks_t start;
+    };
+
+    /** @param precision the significant bits of the buckets, 1 to MAX_PRECISION */
+    explicit Histogram(unsigned precision = DEFAULT_PRECISION);
+
+    void record(uint64_t value, uint64_t n = 1)
+    {
+        counts[index(value, bits)].fetch_add(n, std::memory_order_relaxed);
+        // rarely more than a load once the extremes settle
+        uint64_t m = minimum.load(std::memory_order_relaxed);
+        while (value < m && !minimum.compare_exchange_weak(m, value, std::memory_order_relaxed)) {}
+        m = maximum.load(std::memory_order_relaxed);
+        while (value > m && !maximum.compare_exchange_weak(m, value, std::memory_order_relaxed)) {}
+    }
+
+    /** @return the counts so far, concurrent recordings may or may not be included */
+    Snapshot snapshot() const;
+
+    /** Zero the counts, the concurrent recordings may be partially kept. */
+    void reset();
+
+    unsigned precision() const { return bits; }
+
+    /** @return the number of buckets for the given precision */
+    static size_t bucket_count(unsigned precision) { return size_t{65 - precision} << precision; }
+
+    /** @return the bucket of the value */
+    static size_t index(uint64_t value, unsigned precision)
+    {
+        const int msb = std::bit_width(value | 1) - 1;
+        const int shift = msb > int(precision) ? msb - int(precision) : 0;
+        return (size_t(shift) << precision) + (value >> shift);
+    }
+
+    /** @return the lowest value of the bucket */
+    static uint64_t lowest(size_t index, unsigned precision)
+    {
+        const size_t shift = index >> precision ? (index >> precision) - 1 : 0;
+        return uint64_t(index - (shift << precision)) << shift;
+    }
+
+    /** @return the highest value of the bucket */
+    static uint64_t highest(size_t index, unsigned precision)
+    {
+        const size_t shift = index >> precision ? (index >> precision) - 1 : 0;
+        return lowest(index, precision) + ((uint64_t{1} << shift) - 1);
+    }
+
+private:
+    unsigned bits;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts;
+    std::atomic<uint64_t> minimum{UINT64_MAX};
+    std::atomic<uint64_t> maximum{0};
+};
+
+/** count, min, mean, p50, p90, p99, p99.9 and max on one line */
+std::ostream& operator<<(std::ostream& os, const Histogram::Snapshot& s);
+}  // namespace base
+
+#endif  // INCLUDE_BASE_HISTOGRAM_H
@@ -0,0 +1,181 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : ProgressReporter.h (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_PROGRESSREPORTER_H
+#define INCLUDE_BASE_PROGRESSREPORTER_H
+
+#include "base/exceptions.h"
+#include "base/time.hpp"
+
+#include <array>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace base {
+/**
+ * Periodic progress reports of named counters, such as the states
+ * explored (a count) or the size of the waiting list (a level), with
+ * their rates and, for counts with an expected total, the estimated
+ * time to finish.
+ * Every thread feeds its own Worker: the counters are per-thread slots
+ * without contention, and the clock is read through a time_monitor
+ * (base/time.hpp) only every so many events, so Worker::tick() is
+ * cheap enough to call per state. The reports sum the slots of all the
+ * workers and go to the callback, one at a time.
+ */
+class ProgressReporter
+{
+public:
+    static constexpr size_t MAX_COUNTERS = 16;
+
+    enum class kind_t {
+        count,  // accumulated events, e.g. states explored
+        level   // current amount, e.g. waiting list size
+    };
+
+    struct counter_t
+    {
+        std::string name;
+        kind_t kind;
+        uint64_t total;  // expected final count, 0 if unknown
+        int64_t value;   // over all the workers
+        double rate;     // change per second since the previous report
+        double eta;      // seconds to the total at the smoothed rate, negative if unknown
+    };
+
+    struct Report
+    {
+        double elapsed;  // seconds since the start
+        std::vector<counter_t> counters;
+        bool final;  // from finish()
+    };
+
+    /** Called with the reporter mutex held: calling set_total(), report() or finish() from it deadlocks. */
+    using callback_t = std::function<void(const Report&)>;
+
+    /** The counters of one thread */
+    class Worker
+    {
+    public:
+        void add(size_t counter, int64_t n = 1)
+        {
+            slot(counter) += n;
+        }
+        void set(size_t counter, int64_t value)
+        {
+            slot(counter) = value;
+        }
+
+        /** Account an event, reporting if the period has passed. */
+        void tick()
+        {
+            if (monitor.has_passed()) {
+                monitor.next();
+                reporter->poll();
+            }
+        }
+
+    private:
+        friend class ProgressReporter;
+
+        struct Slot
+        {
+            std::atomic<int64_t> value{0};  // written by the owner only, no read-modify-write needed
+
+            Slot& operator+=(int64_t n)
+            {
+                value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+                return *this;
+            }
+            Slot& operator=(int64_t v)
+            {
+                value.store(v, std::memory_order_relaxed);
+                return *this;
+            }
+        };
+        using slots_t = std::array<Slot, MAX_COUNTERS>;
+
+        Worker(ProgressReporter& reporter, slots_t& slots, double period):
+            reporter{&reporter}, slots{&slots}, monitor{period}
+        {}
+
+        Slot& slot(size_t counter)
+        {
+            if (counter >= MAX_COUNTERS) [[unlikely]]
+                throw RuntimeException("ProgressReporter: bad counter %zu", counter);
+            assert(counter < reporter->nbCounters.load(std::memory_order_relaxed));
+            return (*slots)[counter];
+        }
+
+        ProgressReporter* reporter;
+        slots_t* slots;
+        time_monitor monitor;
+    };
+
+    /** @param period_in_seconds between the reports */
+    explicit ProgressReporter(callback_t callback, double period_in_seconds = 1.0);
+
+    /** @return the index of the new counter for the workers, at most MAX_COUNTERS */
+    size_t add_counter(std::string name, kind_t kind = kind_t::count, uint64_t total = 0);
+
+    /** Change the expected total of a count, 0 if unknown */
+    void set_total(size_t counter, uint64_t total);
+
+    /** @return the counters of a new thread: the slots are kept until the reporter is destroyed,
+     * so reuse the workers when the threads are recreated, e.g. a Worker per thread of a pool */
+    Worker worker();
+
+    /** Report if the period has passed, skipped if another thread is reporting. */
+    void poll();
+
+    /** Report now */
+    void report();
+
+    /** Report the final values */
+    void finish();
+
+private:
+    struct state_t
+    {
+        int64_t value{0};
+        double smoothed{0};  // rate
+        bool rated{false};
+    };
+
+    void emit(bool final);
+
+    using clock = std::chrono::steady_clock;
+
+    const callback_t callback;
+    const double period;
+    const clock::time_point start;
+    std::mutex mutex;  // of the reports and the counters
+    clock::time_point last;
+    clock::time_point due;
+    std::vector<counter_t> counters;
+    std::atomic<size_t> nbCounters{0};  // counters.size(), checked by the workers without the mutex
+    std::vector<state_t> states;
+    std::vector<std::unique_ptr<Worker::slots_t>> workers;
+};
+
+/** The report on one line: "12.0s states 1200000 (100000/s, 45%, ETA 13s) waiting 300 (+10/s)" */
+std::ostream& operator<<(std::ostream& os, const ProgressReporter::Report& report);
+}  // namespace base
+
+#endif  // INCLUDE_BASE_PROGRESSREPORTER_H
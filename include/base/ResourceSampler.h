@@ -0,0 +1,87 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : ResourceSampler.h (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_RESOURCESAMPLER_H
+#define INCLUDE_BASE_RESOURCESAMPLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace base {
+/**
+ * Samples the resource usage of the process in a background thread at
+ * a fixed interval, so the peaks between the explicit polls are not
+ * missed. The last samples are kept in a ring buffer, the peaks over
+ * all the samples.
+ * A sample is base_getProcInfo (base/platform.h), on Linux a pread of
+ * /proc/self/status and getrusage.
+ */
+class ResourceSampler
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Sample
+    {
+        clock::time_point time;
+        uint64_t mem_virt{0}, mem_work{0}, mem_swap{0};  // kB
+        uint64_t time_user{0}, time_sys{0};              // milliseconds of CPU time
+        uint64_t faults_major{0};                        // page faults with I/O
+    };
+
+    /** Start sampling, the first sample is taken before returning.
+     * @param capacity the number of the last samples kept */
+    explicit ResourceSampler(clock::duration interval = std::chrono::milliseconds{100}, size_t capacity = 3000);
+    /** Stop sampling */
+    ~ResourceSampler();
+
+    ResourceSampler(const ResourceSampler&) = delete;
+    ResourceSampler& operator=(const ResourceSampler&) = delete;
+
+    /** Take and record a sample now, from any thread */
+    Sample sample();
+
+    /** @return the last sample */
+    Sample latest() const;
+
+    /** @return the maximum of each field over all the samples, with the time of the memory peak */
+    Sample peak() const;
+
+    /** @return the kept samples from the given time, oldest first */
+    std::vector<Sample> series(clock::time_point since = {}) const;
+
+    /** @return the number of samples taken */
+    size_t count() const;
+
+    clock::duration interval() const { return period; }
+
+private:
+    void run();
+    void record(const Sample& s);
+
+    const clock::duration period;
+    std::mutex readMutex;      // serializes the reading and recording of the samples
+    mutable std::mutex mutex;  // guards the rest
+    std::condition_variable wakeup;
+    bool stopping{false};
+    std::vector<Sample> ring;
+    size_t next{0};   // the ring position of the next sample
+    size_t taken{0};  // samples so far
+    Sample maxima{};
+    std::thread worker;
+};
+}  // namespace base
+
+#endif  // INCLUDE_BASE_RESOURCESAMPLER_H
@@ -0,0 +1,306 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : RoaringBitmap.h (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_ROARINGBITMAP_H
+#define INCLUDE_BASE_ROARINGBITMAP_H
+
+#include "base/BitSet.h"
+#include "base/exceptions.h"
+#include "base/meta_visitor.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace base {
+/** Compressed bitmap of uint32_t values for sparse sets over
+ * large index spaces (roaring bitmap).
+ * Values are partitioned by their upper 16 bits, each partition
+ * is a container for the lower 16 bits in one of 3 forms:
+ * - array: sorted values, up to ARRAY_MAX values,
+ * - bitmap: 2^16 bits, above ARRAY_MAX values,
+ * - run: sorted intervals, only after runOptimize().
+ * Union and intersection work container by container with
+ * a specialized algorithm for every pair of forms.
+ * Serialization is done with visitors (base/meta_visitor.hpp),
+ * see accepts_writer and accepts_reader below.
+ */
+class RoaringBitmap
+{
+public:
+    /** containers with more values are stored as bitmaps */
+    static constexpr uint32_t ARRAY_MAX = 4096;
+    static constexpr uint32_t CONTAINER_BITS = 1u << 16;
+
+    RoaringBitmap() = default;
+
+    /** Convert from a bit string (see base/bitstring.h).
+     * @param bits: bit array
+     * @param n: size in int of the bit array
+     */
+    static RoaringBitmap fromBits(const uint32_t* bits, size_t n);
+
+    /** Convert to a bit string (see base/bitstring.h).
+     * @param bits: bit array to write
+     * @param n: size in int of the bit array
+     * @pre all the values are < n*32.
+     */
+    void toBits(uint32_t* bits, size_t n) const;
+
+    /** @return true if x was not in the set before. */
+    bool add(uint32_t x);
+
+    /** Add the values first..last (inclusive). */
+    void addRange(uint32_t first, uint32_t last);
+
+    /** @return true if x was in the set before. */
+    bool remove(uint32_t x);
+
+    bool contains(uint32_t x) const;
+
+    /** @return number of values. */
+    size_t cardinality() const;
+
+    bool empty() const { return containers.empty(); }
+    void clear()
+    {
+        containers.clear();
+        keys.clear();
+    }
+
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+
+    /** @return true if both contain the same values,
+     * whatever the form of their containers.
+     */
+    bool operator==(const RoaringBitmap& other) const;
+
+    /** Convert the containers to runs where it saves memory.
+     * Runs are converted back on the first update.
+     * @return number of containers converted.
+     */
+    size_t runOptimize();
+
+    /** @return memory used in bytes, including this object. */
+    size_t memoryUsage() const;
+
+    /** Call f(x) for every value x, in increasing order. */
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        for (const auto& c : containers) {
+            const uint32_t high = uint32_t{c.key} << 16;
+            switch (c.kind) {
+            case ARRAY:
+                for (auto low : c.array)
+                    f(high | low);
+                break;
+            case BITMAP: c.bitmap.forEach([&](size_t low) { f(high | (uint32_t)low); }); break;
+            case RUN:
+                for (auto run : c.runs)
+                    for (uint32_t low = run.first; low <= run.last; ++low)
+                        f(high | low);
+                break;
+            }
+        }
+    }
+
+    /** Serialize as a sequence of scalars: number of containers,
+     * then for every container its key (uint16_t), form (uint8_t),
+     * number of elements (uint32_t) and the elements: values
+     * (uint16_t), bitmap words (uint64_t) or runs (2 uint16_t).
+     */
+    template <typename Visitor>
+    void write(Visitor& v) const;
+
+    /** Read what write() wrote.
+     * @throw RuntimeException if the data is malformed.
+     */
+    template <typename Visitor>
+    void read(Visitor& v);
+
+private:
+    enum Kind : uint8_t { ARRAY, BITMAP, RUN };
+
+    /** inclusive interval */
+    struct Run
+    {
+        uint16_t first;
+        uint16_t last;
+    };
+
+    struct Container
+    {
+        uint16_t key{0};
+        Kind kind{ARRAY};
+        uint32_t card{0};
+        std::vector<uint16_t> array;
+        BitSet bitmap{};
+        std::vector<Run> runs;
+
+        bool contains(uint16_t low) const;
+        bool add(uint16_t low);
+        bool remove(uint16_t low);
+        void addRange(uint32_t first, uint32_t last);
+        /** @return the values as a bitmap */
+        BitSet toBitmap() const;
+        /** store a bitmap as array or bitmap depending on its cardinality */
+        void setBitmap(BitSet&& bits, uint32_t count);
+        /** store an array as array or bitmap depending on its size */
+        void setArray(std::vector<uint16_t>&& values);
+        /** convert a run container to an array or a bitmap */
+        void unrun();
+        void unionWith(const Container& other);
+        void intersectWith(const Container& other);
+    };
+
+    /** std::lower_bound with conditional moves instead of branches:
+     * searches for random values mispredict every other step otherwise.
+     */
+    static size_t lowerBound(const std::vector<uint16_t>& values, uint16_t x)
+    {
+        const uint16_t* base = values.data();
+        size_t n = values.size();
+        if (n == 0)
+            return 0;
+        while (n > 1) {
+            const size_t half = n / 2;
+            base = base[half] < x ? base + half : base;
+            n -= half;
+        }
+        return (base - values.data()) + (*base < x);
+    }
+
+    /** @return index of the container for key or of where it would be */
+    size_t find(uint16_t key) const { return lowerBound(keys, key); }
+
+    /** @return the container for key, created if needed */
+    Container& containerFor(uint16_t key);
+
+    /** rebuild keys after changing containers */
+    void updateKeys();
+
+    std::vector<Container> containers;  // sorted by key
+    std::vector<uint16_t> keys;         // keys of the containers, dense for searching
+};
+
+template <typename Visitor>
+void RoaringBitmap::write(Visitor& v) const
+{
+    auto count = static_cast<uint32_t>(containers.size());
+    v.visit(count);
+    for (const auto& c : containers) {
+        auto kind = static_cast<uint8_t>(c.kind);
+        v.visit(c.key);
+        v.visit(kind);
+        switch (c.kind) {
+        case ARRAY: {
+            auto size = static_cast<uint32_t>(c.array.size());
+            v.visit(size);
+            for (auto low : c.array)
+                v.visit(low);
+            break;
+        }
+        case BITMAP: {
+            auto size = static_cast<uint32_t>(c.bitmap.wordCount());
+            v.visit(size);
+            for (size_t i = 0; i < size; ++i)
+                v.visit(c.bitmap.data()[i]);
+            break;
+        }
+        case RUN: {
+            auto size = static_cast<uint32_t>(c.runs.size());
+            v.visit(size);
+            for (auto run : c.runs) {
+                v.visit(run.first);
+                v.visit(run.last);
+            }
+            break;
+        }
+        }
+    }
+}
+
+template <typename Visitor>
+void RoaringBitmap::read(Visitor& v)
+{
+    uint32_t count = 0;
+    v.visit(count);
+    if (count > CONTAINER_BITS)
+        throw RuntimeException("RoaringBitmap: bad container count %u", (unsigned)count);
+    // decoded aside to keep this bitmap intact if the data is malformed
+    auto result = RoaringBitmap{};
+    result.containers.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto& c = result.containers[i];
+        uint8_t kind = 0;
+        uint32_t size = 0;
+        v.visit(c.key);
+        v.visit(kind);
+        v.visit(size);
+        if (i > 0 && c.key <= result.containers[i - 1].key)
+            throw RuntimeException("RoaringBitmap: unsorted container key %u", (unsigned)c.key);
+        switch (kind) {
+        case ARRAY:
+            if (size == 0 || size > ARRAY_MAX)
+                throw RuntimeException("RoaringBitmap: bad array size %u", (unsigned)size);
+            c.kind = ARRAY;
+            c.array.resize(size);
+            for (size_t j = 0; j < size; ++j) {
+                v.visit(c.array[j]);
+                if (j > 0 && c.array[j] <= c.array[j - 1])
+                    throw RuntimeException("RoaringBitmap: unsorted array value %u", (unsigned)c.array[j]);
+            }
+            c.card = size;
+            break;
+        case BITMAP:
+            c.kind = BITMAP;
+            c.bitmap = BitSet{CONTAINER_BITS};
+            if (size != c.bitmap.wordCount())
+                throw RuntimeException("RoaringBitmap: bad bitmap size %u", (unsigned)size);
+            for (size_t w = 0; w < size; ++w)
+                v.visit(c.bitmap.data()[w]);
+            c.card = c.bitmap.count();
+            if (c.card <= ARRAY_MAX)  // would be an array
+                throw RuntimeException("RoaringBitmap: bad bitmap cardinality %u", (unsigned)c.card);
+            break;
+        case RUN:
+            if (size == 0 || size > CONTAINER_BITS / 2)
+                throw RuntimeException("RoaringBitmap: bad run count %u", (unsigned)size);
+            c.kind = RUN;
+            c.runs.resize(size);
+            c.card = 0;
+            for (size_t j = 0; j < size; ++j) {
+                auto& run = c.runs[j];
+                v.visit(run.first);
+                v.visit(run.last);
+                if (run.last < run.first || (j > 0 && run.first <= c.runs[j - 1].last))
+                    throw RuntimeException("RoaringBitmap: bad run %u..%u", (unsigned)run.first,
+                                           (unsigned)run.last);
+                c.card += run.last - run.first + 1u;
+            }
+            break;
+        default: throw RuntimeException("RoaringBitmap: bad container kind %u", (unsigned)kind);
+        }
+    }
+    result.updateKeys();
+    *this = std::move(result);
+}
+}  // namespace base
+
+namespace visitor {
+#include "base/visitor_macros.def"
+
+GENERATE_WRITE_VISITOR(base::RoaringBitmap, bitmap, bitmap.write(v);)
+GENERATE_READ_VISITOR(base::RoaringBitmap, bitmap, bitmap.read(v);)
+}  // namespace visitor
+
+#endif  // INCLUDE_BASE_ROARINGBITMAP_H
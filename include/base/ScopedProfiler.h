@@ -0,0 +1,151 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : ScopedProfiler.h (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_SCOPEDPROFILER_H
+#define INCLUDE_BASE_SCOPEDPROFILER_H
+
+#include "base/CycleTimer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace base {
+/**
+ * Hierarchical profiler of named zones: a ScopedProfiler object times
+ * its scope as a node of the call tree of its thread, under the zone
+ * entered last. The nodes count the calls, the inclusive time and the
+ * time of the nested zones (to get the exclusive time).
+ * Entering and leaving a zone takes two CycleTimer readings and a few
+ * loads and stores, without locks or allocations once the node exists.
+ * The reports merge the trees of all the threads, including the
+ * finished ones, by the paths of zones. The tree of a finished thread is
+ * continued by the next new thread, so the memory is bounded by the
+ * threads running at the same time, also with thread pools recreated
+ * per run.
+ * Use BASE_PROFILE_ZONE("name") to declare the zone and time the rest
+ * of the scope, defining BASE_NO_PROFILE compiles the zones out.
+ */
+class ScopedProfiler
+{
+public:
+    /** A zone registered once, usually a static (see BASE_PROFILE_ZONE) */
+    class Zone
+    {
+    public:
+        explicit Zone(const char* name);
+        uint32_t id() const { return zoneId; }
+
+    private:
+        uint32_t zoneId;
+    };
+
+    /** Node of the call tree of a thread */
+    struct Node
+    {
+        uint32_t zone;
+        Node* parent;
+        Node* firstChild{nullptr};   // of the owner thread only
+        Node* nextSibling{nullptr};  // of the owner thread only
+        // updated by the owner thread and read by the reports
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> ticks{0};          // inclusive
+        std::atomic<uint64_t> childrenTicks{0};  // of the nested zones
+    };
+
+    /** Aggregated node of the reports, times in seconds */
+    struct Report
+    {
+        std::string name;
+        uint64_t calls{0};
+        double inclusive{0};
+        double exclusive{0};
+        std::vector<Report> children;
+    };
+
+    explicit ScopedProfiler(const Zone& zone)
+    {
+        Node* parent = current ? current : threadRoot();
+        Node* child = parent->firstChild;
+        while (child && child->zone != zone.id())
+            child = child->nextSibling;
+        node = child ? child : addChild(parent, zone.id());
+        current = node;
+        start = CycleTimer::now();
+    }
+
+    ~ScopedProfiler()
+    {
+        const uint64_t elapsed = CycleTimer::now() - start;
+        // only this thread writes, so no read-modify-write instructions are needed
+        node->calls.store(node->calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        node->ticks.store(node->ticks.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+        Node* parent = node->parent;
+        parent->childrenTicks.store(parent->childrenTicks.load(std::memory_order_relaxed) + elapsed,
+                                    std::memory_order_relaxed);
+        current = parent;
+    }
+
+    ScopedProfiler(const ScopedProfiler&) = delete;
+    ScopedProfiler& operator=(const ScopedProfiler&) = delete;
+
+    /** @return the call tree of every thread that entered a zone, in the order of their first zones,
+     * where a tree may cover several threads one after the other */
+    static std::vector<Report> threadReports();
+
+    /** @return the call trees of all the threads merged by the paths of zones */
+    static Report report();
+
+    /** Write the merged call tree as indented text:
+     * inclusive and exclusive seconds, calls and the zone. */
+    static void writeTree(std::ostream& os);
+
+    /** Write the call trees in the Chrome trace event format (chrome://tracing,
+     * Perfetto): one complete event per node laid out as a flame chart of
+     * the aggregated times, not as a timeline. */
+    static void writeChromeTrace(std::ostream& os);
+
+    /** Write the merged call tree in the folded-stack format of flamegraph.pl:
+     * the path of zones and the exclusive microseconds, one line per node. */
+    static void writeFolded(std::ostream& os);
+
+    /** Zero all the counters, while no other thread is in a zone. */
+    static void reset();
+
+private:
+    static Node* threadRoot();
+    static Node* addChild(Node* parent, uint32_t zone);
+
+    static inline thread_local Node* current{nullptr};
+
+    Node* node;
+    CycleTimer::ticks_t start;
+};
+}  // namespace base
+
+#define BASE_PROFILE_CONCAT_(a, b) a##b
+#define BASE_PROFILE_CONCAT(a, b) BASE_PROFILE_CONCAT_(a, b)
+
+#ifdef BASE_NO_PROFILE
+#define BASE_PROFILE_ZONE(name) static_assert(true, name)
+#else
+/** Time the rest of the scope as the zone of the given name (string literal). */
+#define BASE_PROFILE_ZONE(name)                                                                          \
+    static const base::ScopedProfiler::Zone BASE_PROFILE_CONCAT(base_profile_zone_, __LINE__){name};    \
+    const base::ScopedProfiler BASE_PROFILE_CONCAT(base_profile_scope_, __LINE__)                        \
+    {                                                                                                    \
+        BASE_PROFILE_CONCAT(base_profile_zone_, __LINE__)                                                \
+    }
+#endif
+
+#endif  // INCLUDE_BASE_SCOPEDPROFILER_H
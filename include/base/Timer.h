@@ -19,7 +19,8 @@
 #include <chrono>
 
 namespace base {
-/** A simple timer to measure CPU time.
+/** A simple timer to measure the elapsed time on the monotonic steady
+ * clock, see CycleTimer for the fine-grained timing.
  */
 class Timer
 {
@@ -51,7 +52,7 @@ public:
 private:
     std::chrono::nanoseconds nanoseconds{0};
     bool paused = false;
-    std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> timer;
+    std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> timer;
 };
 }  // namespace base
 
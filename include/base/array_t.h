@@ -115,8 +115,9 @@ private:
     void ensurePos(size_t at)
     {
         if (at >= pointer_t<T>::capa) {
-            auto newData = new T[at + INC];
+            auto newData = new T[at + INC]{};
             std::copy(pointer_t<T>::data, pointer_t<T>::data + pointer_t<T>::capa, newData);
+            delete[] pointer_t<T>::data;
             pointer_t<T>::data = newData;
             pointer_t<T>::capa = at + INC;
         }
@@ -31,12 +31,38 @@ extern "C" {
  */
 typedef enum { ZERO = 0, ONE = 1 } bit_t;
 
+/** Strings of bits longer than this (in ints) are processed
+ * by the out-of-line kernels below, which are dispatched at
+ * run-time to the best instruction set (see base/cpu.h).
+ * Shorter strings are cheaper to process inline.
+ */
+#define BASE_BITS_INLINE_MAX 8
+
+/** Out-of-line version of base_countBitsN for long strings.
+ * Uses AVX512-VPOPCNTDQ, AVX2, POPCNT or portable 64-bit code.
+ */
+uint32_t base_countBitsNWide(const uint32_t* bitString, size_t n);
+
+/** Out-of-line version of base_areBitsReset for long strings.
+ * Uses AVX512, AVX2 or portable 64-bit code.
+ */
+bool base_areBitsResetWide(const uint32_t* bits, size_t n);
+
+/** Out-of-line version of base_areBitsEqual for long strings.
+ * Uses AVX512, AVX2 or portable 64-bit code.
+ */
+bool base_areBitsEqualWide(const uint32_t* bits1, const uint32_t* bits2, size_t n);
+
 /** Bit counting function.
  * @return: the number of 1s in a given int
  * @param x: the int to examine.
  */
 static inline uint32_t base_countBits(uint32_t x)
 {
+#if defined(__POPCNT__) || (defined(__GNUC__) && !defined(__i386__) && !defined(__x86_64__))
+    /* hardware instruction (x86 without -mpopcnt calls a slow library function) */
+    return __builtin_popcount(x);
+#else
     /* algorithm: count bits in parallel (hack) */
     x -= (x & 0xaaaaaaaa) >> 1;
     x = ((x >> 2) & 0x33333333L) + (x & 0x33333333L);
@@ -44,6 +70,7 @@ static inline uint32_t base_countBits(uint32_t x)
     x = ((x >> 8) + x);
     x = ((x >> 16) + x) & 0xff;
     return x;
+#endif
 }
 
 /** Bit counting function.
@@ -55,22 +82,27 @@ static inline uint32_t base_countBitsN(const uint32_t* bitString, size_t n)
 {
     uint32_t cnt;
     assert(n == 0 || bitString);
+    if (n > BASE_BITS_INLINE_MAX)
+        return base_countBitsNWide(bitString, n);
     for (cnt = 0; n != 0; --n)
         cnt += base_countBits(*bitString++);
     return cnt;
 }
 
 /** Reset of bits (to 0).
- * memset could be used but for strings of
- * bits of length 3-4 ints max, it is overkill.
- * Conversely, for larger arrays, don't use this
- * function.
+ * memset is overkill for strings of bits of
+ * length 3-4 ints max, so it is used only
+ * for longer strings.
  * @param bits: the string to reset
  * @param n: number of ints to write.
  */
 static inline void base_resetBits(uint32_t* bits, size_t n)
 {
     assert(n == 0 || bits);
+    if (n > BASE_BITS_INLINE_MAX) {
+        memset(bits, 0, n * sizeof(uint32_t));
+        return;
+    }
     for (; n != 0; --n)
         *bits++ = 0;
 }
@@ -85,6 +117,8 @@ static inline bool base_areBitsReset(const uint32_t* bits, size_t n)
 {
     uint32_t diff = 0; /* accumulate the difference to 0 */
     assert(n == 0 || bits);
+    if (n > BASE_BITS_INLINE_MAX)
+        return base_areBitsResetWide(bits, n);
     for (; n != 0; --n)
         diff |= *bits++;
     return (diff == 0);
@@ -106,6 +140,8 @@ static inline bool base_areBitsEqual(const uint32_t* bits1, const uint32_t* bits
 {
     uint32_t diff = 0;
     assert(n == 0 || (bits1 && bits2));
+    if (n > BASE_BITS_INLINE_MAX)
+        return base_areBitsEqualWide(bits1, bits2, n);
     for (; n != 0; --n)
         diff |= *bits1++ ^ *bits2++;
     return (diff == 0);
@@ -213,6 +249,24 @@ static inline uint32_t base_readOneBit(const uint32_t* bits, size_t i)
  */
 size_t base_bits2indexTable(const uint32_t* bits, size_t n, cindex_t* table);
 
+/** Pack an index table to a bit table, inverse of
+ * base_bits2indexTable: the positions of the set bits
+ * are given in order of their indirection.
+ * @param indices: positions of the bits, indices[k] is
+ * the position that base_bits2indexTable maps to k.
+ * @param size: number of indices
+ * @param bits: bit array to write
+ * @param n: size in int of the bit array
+ * @pre
+ * - indices is strictly increasing and all indices < n*32
+ * - bits is at least a uint32_t[n]
+ * @post
+ * - exactly the bits at the given positions are set
+ * - base_bits2indexTable(bits, n, table) returns size
+ *   and table[indices[k]] == k for all k < size.
+ */
+void base_indexTable2bits(const cindex_t* indices, size_t size, uint32_t* bits, size_t n);
+
 #ifdef __cplusplus
 }
 
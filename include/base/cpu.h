@@ -0,0 +1,69 @@
+/* -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/*********************************************************************
+ *
+ * Filename : cpu.h (base)
+ * C/C++ header.
+ *
+ * Run-time detection of instruction set extensions used to dispatch
+ * vectorized kernels (bitstring.h, intutils.h) and of the time-stamp
+ * counter (CycleTimer.h).
+ *
+ * This file is a part of the UPPAAL toolkit.
+ * Copyright (c) 2026, Aalborg University.
+ * All right reserved.
+ *
+ *********************************************************************/
+
+#ifndef INCLUDE_BASE_CPU_H
+#define INCLUDE_BASE_CPU_H
+
+#include "base/inttypes.h"
+
+/* Kernels for a specific instruction set are compiled with the target
+ * attribute and selected at run-time, so the library itself is built
+ * for the baseline architecture. Only GCC and Clang on x86 support it,
+ * other targets use the portable kernels.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BASE_X86_DISPATCH
+#define BASE_TARGET(ISA) __attribute__((target(ISA)))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Instruction set extensions, as bit flags.
+ */
+typedef enum {
+    base_CPU_POPCNT = 1 << 0,       /**< popcnt                               */
+    base_CPU_BMI2 = 1 << 1,         /**< bmi1 + bmi2 (tzcnt, pdep, pext)      */
+    base_CPU_SSE2 = 1 << 2,         /**< sse2                                 */
+    base_CPU_AVX2 = 1 << 3,         /**< avx2                                 */
+    base_CPU_AVX512 = 1 << 4,       /**< avx512f + avx512bw + avx512vl        */
+    base_CPU_AVX512POPCNT = 1 << 5, /**< avx512vpopcntdq (implies base_CPU_AVX512) */
+    base_CPU_TSC = 1 << 6,          /**< invariant time-stamp counter + rdtscp */
+    base_CPU_ALL = (1 << 7) - 1
+} cpufeature_t;
+
+/** @return the features supported by the processor (and the OS)
+ * restricted by the mask set with base_setCPUFeatureMask.
+ */
+uint32_t base_getCPUFeatures(void);
+
+/** Restrict the features used by the dispatched kernels,
+ * e.g. to test or benchmark the fallbacks.
+ * @param mask: features allowed, base_CPU_ALL by default.
+ */
+void base_setCPUFeatureMask(uint32_t mask);
+
+/** @return true if all the given features are available.
+ * @param features: a combination of cpufeature_t flags.
+ */
+static inline bool base_hasCPUFeatures(uint32_t features) { return (base_getCPUFeatures() & features) == features; }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_BASE_CPU_H */
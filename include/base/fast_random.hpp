@@ -0,0 +1,294 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+///////////////////////////////////////////////////////////////////////////////
+//
+// This file is a part of UPPAAL.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_FAST_RANDOM_HPP
+#define INCLUDE_BASE_FAST_RANDOM_HPP
+
+#include "base/random_distributions.hpp"
+#include "base/random_engines.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace base {
+/** @return 64 random bits, from one or two engine outputs (low half first) */
+template <typename Engine>
+inline uint64_t random_bits64(Engine& engine)
+{
+    if constexpr (sizeof(typename Engine::result_type) == 8) {
+        return engine();
+    } else {
+        const uint64_t lo = engine();
+        return lo | uint64_t{engine()} << 32;
+    }
+}
+
+/** @return uniform double in [0,1) from the upper 53 bits of w */
+inline double random_unit(uint64_t w) { return static_cast<double>(static_cast<int64_t>(w >> 11)) * 0x1.0p-53; }
+
+/**
+ * Ziggurat of 256 layers of equal area under the exponential or the
+ * normal density f (G. Marsaglia, W. W. Tsang "The Ziggurat Method for
+ * Generating Random Variables", 2000). Layer i>0 is [0,x[i]) x
+ * [f(x[i]),f(x[i+1])), layer 0 is the base strip together with the tail
+ * beyond x[1], and x[256] = 0.
+ * One 64-bit word gives a layer (lowest 8 bits) and a point z in it
+ * (upper 53 bits), which is accepted at once if z < x[i+1] (98-99%).
+ * The normal variates take their sign from bit 8 of the word.
+ */
+class ziggurat
+{
+public:
+    static constexpr size_t LAYERS = 256;
+    static constexpr uint64_t SIGN_BIT = LAYERS;
+
+    /** tables of the standard exponential and normal distributions, built once */
+    static const ziggurat& exponential()
+    {
+        static const auto table = ziggurat{false};
+        return table;
+    }
+    static const ziggurat& normal()
+    {
+        static const auto table = ziggurat{true};
+        return table;
+    }
+
+    /** x[0..LAYERS], for vectorized first tries */
+    const double* layers() const { return x; }
+    /** SIGN_BIT for the normal distribution, 0 for the exponential */
+    uint64_t sign_mask() const { return symmetric; }
+
+    /** @return a variate starting with the word w, drawing more from engine if rejected */
+    template <typename Engine>
+    double operator()(Engine& engine, uint64_t w) const
+    {
+        const size_t i = w & (LAYERS - 1);
+        double z = random_unit(w) * x[i];
+        if (!(z < x[i + 1])) [[unlikely]]
+            z = retry(engine, i, z);
+        return (w & symmetric) ? -z : z;
+    }
+
+    template <typename Engine>
+    double operator()(Engine& engine) const
+    {
+        return (*this)(engine, random_bits64(engine));
+    }
+
+    /** @return the magnitude for a rejected first try z in layer i:
+     * wedge test, tail or a new try
+     */
+    template <typename Engine>
+    double retry(Engine& engine, size_t i, double z) const
+    {
+        for (;;) {
+            if (i == 0)
+                return tail(engine);
+            if (f[i] + random_unit(random_bits64(engine)) * (f[i + 1] - f[i]) < pdf(z))
+                return z;
+            const uint64_t w = random_bits64(engine);
+            i = w & (LAYERS - 1);
+            z = random_unit(w) * x[i];
+            if (z < x[i + 1])
+                return z;
+        }
+    }
+
+private:
+    explicit ziggurat(bool normal): symmetric{normal ? SIGN_BIT : 0}
+    {
+        // base strip beyond r and area v of the layers, from the paper
+        const double r = normal ? 3.6541528853610088 : 7.69711747013104972;
+        const double v = normal ? 0.00492867323399 : 0.0039496598225815571993;
+        x[0] = v / pdf(r);
+        x[1] = r;
+        for (size_t i = 1; i + 1 < LAYERS; ++i) {
+            const double y = pdf(x[i]) + v / x[i];
+            x[i + 1] = normal ? std::sqrt(-2 * std::log(y)) : -std::log(y);
+        }
+        x[LAYERS] = 0;
+        for (size_t i = 0; i <= LAYERS; ++i)
+            f[i] = pdf(x[i]);
+    }
+
+    /** unnormalized density */
+    double pdf(double z) const { return symmetric ? std::exp(-0.5 * z * z) : std::exp(-z); }
+
+    template <typename Engine>
+    double tail(Engine& engine) const
+    {
+        const double r = x[1];
+        if (!symmetric)  // memoryless: r plus another exponential
+            return r - std::log1p(-random_unit(random_bits64(engine)));
+        double a, b;  // Marsaglia 1964
+        do {
+            a = -std::log1p(-random_unit(random_bits64(engine))) / r;
+            b = -std::log1p(-random_unit(random_bits64(engine)));
+        } while (b + b < a * a);
+        return r + a;
+    }
+
+    uint64_t symmetric;
+    double x[LAYERS + 1];
+    double f[LAYERS + 1];  // f[i] = pdf(x[i])
+};
+
+/**
+ * Header-only variant of RandomGenerator (base/random.h) for inner loops:
+ * the engine is a member and all the methods are inline templates, so the
+ * compiler can inline a whole draw. The variates come from closed forms,
+ * the Ziggurat method and rejection methods (base/random_distributions.hpp)
+ * instead of boost, so the values differ from RandomGenerator for the
+ * same seed.
+ * @tparam Engine: UniformRandomBitGenerator of 32 or 64 bits covering
+ * the whole range, e.g. from base/random_engines.hpp.
+ */
+template <typename Engine = philox4x32>
+class FastRandom
+{
+public:
+    using engine_type = Engine;
+
+    FastRandom(uint64_t seed = 0, uint64_t stream = 0): engine{seed, stream} {}
+    explicit FastRandom(const Engine& engine): engine{engine} {}
+
+    Engine& get_engine() { return engine; }
+
+    /** uniform distribution for [0,max], without bias (D. Lemire, "Fast
+     * random integer generation in an interval", 2019)
+     */
+    uint32_t uni(uint32_t max)
+    {
+        if (max == std::numeric_limits<uint32_t>::max())
+            return bits32();
+        const uint32_t range = max + 1;
+        uint64_t m = uint64_t{bits32()} * range;
+        if (static_cast<uint32_t>(m) < range) [[unlikely]] {
+            const uint32_t threshold = -range % range;
+            while (static_cast<uint32_t>(m) < threshold)
+                m = uint64_t{bits32()} * range;
+        }
+        return m >> 32;
+    }
+
+    /** uniform distribution for unsigned [from,till] */
+    uint32_t uni(uint32_t from, uint32_t till)
+    {
+        assert(from <= till);
+        return from + uni(till - from);
+    }
+
+    /** uniform distribution for signed [from,till] */
+    int32_t uni(int32_t from, int32_t till)
+    {
+        assert(from <= till);
+        return static_cast<int32_t>(static_cast<uint32_t>(from) +
+                                    uni(static_cast<uint32_t>(till) - static_cast<uint32_t>(from)));
+    }
+
+    /** uniform distribution for double [0,1) */
+    double uni_1() { return random_unit(random_bits64(engine)); }
+
+    /** uniform distribution for double [0,max)
+     * @param max exclusive upper bound should be positive and finite */
+    double uni_r(double max)
+    {
+        assert(max > 0. && max <= std::numeric_limits<double>::max());
+        const double r = uni_1() * max;
+        return r < max ? r : std::nextafter(max, 0.);  // rounding up
+    }
+
+    /** uniform distribution for double [from,till)
+     * @param from inclusive lower bound should be finite
+     * @param till exclusive upper bound should be finite
+     */
+    double uni_r(double from, double till)
+    {
+        assert(from < till);
+        assert(from >= std::numeric_limits<double>::lowest() && till <= std::numeric_limits<double>::max());
+        const double u = uni_1();
+        const double r = from + u * (till - from);  // till - from may overflow to infinity
+        if (std::isfinite(r)) [[likely]]
+            return r < till ? r : std::nextafter(till, from);
+        return (1 - u) * from + u * till;
+    }
+
+    /** exponential distribution for double with given rate */
+    double exp(double rate)
+    {
+        assert(rate != 0);
+        return ziggurat::exponential()(engine) / rate;
+    }
+
+    /** arcsine distribution with given min and max values */
+    double arcsine(double minv, double maxv) { return draw(arcsine_distribution{minv, maxv}); }
+
+    /** beta distribution with the given shape parameters */
+    double beta(double alpha, double beta) { return draw(beta_distribution{alpha, beta}); }
+
+    /** gamma distribution with given shape and scale */
+    double gamma(double shape, double scale) { return draw(gamma_distribution{shape, scale}); }
+
+    /** Gaussian/Normal distribution with given mean and standard deviation */
+    double normal(double mean, double stddev) { return mean + stddev * ziggurat::normal()(engine); }
+
+    /** Poisson distribution with given mean */
+    double poisson(double mean) { return draw(poisson_distribution{mean}); }
+
+    /** Weibull distribution with given shape and scale */
+    double weibull(double shape, double scale) { return draw(weibull_distribution{shape, scale}); }
+
+    /** triangular distribution with given lower, mode and upper points */
+    double tri(double lower, double mode, double upper)
+    {
+        assert(lower <= mode && mode <= upper);
+        const double range = upper - lower;
+        const double u = uni_1();
+        if (u * range < mode - lower)
+            return lower + std::sqrt(u * range * (mode - lower));
+        return upper - std::sqrt((1 - u) * range * (upper - mode));
+    }
+
+    /** a variate of a distribution of base/random_distributions.hpp */
+    template <typename Distribution>
+    double draw(const Distribution& dist)
+    {
+        return dist(*this);
+    }
+
+    /** the distributions with their parameters bound and precomputed once */
+    auto make_arcsine(double minv, double maxv) { return bind(arcsine_distribution{minv, maxv}); }
+    auto make_beta(double alpha, double beta) { return bind(beta_distribution{alpha, beta}); }
+    auto make_gamma(double shape, double scale) { return bind(gamma_distribution{shape, scale}); }
+    auto make_poisson(double mean) { return bind(poisson_distribution{mean}); }
+    auto make_weibull(double shape, double scale) { return bind(weibull_distribution{shape, scale}); }
+
+private:
+    template <typename Distribution>
+    bound_distribution<FastRandom, Distribution> bind(const Distribution& dist)
+    {
+        return {*this, dist};
+    }
+
+    uint32_t bits32()
+    {
+        if constexpr (sizeof(typename Engine::result_type) == 8)
+            return engine() >> 32;
+        else
+            return engine();
+    }
+
+    Engine engine;
+};
+}  // namespace base
+
+#endif /* INCLUDE_BASE_FAST_RANDOM_HPP */
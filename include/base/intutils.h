@@ -23,6 +23,7 @@ extern "C" {
 #endif
 
 #include "base/inttypes.h"
+#include "base/relation.h"
 
 /**
  * Check if an unsigned integer is a power of two
@@ -57,6 +58,57 @@ void base_fill(int32_t* from, int32_t* to, uint32_t intval);
  */
 bool base_areEqual(const void* data1, const void* data2, size_t intSize);
 
+/** Find the first difference.
+ * @param data1,data2: data to be compared.
+ * @param intSize: size in int to compare.
+ * @return the smallest i such that data1[i] != data2[i],
+ * or intSize if the contents are the same.
+ * @pre data1 and data2 are of size int32_t[intSize]
+ */
+size_t base_firstDifference(const int32_t* data1, const int32_t* data2, size_t intSize);
+
+/** Lexicographic three-way comparison, in one pass.
+ * @param data1,data2: data to be compared.
+ * @param intSize: size in int to compare.
+ * @return <0, 0, >0 if data1 is respectively before,
+ * the same as, or after data2.
+ * @pre data1 and data2 are of size int32_t[intSize]
+ */
+static inline int base_compare(const int32_t* data1, const int32_t* data2, size_t intSize)
+{
+    size_t i = base_firstDifference(data1, data2, intSize);
+    return i == intSize ? 0 : (data1[i] < data2[i] ? -1 : 1);
+}
+
+/** Point-wise relation between vectors, e.g., inclusion of
+ * zones represented by their bounds.
+ * @param data1,data2: vectors to compare.
+ * @param intSize: size in int of the vectors.
+ * @return base_EQUAL if data1[i] == data2[i] for all i,
+ * base_SUBSET if data1[i] <= data2[i] for all i,
+ * base_SUPERSET if data1[i] >= data2[i] for all i,
+ * base_DIFFERENT otherwise, as soon as it is known.
+ * @pre data1 and data2 are of size int32_t[intSize]
+ */
+relation_t base_relation(const int32_t* data1, const int32_t* data2, size_t intSize);
+
+/** Relations between one vector and many, e.g., a zone against
+ * the zones of a passed list: the kernel is selected once for
+ * the batch and data1 stays in cache.
+ * @param data1: vector to compare.
+ * @param data2: vectors to compare with.
+ * @param count: number of vectors in data2.
+ * @param intSize: size in int of the vectors.
+ * @param relations: where to write the results,
+ * relations[k] = base_relation(data1, data2[k], intSize).
+ * @return number of vectors data1 is included in,
+ * i.e., of relations that are base_SUBSET or base_EQUAL.
+ * @pre data1 and all data2[k] are of size int32_t[intSize],
+ * relations is of size relation_t[count].
+ */
+size_t base_relations(const int32_t* data1, const int32_t* const* data2, size_t count, size_t intSize,
+                      relation_t* relations);
+
 /** @return (x < 0 ? ~x : x) without a jump!
  * @param x: int to test.
  */
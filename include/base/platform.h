@@ -54,6 +54,7 @@ typedef struct procinfo_t
     // process information in kB and milliseconds:
     uint64_t mem_virt, mem_work, mem_swap;    // memory configuration
     uint64_t time_user, time_sys, time_real;  // CPU time usage
+    uint64_t faults_major;                    // page faults with I/O (0 if not available)
 } procinfo_t;
 
 /** Initializes the process information gathering. */
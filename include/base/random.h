@@ -11,21 +11,63 @@
 #ifndef INCLUDE_BASE_RANDOM_H
 #define INCLUDE_BASE_RANDOM_H
 
+#include "base/random_distributions.hpp"
+
 #include <memory>
 #include <cinttypes>
-
+#include <cstddef>
+
+/**
+ * Random variates on a selectable engine, the counter-based
+ * base::philox4x32 by default (see base/random_engines.hpp).
+ * A generator is identified by a seed and a stream: the streams of
+ * a seed are statistically independent, so parallel workers should
+ * use RandomGenerator(seed, worker) or split() instead of reseeding.
+ */
 class RandomGenerator
 {
 public:
+    /** Randomness engines, in the order of the state size:
+     * - philox: Philox4x32-10, 48 bytes, O(1) jump, vectorized bulk variates,
+     * - xoshiro256pp: xoshiro256++, 32 bytes, fastest raw output,
+     * - pcg64: PCG XSL-RR 128/64, 32 bytes, O(log n) jump,
+     * - mt19937: Mersenne twister, 2.5KB and slow to seed, seeded with
+     *   seed + stream to reproduce the sequences of earlier versions.
+     */
+    enum class engine_t : uint8_t { philox, xoshiro256pp, pcg64, mt19937 };
+
+    /** next stream of the globally shared seed, thread-safe */
     RandomGenerator();
+
+    /** the given stream of the given seed, e.g., one per worker thread:
+     * the results are reproducible for a given seed and number of workers.
+     */
+    RandomGenerator(uint64_t seed, uint64_t stream);
+    RandomGenerator(uint64_t seed, uint64_t stream, engine_t engine);
+
+    RandomGenerator(RandomGenerator&&) noexcept;
+    RandomGenerator& operator=(RandomGenerator&&) noexcept;
     ~RandomGenerator() noexcept;
 
-    /** set globally shared random seed */
+    /** set globally shared random seed and restart its streams */
     static void set_seed(uint32_t seed);
 
-    /** random seed */
+    /** set the engine of generators constructed without one */
+    static void set_engine(engine_t engine);
+
+    engine_t engine() const;
+
+    /** random seed: restart stream 0 of the given seed */
     void seed(uint32_t seed);
 
+    /** @return a generator on a new stream of the same seed,
+     * derived from this stream and the number of earlier splits.
+     */
+    RandomGenerator split();
+
+    /** skip the next n engine outputs: O(1) for philox, O(log n) for pcg64, O(n) otherwise */
+    void jump(uint64_t n);
+
     /** uniform distribution for [0,max] */
     uint32_t uni(uint32_t max);
 
@@ -72,7 +114,54 @@ public:
     /** triangular distribution with given lower, mode and upper points */
     double tri(const double lower, const double mode, const double upper);
 
+    /* Bulk variants: fill out[0..n) several times faster than n single calls
+     * by generating the engine output in blocks and transforming it in
+     * vectorizable loops. The values are reproducible for a given stream,
+     * but differ from the single-call variants.
+     */
+
+    /** uniform distribution for double [0,1) with 53 random bits */
+    void fill_uni_1(double* out, size_t n);
+
+    /** exponential distribution with given rate (Ziggurat method) */
+    void fill_exp(double rate, double* out, size_t n);
+
+    /** Gaussian/Normal distribution with given mean and standard deviation (Ziggurat method) */
+    void fill_normal(double mean, double stddev, double* out, size_t n);
+
+    /* Parameter-bound variants: the distributions with the constants for
+     * their parameters computed once (base/random_distributions.hpp), drawing
+     * from this generator, which must outlive them. For the parameters
+     * reused in many draws, e.g.
+     *     auto g = rng.make_gamma(shape, scale);
+     *     for (...) x = g();
+     * The values differ from the single-call variants.
+     */
+
+    /** a variate of dist, drawn from the engine directly */
+    double draw(const base::arcsine_distribution& dist);
+    double draw(const base::beta_distribution& dist);
+    double draw(const base::gamma_distribution& dist);
+    double draw(const base::poisson_distribution& dist);
+    double draw(const base::weibull_distribution& dist);
+
+    using arcsine_t = base::bound_distribution<RandomGenerator, base::arcsine_distribution>;
+    using beta_t = base::bound_distribution<RandomGenerator, base::beta_distribution>;
+    using gamma_t = base::bound_distribution<RandomGenerator, base::gamma_distribution>;
+    using poisson_t = base::bound_distribution<RandomGenerator, base::poisson_distribution>;
+    using weibull_t = base::bound_distribution<RandomGenerator, base::weibull_distribution>;
+
+    arcsine_t make_arcsine(double minv, double maxv) { return {*this, {minv, maxv}}; }
+    beta_t make_beta(double alpha, double beta) { return {*this, {alpha, beta}}; }
+    gamma_t make_gamma(double shape, double scale) { return {*this, {shape, scale}}; }
+    poisson_t make_poisson(double mean) { return {*this, base::poisson_distribution{mean}}; }
+    weibull_t make_weibull(double shape, double scale) { return {*this, {shape, scale}}; }
+
 private:
+    /** the draw of any of the distributions above, defined in random.cpp */
+    template <typename Distribution>
+    double draw_from_engine(const Distribution& dist);
+
     struct internalstate;              // hide the complexity of internal details
     std::unique_ptr<internalstate> s;  // pIMPL pattern
 };
@@ -0,0 +1,194 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+///////////////////////////////////////////////////////////////////////////////
+//
+// This file is a part of UPPAAL.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_RANDOM_DISTRIBUTIONS_HPP
+#define INCLUDE_BASE_RANDOM_DISTRIBUTIONS_HPP
+
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+/* Distributions with the constants for their parameters computed once,
+ * for the parameters reused in many draws. A distribution draws from
+ * any Rng with uni_1() for uniform [0,1) and normal(mean, stddev), e.g.
+ * FastRandom (base/fast_random.hpp), usually through the make_* methods
+ * of FastRandom and RandomGenerator (base/random.h).
+ */
+namespace base {
+/** gamma distribution with given shape and scale (G. Marsaglia, W. W. Tsang,
+ * "A simple method for generating gamma variables", 2000): a shape below 1
+ * is boosted by one and the result scaled by u^(1/shape).
+ */
+class gamma_distribution
+{
+public:
+    gamma_distribution(double shape, double scale):
+        d{(shape < 1 ? shape + 1 : shape) - 1. / 3}, c{1 / std::sqrt(9 * d)}, scale{scale},
+        boost{shape < 1 ? 1 / shape : 0}
+    {
+        assert(shape > 0 && scale > 0);
+    }
+
+    template <typename Rng>
+    double operator()(Rng& rng) const
+    {
+        for (;;) {
+            double x, v;
+            do {
+                x = rng.normal(0., 1.);
+                v = 1 + c * x;
+            } while (v <= 0);
+            v = v * v * v;
+            const double u = rng.uni_1();
+            const double x2 = x * x;
+            // squeeze, then the exact test
+            if (u < 1 - 0.0331 * x2 * x2 || std::log(u) < 0.5 * x2 + d * (1 - v + std::log(v))) {
+                if (boost == 0)
+                    return d * v * scale;
+                return d * v * scale * std::pow(1 - rng.uni_1(), boost);
+            }
+        }
+    }
+
+private:
+    double d, c;  // of Marsaglia and Tsang
+    double scale;
+    double boost;  // 1/shape for a shape below 1, 0 otherwise
+};
+
+/** beta distribution with the given shape parameters, X/(X+Y) for gammas X and Y */
+class beta_distribution
+{
+public:
+    beta_distribution(double alpha, double beta): x{alpha, 1}, y{beta, 1} {}
+
+    template <typename Rng>
+    double operator()(Rng& rng) const
+    {
+        const double a = x(rng), b = y(rng);
+        return a / (a + b);
+    }
+
+private:
+    gamma_distribution x, y;
+};
+
+/** Poisson distribution with given mean: multiplication of uniforms for
+ * small means, PTRS otherwise (W. Hörmann, "The transformed rejection
+ * method for generating Poisson random variables", 1993).
+ */
+class poisson_distribution
+{
+public:
+    explicit poisson_distribution(double mean): mean{mean}
+    {
+        assert(mean > 0);
+        if (mean < SMALL) {
+            limit = std::exp(-mean);
+        } else {
+            logMean = std::log(mean);
+            b = 0.931 + 2.53 * std::sqrt(mean);
+            a = -0.059 + 0.02483 * b;
+            invAlpha = 1.1239 + 1.1328 / (b - 3.4);
+            vr = 0.9277 - 3.6224 / (b - 2);
+        }
+    }
+
+    template <typename Rng>
+    double operator()(Rng& rng) const
+    {
+        if (mean < SMALL) {
+            double k = 0, p = 1 - rng.uni_1();
+            while (p > limit) {
+                p *= 1 - rng.uni_1();
+                ++k;
+            }
+            return k;
+        }
+        for (;;) {
+            const double u = rng.uni_1() - 0.5;
+            const double v = rng.uni_1();
+            const double us = 0.5 - std::abs(u);
+            const double k = std::floor((2 * a / us + b) * u + mean + 0.43);
+            if (us >= 0.07 && v <= vr)
+                return k;
+            if (k < 0 || (us < 0.013 && v > us))
+                continue;
+            if (std::log(v * invAlpha / (a / (us * us) + b)) <= -mean + k * logMean - std::lgamma(k + 1))
+                return k;
+        }
+    }
+
+private:
+    static constexpr double SMALL = 10;  // expected number of uniforms to multiply
+
+    double mean;
+    double limit{0};  // exp(-mean) for small means
+    double logMean{0}, a{0}, b{0}, invAlpha{0}, vr{0};
+};
+
+/** Weibull distribution with given shape and scale, by the inverse CDF */
+class weibull_distribution
+{
+public:
+    weibull_distribution(double shape, double scale): exponent{1 / shape}, scale{scale}
+    {
+        assert(shape > 0 && scale > 0);
+    }
+
+    template <typename Rng>
+    double operator()(Rng& rng) const
+    {
+        return scale * std::pow(-std::log(1 - rng.uni_1()), exponent);
+    }
+
+private:
+    double exponent;
+    double scale;
+};
+
+/** arcsine distribution with given min and max values, by the inverse CDF */
+class arcsine_distribution
+{
+public:
+    arcsine_distribution(double minv, double maxv): minv{minv}, range{maxv - minv} { assert(minv <= maxv); }
+
+    template <typename Rng>
+    double operator()(Rng& rng) const
+    {
+        const double s = std::sin(std::numbers::pi / 2 * rng.uni_1());
+        return minv + range * s * s;
+    }
+
+private:
+    double minv;
+    double range;
+};
+
+/** A distribution bound to a generator, which must outlive it:
+ * auto g = rng.make_gamma(shape, scale); double x = g();
+ * @tparam Rng has draw(dist) for the variates of dist.
+ */
+template <typename Rng, typename Distribution>
+class bound_distribution
+{
+public:
+    bound_distribution(Rng& rng, const Distribution& dist): rng{&rng}, dist{dist} {}
+
+    double operator()() const { return rng->draw(dist); }
+
+    const Distribution& distribution() const { return dist; }
+
+private:
+    Rng* rng;
+    Distribution dist;
+};
+}  // namespace base
+
+#endif /* INCLUDE_BASE_RANDOM_DISTRIBUTIONS_HPP */
@@ -0,0 +1,330 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+///////////////////////////////////////////////////////////////////////////////
+//
+// This file is a part of UPPAAL.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_BASE_RANDOM_ENGINES_HPP
+#define INCLUDE_BASE_RANDOM_ENGINES_HPP
+
+#include <array>
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
+#include <limits>
+
+namespace base {
+/** SplitMix64 output function: a bijective mixer of 64-bit values,
+ * used to derive seeds and stream identifiers.
+ */
+constexpr uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Counter-based random engine Philox4x32-10 from
+ * J. Salmon et al. "Parallel random numbers: as easy as 1, 2, 3", SC 2011.
+ * The output is a keyed bijection of a 128-bit counter: the seed is the key,
+ * the upper half of the counter selects a stream and the lower half is the
+ * position in the stream. Therefore the streams of a seed are independent,
+ * jumping is O(1) and the state is 48 bytes.
+ * Satisfies the UniformRandomBitGenerator requirements.
+ */
+class philox4x32
+{
+public:
+    using result_type = uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit philox4x32(uint64_t seed = 0, uint64_t stream = 0) { this->seed(seed, stream); }
+
+    /** restart the given stream of the given seed */
+    void seed(uint64_t seed, uint64_t stream = 0)
+    {
+        key = {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+        set_stream(stream);
+    }
+
+    /** restart at the beginning of another stream of the same seed */
+    void set_stream(uint64_t stream)
+    {
+        counter = {0, 0, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+        index = 4;
+    }
+
+    result_type operator()()
+    {
+        if (index == 4) {
+            block = generate(counter, key);
+            next();
+            index = 0;
+        }
+        return block[index++];
+    }
+
+    /** Write the next n outputs, the same as n calls of operator().
+     * Whole blocks are generated in groups of independent counters,
+     * which the compiler vectorizes.
+     */
+    void fill(result_type* out, size_t n) { fill(out, n, generate_blocks); }
+
+    /** fill() with another implementation of generate_blocks, e.g. a vectorized one */
+    template <typename Blocks>
+    void fill(result_type* out, size_t n, Blocks&& generate_blocks)
+    {
+        for (; n > 0 && index < 4; --n)
+            *out++ = block[index++];
+        const size_t blocks = n / 4;
+        generate_blocks(counter, key, out, blocks);
+        const uint64_t pos = (counter[0] | uint64_t{counter[1]} << 32) + blocks;
+        counter[0] = static_cast<uint32_t>(pos);
+        counter[1] = static_cast<uint32_t>(pos >> 32);
+        out += blocks * 4;
+        for (n %= 4; n > 0; --n)
+            *out++ = (*this)();
+    }
+
+    /** skip n outputs in O(1) */
+    void discard(uint64_t n)
+    {
+        const uint64_t pos = position() + n;
+        counter[0] = static_cast<uint32_t>(pos / 4);
+        counter[1] = static_cast<uint32_t>(pos / 4 >> 32);
+        index = 4;
+        if (pos % 4 != 0) {
+            block = generate(counter, key);
+            next();
+            index = pos % 4;
+        }
+    }
+
+    /** @return number of outputs produced in the current stream */
+    uint64_t position() const
+    {
+        const uint64_t blocks = counter[0] | uint64_t{counter[1]} << 32;
+        return index == 4 ? blocks * 4 : (blocks - 1) * 4 + index;
+    }
+
+    uint64_t stream() const { return counter[2] | uint64_t{counter[3]} << 32; }
+
+    /** one block: 10 rounds of the Philox S-box with key schedule */
+    static constexpr std::array<uint32_t, 4> generate(std::array<uint32_t, 4> ctr, std::array<uint32_t, 2> k)
+    {
+        for (int round = 0; round < 10; ++round) {
+            const uint64_t p0 = uint64_t{0xD2511F53} * ctr[0];
+            const uint64_t p1 = uint64_t{0xCD9E8D57} * ctr[2];
+            ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ k[0], static_cast<uint32_t>(p1),
+                   static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ k[1], static_cast<uint32_t>(p0)};
+            k[0] += 0x9E3779B9;
+            k[1] += 0xBB67AE85;
+        }
+        return ctr;
+    }
+
+    /** Write count consecutive blocks starting at counter ctr (position part incremented). */
+    static void generate_blocks(std::array<uint32_t, 4> ctr, std::array<uint32_t, 2> k, result_type* out,
+                                size_t count)
+    {
+        constexpr size_t LANES = 8;
+        uint64_t pos = ctr[0] | uint64_t{ctr[1]} << 32;
+        for (; count >= LANES; count -= LANES, pos += LANES, out += 4 * LANES) {
+            // structure of arrays: one lane per block
+            uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+            for (size_t l = 0; l < LANES; ++l) {
+                c0[l] = static_cast<uint32_t>(pos + l);
+                c1[l] = static_cast<uint32_t>((pos + l) >> 32);
+                c2[l] = ctr[2];
+                c3[l] = ctr[3];
+            }
+            uint32_t k0 = k[0], k1 = k[1];
+            for (int round = 0; round < 10; ++round) {
+                for (size_t l = 0; l < LANES; ++l) {
+                    const uint64_t p0 = uint64_t{0xD2511F53} * c0[l];
+                    const uint64_t p1 = uint64_t{0xCD9E8D57} * c2[l];
+                    c0[l] = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+                    c1[l] = static_cast<uint32_t>(p1);
+                    c2[l] = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+                    c3[l] = static_cast<uint32_t>(p0);
+                }
+                k0 += 0x9E3779B9;
+                k1 += 0xBB67AE85;
+            }
+            for (size_t l = 0; l < LANES; ++l) {
+                out[4 * l] = c0[l];
+                out[4 * l + 1] = c1[l];
+                out[4 * l + 2] = c2[l];
+                out[4 * l + 3] = c3[l];
+            }
+        }
+        for (; count > 0; --count, ++pos, out += 4) {
+            const auto b = generate({static_cast<uint32_t>(pos), static_cast<uint32_t>(pos >> 32), ctr[2], ctr[3]}, k);
+            for (size_t i = 0; i < 4; ++i)
+                out[i] = b[i];
+        }
+    }
+
+    friend bool operator==(const philox4x32& a, const philox4x32& b)
+    {
+        return a.key == b.key && a.stream() == b.stream() && a.position() == b.position();
+    }
+
+private:
+    /** advance the position part of the counter */
+    void next()
+    {
+        if (++counter[0] == 0)
+            ++counter[1];
+    }
+
+    std::array<uint32_t, 4> counter;
+    std::array<uint32_t, 2> key;
+    std::array<uint32_t, 4> block{};
+    uint32_t index;
+};
+/**
+ * xoshiro256++ by D. Blackman and S. Vigna, "Scrambled linear
+ * pseudorandom number generators", 2021: 32 bytes of state and a few
+ * cycles per 64-bit output. Streams are seeded by SplitMix64 from the
+ * seed and stream number, so they are independent with overwhelming
+ * probability but cannot be jumped to: discard(n) is O(n).
+ * Satisfies the UniformRandomBitGenerator requirements.
+ */
+class xoshiro256pp
+{
+public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit xoshiro256pp(uint64_t seed = 0, uint64_t stream = 0) { this->seed(seed, stream); }
+
+    void seed(uint64_t seed, uint64_t stream = 0)
+    {
+        // consecutive SplitMix64 outputs, never all zero
+        const uint64_t z = seed + splitmix64(stream);
+        for (size_t i = 0; i < 4; ++i)
+            state[i] = splitmix64(z + i * 0x9E3779B97F4A7C15ULL);
+    }
+
+    result_type operator()()
+    {
+        const uint64_t res = std::rotl(state[0] + state[3], 23) + state[0];
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = std::rotl(state[3], 45);
+        return res;
+    }
+
+    void discard(uint64_t n)
+    {
+        for (; n > 0; --n)
+            (*this)();
+    }
+
+    friend bool operator==(const xoshiro256pp& a, const xoshiro256pp& b) { return a.state == b.state; }
+
+private:
+    std::array<uint64_t, 4> state;
+};
+
+/**
+ * PCG64 (XSL-RR 128/64) by M. E. O'Neill, "PCG: A family of simple fast
+ * space-efficient statistically good algorithms for random number
+ * generation", 2014: a 128-bit linear congruential generator with a
+ * permuted output. The stream selects the increment of the LCG, which
+ * gives 2^63 distinct sequences, and discard(n) is O(log n).
+ * Same outputs as pcg64(seed, stream) of the reference implementation.
+ * Satisfies the UniformRandomBitGenerator requirements.
+ */
+class pcg64
+{
+public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit pcg64(uint64_t seed = 0, uint64_t stream = 0) { this->seed(seed, stream); }
+
+    void seed(uint64_t seed, uint64_t stream = 0)
+    {
+        inc = {stream << 1 | 1, stream >> 63};
+        state = add(u128{seed, 0}, inc);
+        step();
+    }
+
+    result_type operator()()
+    {
+        step();
+        const unsigned rot = state.hi >> 58;
+        return std::rotr(state.hi ^ state.lo, rot);
+    }
+
+    /** skip n outputs in O(log n) by composing the LCG steps */
+    void discard(uint64_t n)
+    {
+        u128 mult = MULTIPLIER, plus = inc;
+        u128 accMult{1, 0}, accPlus{0, 0};
+        for (; n > 0; n >>= 1) {
+            if (n & 1) {
+                accMult = mul(accMult, mult);
+                accPlus = add(mul(accPlus, mult), plus);
+            }
+            plus = mul(add(mult, u128{1, 0}), plus);
+            mult = mul(mult, mult);
+        }
+        state = add(mul(accMult, state), accPlus);
+    }
+
+    friend bool operator==(const pcg64& a, const pcg64& b)
+    {
+        return a.state.lo == b.state.lo && a.state.hi == b.state.hi && a.inc.lo == b.inc.lo && a.inc.hi == b.inc.hi;
+    }
+
+private:
+    struct u128
+    {
+        uint64_t lo, hi;
+    };
+    static constexpr u128 MULTIPLIER{0x4385DF649FCCF645ULL, 0x2360ED051FC65DA4ULL};
+
+    static u128 add(u128 a, u128 b)
+    {
+        const uint64_t lo = a.lo + b.lo;
+        return {lo, a.hi + b.hi + (lo < a.lo)};
+    }
+
+    static u128 mul(u128 a, u128 b)
+    {
+#ifdef __SIZEOF_INT128__
+        __extension__ using wide_t = unsigned __int128;
+        const auto p = static_cast<wide_t>(a.lo) * b.lo;
+        return {static_cast<uint64_t>(p), static_cast<uint64_t>(p >> 64) + a.lo * b.hi + a.hi * b.lo};
+#else
+        const uint64_t a0 = a.lo & 0xFFFFFFFF, a1 = a.lo >> 32, b0 = b.lo & 0xFFFFFFFF, b1 = b.lo >> 32;
+        const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+        const uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+        const uint64_t hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+        return {(mid << 32) | (p00 & 0xFFFFFFFF), hi + a.lo * b.hi + a.hi * b.lo};
+#endif
+    }
+
+    void step() { state = add(mul(state, MULTIPLIER), inc); }
+
+    u128 state;
+    u128 inc;  // odd
+};
+}  // namespace base
+
+#endif /* INCLUDE_BASE_RANDOM_ENGINES_HPP */
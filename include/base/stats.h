@@ -17,50 +17,91 @@
 #ifndef INCLUDE_BASE_STATS_H
 #define INCLUDE_BASE_STATS_H
 
-#ifdef SHOW_STATS
-
-#include "hash/tables.h"
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
 
 namespace base {
+/** Named counters with optional sub-counters, thread-safe.
+ * A counter is registered once per name and sub-name, and every thread
+ * increments its own slot of it, so counting is a plain add without
+ * locks or hashing. The slots of all the threads, also the finished
+ * ones, are summed when the counters are read or printed. The slots of a
+ * finished thread are continued by the next new thread, so the memory is
+ * bounded by the threads running at the same time.
+ * The global instance prints the counters at exit, if any.
+ */
 class Stats
 {
 public:
-    Stats() {}
-    ~Stats();
-
-    void count(const char* statName, const char* subStat = NULL);
+    using slot_t = std::atomic<int64_t>;
 
-    struct stat_t
+    /** A registered counter, usually a static of the counting site */
+    class Counter
     {
-        stat_t(const char* statName, stat_t* nxt): name(statName), counter(1), next(nxt) {}
-        ~stat_t() { delete next; }
+    public:
+        /** The names must outlive the counter, e.g. literals. */
+        explicit Counter(const char* statName, const char* subStat = nullptr);
 
-        const char* name;
-        int64_t counter;
-        stat_t* next;
-    };
+        /** @return the slot of the calling thread, which stays valid */
+        slot_t* slot() const;
 
-    struct entry_t : public uhash::TableSingle<entry_t>::Bucket_t
-    {
-        entry_t(const char* name, stat_t* next = NULL): stat(name, next) {}
+        void increment() const { add(*slot()); }
 
-        stat_t stat;  // Main stat, with list of sub-stats.
+    private:
+        uint32_t id;
     };
 
-private:
-    uhash::TableSingle<entry_t> table;
+    Stats() = default;
+    ~Stats();
+
+    /** Increment by name: takes a lock, prefer Counter or the macros. */
+    void count(const char* statName, const char* subStat = nullptr);
+
+    /** @return the sum of the counter over all the threads, 0 if not registered */
+    int64_t get(const char* statName, const char* subStat = nullptr) const;
+
+    /** Print the counters sorted by name, the sub-counters with their share of the main counter. */
+    void print(std::ostream& os) const;
+
+    /** Only the owner thread writes a slot, so no read-modify-write instructions are needed. */
+    static void add(slot_t& slot, int64_t n = 1)
+    {
+        slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
 };
 
 extern Stats stats;
 }  // namespace base
 
-// Typical way of using stats:
+// Typical way of using stats. A site caches the counter of its first names and
+// counts other names (different pointers) by Stats::count, which takes a lock:
+
+#ifdef SHOW_STATS
 
-#define RECORD_STAT()        base::stats.count(__PRETTY_FUNCTION__, NULL)
-#define RECORD_SUBSTAT(NAME) base::stats.count(__PRETTY_FUNCTION__, NAME)
-#define RECORD_NSTAT(ROOT, NAME)   \
-    base::stats.count(ROOT, NULL); \
-    base::stats.count(ROOT, NAME)
+#define RECORD_STAT()        BASE_STATS_COUNT(__PRETTY_FUNCTION__, nullptr)
+#define RECORD_SUBSTAT(NAME) BASE_STATS_COUNT(__PRETTY_FUNCTION__, NAME)
+#define RECORD_NSTAT(ROOT, NAME)           \
+    do {                                   \
+        BASE_STATS_COUNT(ROOT, nullptr);   \
+        BASE_STATS_COUNT(ROOT, NAME);      \
+    } while (0)
+
+/** Resolve the slot of the site once per thread, then add to it. */
+#define BASE_STATS_COUNT(ROOT, NAME)                                                              \
+    do {                                                                                          \
+        const char* const base_stats_root = ROOT;                                                 \
+        const char* const base_stats_name = NAME;                                                 \
+        static const char* const base_stats_first_root = base_stats_root;                         \
+        static const char* const base_stats_first_name = base_stats_name;                         \
+        static const base::Stats::Counter base_stats_counter{base_stats_root, base_stats_name};   \
+        static thread_local base::Stats::slot_t* const base_stats_slot =                          \
+            base_stats_counter.slot();                                                            \
+        if (base_stats_root == base_stats_first_root && base_stats_name == base_stats_first_name) \
+            base::Stats::add(*base_stats_slot);                                                   \
+        else                                                                                      \
+            base::stats.count(base_stats_root, base_stats_name);                                  \
+    } while (0)
 
 #else
 
@@ -15,6 +15,7 @@
 #define INCLUDE_DEBUG_MONITOR_H
 
 #include <stddef.h>
+#include <stdio.h>
 
 #ifdef ENABLE_MONITOR
 
@@ -65,6 +66,18 @@ void debug_pushPosition(const char* filename, int line, const char* function);
  */
 void debug_pop();
 
+/** Write a heap profile of the sampled allocations when sampling
+ * (DEBUG_NEW_SAMPLE is set to the mean bytes between samples, see new.h).
+ * @param file: where to write the profile, in the heap format of pprof
+ * @return 0 if the allocations are not sampled, 1 otherwise
+ */
+int debug_writeHeapProfile(FILE* file);
+
+/** @return the bytes currently allocated with new,
+ * 0 when sampling (DEBUG_NEW_SAMPLE is set, see new.h)
+ */
+size_t debug_allocatedMemory(void);
+
 /* Macros to simplify calls */
 
 #define debug_remember(TYPE, PTR) ((TYPE)debug_rememberPointer(PTR, __FILE__, __LINE__, __FUNCTION__))
@@ -32,6 +32,13 @@
  *
  * NOTE: defining NDEBUG will *not* skip this, which allows for
  * optimized compilation with new monitor.
+ *
+ * Environment, read at the first allocation:
+ * - DEBUG_NEW_SAMPLE=<bytes> to sample about one in <bytes> allocated bytes
+ *   with stack traces instead of tracking all the allocations, for heap
+ *   profiles at a low overhead (no leak check, no positions)
+ * - DEBUG_NEW_PROFILE=<file> to write the sampled heap profile at exit
+ *   in the heap format of pprof instead of printing the top allocation sites
  */
 
 #ifndef INCLUDE_DEBUG_NEW_H
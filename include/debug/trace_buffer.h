@@ -0,0 +1,326 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+///////////////////////////////////////////////////////////////////////////////
+//
+// This file is a part of UPPAAL.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef DEBUG_TRACE_BUFFER_H
+#define DEBUG_TRACE_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace tracing {
+/**
+ * Binary trace entries in per-thread lock-free ring buffers, formatted
+ * later by another thread (see trace_t::start_writer) or post-mortem
+ * (trace_t::flush).
+ * An entry is a time stamp, an actor, the raw bytes of the arguments and
+ * their decoder, an instance of a function template for the argument
+ * types, which serves as the format id. Strings are copied, the other
+ * trivially copyable arguments are stored as is, anything else (also
+ * pointers) is formatted into a string when recorded.
+ * Every thread writes its own ring, the reader takes the entries of all
+ * the rings in time order. An entry which does not fit is dropped and
+ * counted, recording never blocks. The ring of an exited thread is
+ * drained as usual and then reused by the next new thread, so the rings
+ * are as many as the threads recording at the same time.
+ */
+class trace_buffer
+{
+public:
+    using clock = std::chrono::high_resolution_clock;
+    using decoder_t = void (*)(std::ostream&, const std::byte*);
+
+    struct header_t
+    {
+        int64_t ts;  // clock ticks since the epoch
+        uint32_t actor;
+        uint32_t size;  // of the arguments
+        decoder_t decoder;
+    };
+
+    /** @param capacity of the ring of each thread in bytes, rounded up to a power of two */
+    explicit trace_buffer(size_t capacity = size_t{1} << 20):
+        capacity{std::bit_ceil(std::max(capacity, size_t{256}))}, instance{next_instance()}
+    {}
+
+    trace_buffer(const trace_buffer&) = delete;
+    trace_buffer& operator=(const trace_buffer&) = delete;
+
+    template <typename... Msg>
+    void record(uint32_t actor, const Msg&... msg)
+    {
+        const auto ts = clock::now().time_since_epoch().count();
+        record_prepared(ts, actor, prepare(msg)...);
+    }
+
+    /** Take the entries recorded so far, in time order.
+     * @param f is called with the time stamp, actor and the decoded arguments. */
+    template <typename F>
+    void drain(F&& f)
+    {
+        auto taken = std::vector<std::pair<header_t, std::string>>{};
+        {
+            auto lock = std::lock_guard{reader};  // one reader at a time
+            for (const auto& r : snapshot())     // without blocking claim()
+                r->pop_all([&](const header_t& h, const std::vector<std::byte>& bytes) {
+                    auto os = std::ostringstream{};
+                    h.decoder(os, bytes.data());
+                    taken.emplace_back(h, std::move(os).str());
+                });
+        }
+        std::stable_sort(taken.begin(), taken.end(),
+                         [](const auto& a, const auto& b) { return a.first.ts < b.first.ts; });
+        for (const auto& [h, text] : taken)
+            f(clock::time_point{clock::duration{h.ts}}, h.actor, std::string_view{text});
+    }
+
+    /** @return the number of entries dropped for the lack of space */
+    uint64_t dropped() const
+    {
+        auto lock = std::lock_guard{mutex};
+        uint64_t n = 0;
+        for (const auto& r : rings)
+            n += r->dropped.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    /** @return the number of the rings allocated, each of the capacity */
+    size_t nb_rings() const
+    {
+        auto lock = std::lock_guard{mutex};
+        return rings.size();
+    }
+
+private:
+    /** Single-producer single-consumer ring of bytes */
+    struct ring_t
+    {
+        explicit ring_t(size_t capacity): data(capacity), mask{capacity - 1} {}
+
+        std::vector<std::byte> data;
+        const size_t mask;
+        alignas(64) std::atomic<uint64_t> head{0};  // written by the owner thread
+        std::atomic<uint64_t> dropped{0};           // written by the owner thread
+        alignas(64) std::atomic<uint64_t> tail{0};  // written by the reader
+        std::atomic<bool> owned{true};              // by a running thread, released when it exits
+
+        void copy_in(uint64_t pos, const void* src, size_t n)
+        {
+            const size_t at = pos & mask, first = std::min(n, data.size() - at);
+            std::memcpy(data.data() + at, src, first);
+            std::memcpy(data.data(), static_cast<const std::byte*>(src) + first, n - first);
+        }
+
+        void copy_out(uint64_t pos, void* dst, size_t n) const
+        {
+            const size_t at = pos & mask, first = std::min(n, data.size() - at);
+            std::memcpy(dst, data.data() + at, first);
+            std::memcpy(static_cast<std::byte*>(dst) + first, data.data(), n - first);
+        }
+
+        bool push(const header_t& h, const std::byte* args)
+        {
+            const uint64_t pos = head.load(std::memory_order_relaxed);
+            const size_t total = sizeof(h) + h.size;
+            if (data.size() - (pos - tail.load(std::memory_order_acquire)) < total) {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+            copy_in(pos, &h, sizeof(h));
+            copy_in(pos + sizeof(h), args, h.size);
+            head.store(pos + total, std::memory_order_release);
+            return true;
+        }
+
+        template <typename F>
+        void pop_all(F&& f)
+        {
+            uint64_t pos = tail.load(std::memory_order_relaxed);
+            const uint64_t end = head.load(std::memory_order_acquire);
+            auto args = std::vector<std::byte>{};
+            while (pos < end) {
+                header_t h;
+                copy_out(pos, &h, sizeof(h));
+                args.resize(h.size);
+                copy_out(pos + sizeof(h), args.data(), h.size);
+                pos += sizeof(h) + h.size;
+                f(h, args);
+            }
+            tail.store(pos, std::memory_order_release);
+        }
+    };
+
+    /** a string argument, stored as its length and bytes */
+    struct string_arg
+    {};
+
+    template <typename T>
+    static constexpr bool is_string = std::is_convertible_v<const T&, std::string_view>;
+
+    template <typename T>
+    static constexpr bool is_raw = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>;
+
+    template <typename T>
+    using stored_t = std::conditional_t<is_string<T>, string_arg, T>;
+
+    /** @return the argument, or its text when it is stored as text */
+    template <typename T>
+    static decltype(auto) prepare(const T& value)
+    {
+        if constexpr (is_string<T> || is_raw<T>) {
+            return (value);
+        } else {
+            auto os = std::ostringstream{};
+            os << value;
+            return std::move(os).str();
+        }
+    }
+
+    template <typename T>
+    static size_t arg_size(const T& value)
+    {
+        if constexpr (is_string<T>)
+            return sizeof(uint32_t) + std::string_view{value}.size();
+        else
+            return sizeof(T);
+    }
+
+    template <typename T>
+    static void put(std::byte*& p, const T& value)
+    {
+        if constexpr (is_string<T>) {
+            const auto s = std::string_view{value};
+            const auto n = static_cast<uint32_t>(s.size());
+            std::memcpy(p, &n, sizeof(n));
+            std::memcpy(p + sizeof(n), s.data(), n);
+            p += sizeof(n) + n;
+        } else {
+            std::memcpy(p, &value, sizeof(T));
+            p += sizeof(T);
+        }
+    }
+
+    template <typename Stored>
+    static void print(std::ostream& os, const std::byte*& p)
+    {
+        if constexpr (std::is_same_v<Stored, string_arg>) {
+            uint32_t n;
+            std::memcpy(&n, p, sizeof(n));
+            os << std::string_view{reinterpret_cast<const char*>(p + sizeof(n)), n};
+            p += sizeof(n) + n;
+        } else {
+            alignas(Stored) std::byte value[sizeof(Stored)];
+            std::memcpy(value, p, sizeof(Stored));
+            os << *std::launder(reinterpret_cast<const Stored*>(value));
+            p += sizeof(Stored);
+        }
+    }
+
+    /** The format id: prints the arguments of the given stored types */
+    template <typename... Stored>
+    static void decode([[maybe_unused]] std::ostream& os, [[maybe_unused]] const std::byte* p)
+    {
+        (print<Stored>(os, p), ...);
+    }
+
+    template <typename... Args>
+    void record_prepared(int64_t ts, uint32_t actor, const Args&... args)
+    {
+        const size_t size = (size_t{0} + ... + arg_size(args));
+        thread_local auto scratch = std::vector<std::byte>{};
+        scratch.resize(size);
+        [[maybe_unused]] std::byte* p = scratch.data();
+        (put(p, args), ...);
+        local().push(header_t{ts, actor, static_cast<uint32_t>(size), &decode<stored_t<Args>...>}, scratch.data());
+    }
+
+    /** The rings of a thread by the buffer instance, the last used first */
+    struct local_t
+    {
+        struct entry_t
+        {
+            uint64_t instance;
+            ring_t* ring;
+            std::weak_ptr<ring_t> alive;  // expires with the buffer
+        };
+        std::vector<entry_t> entries;
+
+        /** releases the rings to the threads to come */
+        ~local_t()
+        {
+            for (const auto& e : entries)
+                if (auto ring = e.alive.lock())
+                    ring->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    /** @return the ring of the calling thread, taken on the first use */
+    ring_t& local()
+    {
+        thread_local auto cache = local_t{};
+        auto& entries = cache.entries;
+        if (entries.empty() || entries.front().instance != instance) {
+            auto it = std::find_if(entries.begin(), entries.end(), [this](const auto& e) { return e.instance == instance; });
+            if (it == entries.end()) {
+                std::erase_if(entries, [](const auto& e) { return e.alive.expired(); });
+                auto ring = claim();
+                entries.push_back({instance, ring.get(), ring});
+                it = std::prev(entries.end());
+            }
+            std::iter_swap(entries.begin(), it);
+        }
+        return *entries.front().ring;
+    }
+
+    /** @return the rings so far */
+    std::vector<std::shared_ptr<ring_t>> snapshot() const
+    {
+        auto lock = std::lock_guard{mutex};
+        return rings;
+    }
+
+    /** @return a ring released by an exited thread, or a new one */
+    std::shared_ptr<ring_t> claim()
+    {
+        auto lock = std::lock_guard{mutex};
+        for (const auto& r : rings)
+            if (!r->owned.exchange(true, std::memory_order_acquire))
+                return r;
+        return rings.emplace_back(std::make_shared<ring_t>(capacity));
+    }
+
+    static uint64_t next_instance()
+    {
+        static std::atomic<uint64_t> count{0};
+        return ++count;
+    }
+
+    const size_t capacity;
+    const uint64_t instance;  // unique, unlike the address
+    mutable std::mutex mutex;  // of the rings, never held while reading them
+    std::mutex reader;
+    std::vector<std::shared_ptr<ring_t>> rings;
+};
+}  // namespace tracing
+
+#endif /* DEBUG_TRACE_BUFFER_H */
@@ -0,0 +1,102 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+///////////////////////////////////////////////////////////////////////////////
+//
+// This file is a part of UPPAAL.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef DEBUG_TRACE_FORMAT_H
+#define DEBUG_TRACE_FORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+/** The most detailed trace level compiled in, see tracing::level_t. */
+#ifndef TRACING_LEVEL
+#define TRACING_LEVEL 4
+#endif
+
+namespace tracing {
+enum class level_t { error = 0, warning = 1, info = 2, debug = 3, trace = 4 };
+
+/** @return whether the statements of the level are compiled in */
+constexpr bool compiled(level_t level) { return static_cast<int>(level) <= TRACING_LEVEL; }
+
+/** Not constexpr: a call reports a bad format string at compile time */
+inline void invalid_format_string(const char*) {}
+
+/**
+ * A std::format-style format string with a "{}" placeholder per argument
+ * ("{{" and "}}" stand for braces). The string is checked against the
+ * arguments and parsed at compile time, so each call site keeps its own
+ * parsed format and nothing is parsed when tracing.
+ * The arguments are written with operator<<, format specifications are
+ * not supported.
+ */
+template <typename... Args>
+class basic_format
+{
+    std::string_view text;
+    std::array<size_t, sizeof...(Args)> holes{};  // positions of the placeholders
+    bool escaped{false};                          // whether the text contains doubled braces
+
+    void literal(std::ostream& os, size_t from, size_t to) const
+    {
+        if (!escaped) {
+            os.write(text.data() + from, static_cast<std::streamsize>(to - from));
+            return;
+        }
+        for (; from < to; ++from) {
+            os.put(text[from]);
+            if (text[from] == '{' || text[from] == '}')
+                ++from;  // the second of the pair
+        }
+    }
+
+public:
+    template <typename S>
+        requires std::is_convertible_v<const S&, std::string_view>
+    consteval basic_format(const S& s): text{s}
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            const char c = text[i];
+            const char next = i + 1 < text.size() ? text[i + 1] : '\0';
+            if (c == '{' && next == '}') {
+                if (n == holes.size())
+                    invalid_format_string("more placeholders than arguments");
+                holes[n++] = i++;
+            } else if ((c == '{' || c == '}') && next == c) {
+                escaped = true;
+                ++i;
+            } else if (c == '{') {
+                invalid_format_string("only {} placeholders are supported");
+            } else if (c == '}') {
+                invalid_format_string("unmatched }");
+            }
+        }
+        if (n != holes.size())
+            invalid_format_string("fewer placeholders than arguments");
+    }
+
+    std::string_view str() const { return text; }
+
+    void write(std::ostream& os, const Args&... args) const
+    {
+        [[maybe_unused]] size_t from = 0, i = 0;
+        ((literal(os, from, holes[i]), os << args, from = holes[i++] + 2), ...);
+        literal(os, from, text.size());
+    }
+};
+
+/** The format string for the given arguments, not deduced from */
+template <typename... Args>
+using format_t = basic_format<std::type_identity_t<Args>...>;
+}  // namespace tracing
+
+#endif /* DEBUG_TRACE_FORMAT_H */
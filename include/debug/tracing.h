@@ -12,10 +12,19 @@
 #ifndef DEBUG_TRACING_H
 #define DEBUG_TRACING_H
 
+#include "debug/trace_buffer.h"
+#include "debug/trace_format.h"
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <chrono>
 
@@ -24,6 +33,12 @@ namespace tracing {
  * trace implements tracing by logging debug messages and displaying only the selected.
  * By default it outputs timestamps in fractions of a second.
  * See other time-unit specific aliases below.
+ * After set_async() the messages of async() are recorded in binary per-thread
+ * buffers (see trace_buffer) from any thread, and formatted by flush() or by
+ * the writer thread of start_writer().
+ * The messages of hidden actors are not formatted unless recorded.
+ * TRACE and TRACE_AT below also skip evaluating the arguments, and
+ * remove the levels above TRACING_LEVEL at compile time.
  */
 template <typename time_units = std::chrono::duration<double>>
 class trace_t
@@ -33,8 +48,9 @@ class trace_t
     struct actor_t
     {  // details about the actors
         std::string name;
-        bool visible;
+        std::atomic<bool> visible;  // read by the tracing threads, see show()
         actor_t(std::string name, bool visible): name{std::move(name)}, visible{visible} {};
+        actor_t(actor_t&& other) noexcept: name{std::move(other.name)}, visible{other.visible.load()} {}
     };
     std::vector<actor_t> actors;
     using time_point = std::chrono::time_point<std::chrono::high_resolution_clock>;
@@ -42,11 +58,16 @@ class trace_t
     struct entry_t
     {
         time_point ts;
-        const actor_t& id;
+        size_t actor;  // the index in actors, which may be reallocated by add()
         std::string msg;
-        entry_t(time_point ts, const actor_t& id, std::string msg): ts{ts}, id{id}, msg{std::move(msg)} {}
+        entry_t(time_point ts, size_t actor, std::string msg): ts{ts}, actor{actor}, msg{std::move(msg)} {}
     };
     std::vector<entry_t> entries;  // the log entries
+    std::unique_ptr<trace_buffer> buffer;  // of async messages
+    mutable std::mutex writer_mutex;       // of the actors, the entries and the output, shared with the writer thread
+    std::condition_variable writer_wakeup;
+    bool writer_stop{false};
+    std::thread writer;
 
 public:
     trace_t(std::ostream& os, bool record = false, bool show_time = false):
@@ -55,25 +76,36 @@ public:
         auto id = add_("TRC");
         log(os, id, "started");
     }
-    /** adds an actor and returns its identifier */
+    /** stops the writer and formats the remaining async messages */
+    ~trace_t()
+    {
+        stop_writer();
+        flush();
+    }
+    /** adds an actor and returns its identifier, before the other threads trace */
     size_t add(std::string actor)
     {
+        auto lock = std::lock_guard{writer_mutex};
         auto id = actors.size();
         actors.emplace_back(std::move(actor), true);
         return id;
     }
-    /** adds hidden actor (does not show up in output) */
+    /** adds hidden actor (does not show up in output), also before the other threads trace */
     size_t add_(std::string actor)
     {
+        auto lock = std::lock_guard{writer_mutex};
         auto res = actors.size();
         actors.emplace_back(std::move(actor), false);
         return res;
     }
-    bool shown(size_t actor) { return actors[actor].visible; }
+    bool shown(size_t actor) const { return actors[actor].visible.load(std::memory_order_relaxed); }
+    /** whether the messages of the actor are formatted: shown or recorded */
+    bool enabled(size_t actor) const { return record || actors[actor].visible.load(std::memory_order_relaxed); }
+    /** shows or hides the actor, also while other threads trace */
     void show(size_t actor, bool visible)
     {
         assert(actor < actors.size());
-        actors[actor].visible = visible;
+        actors[actor].visible.store(visible, std::memory_order_relaxed);
     }
     template <typename... Msg>
     trace_t& operator()(size_t actor, const Msg&... msg)
@@ -83,11 +115,27 @@ public:
     template <typename units = time_units, typename... Msg>
     trace_t& log(std::ostream& os, size_t actor, const Msg&... msg)
     {
-        auto ts = std::chrono::high_resolution_clock::now();
+        return emit<units>(os, actor, [&](std::ostream& ss) { (ss << ... << msg); });
+    }
+    /** logs the arguments formatted by the format string, if the level is compiled in */
+    template <level_t level = level_t::info, typename... Args>
+    trace_t& format(size_t actor, format_t<Args...> fmt, const Args&... args)
+    {
+        if constexpr (compiled(level))
+            emit<time_units>(os, actor, [&](std::ostream& ss) { fmt.write(ss, args...); });
+        return *this;
+    }
+    template <typename units, typename Write>
+    trace_t& emit(std::ostream& os, size_t actor, Write&& write)
+    {
         assert(actor < actors.size());
+        if (!enabled(actor))
+            return *this;
+        auto ts = std::chrono::high_resolution_clock::now();
         auto ss = std::ostringstream{};
-        (ss << ... << msg);
-        entries.emplace_back(ts, actors[actor], std::move(ss.str()));
+        write(ss);
+        auto lock = std::lock_guard{writer_mutex};
+        entries.emplace_back(ts, actor, std::move(ss).str());
         print<units>(os, entries.back());
         if (!record)
             entries.clear();
@@ -96,18 +144,85 @@ public:
     template <typename units = time_units>
     void print(std::ostream& os, const entry_t& entry) const
     {
-        if (entry.id.visible) {
+        const auto& id = actors[entry.actor];
+        if (id.visible.load(std::memory_order_relaxed)) {
             if (show_time)
                 os << std::chrono::duration_cast<time_units>(entry.ts - t0).count() << ' ';
-            os << '[' << entry.id.name << "] " << entry.msg << std::endl;
+            os << '[' << id.name << "] " << entry.msg << std::endl;
         }
     }
     template <typename units = time_units>
     void dump(std::ostream& os) const
     {
+        auto lock = std::lock_guard{writer_mutex};
         for (auto& entry : entries)
             print<units>(os, entry);
     }
+    /** records the async messages in per-thread buffers of the given capacity in bytes,
+     * the messages which do not fit in before the next flush are dropped */
+    void set_async(size_t capacity = size_t{1} << 20)
+    {
+        stop_writer();
+        flush();
+        buffer = std::make_unique<trace_buffer>(capacity);
+    }
+    /** records the message for a later flush, or logs it if not set_async() */
+    template <typename... Msg>
+    trace_t& async(size_t actor, const Msg&... msg)
+    {
+        assert(actor < actors.size());
+        if (!buffer)
+            return log(os, actor, msg...);
+        if (enabled(actor))
+            buffer->record(static_cast<uint32_t>(actor), msg...);
+        return *this;
+    }
+    /** formats the async messages recorded so far, in time order */
+    template <typename units = time_units>
+    void flush()
+    {
+        flush<units>(os);
+    }
+    template <typename units = time_units>
+    void flush(std::ostream& os)
+    {
+        if (!buffer)
+            return;
+        auto lock = std::lock_guard{writer_mutex};
+        buffer->drain([&](time_point ts, uint32_t actor, std::string_view msg) {
+            entries.emplace_back(ts, actor, std::string{msg});
+            print<units>(os, entries.back());
+            if (!record)
+                entries.clear();
+        });
+    }
+    /** @return the number of async messages dropped for the lack of buffer space */
+    uint64_t dropped() const { return buffer ? buffer->dropped() : 0; }
+    /** starts a thread to flush the async messages periodically */
+    void start_writer(std::chrono::milliseconds period = std::chrono::milliseconds{100})
+    {
+        stop_writer();
+        writer_stop = false;
+        writer = std::thread{[this, period] {
+            auto lock = std::unique_lock{writer_mutex};
+            while (!writer_wakeup.wait_for(lock, period, [this] { return writer_stop; })) {
+                lock.unlock();
+                flush();
+                lock.lock();
+            }
+        }};
+    }
+    void stop_writer()
+    {
+        if (writer.joinable()) {
+            {
+                auto lock = std::lock_guard{writer_mutex};
+                writer_stop = true;
+            }
+            writer_wakeup.notify_all();
+            writer.join();
+        }
+    }
 };
 
 using trace_us = trace_t<std::chrono::microseconds>;
@@ -115,4 +230,16 @@ using trace_ms = trace_t<std::chrono::milliseconds>;
 using trace_s = trace_t<std::chrono::seconds>;
 }  // namespace tracing
 
+/** Traces a message of an enabled actor, the arguments are evaluated only then:
+ * TRACE(trace, actor, "x = {}", x); */
+#define TRACE(trace, actor, ...) TRACE_AT(tracing::level_t::info, trace, actor, __VA_ARGS__)
+/** TRACE at the given level, removed if above TRACING_LEVEL */
+#define TRACE_AT(level, trace, actor, ...)                           \
+    do {                                                             \
+        if constexpr (tracing::compiled(level)) {                    \
+            if ((trace).enabled(actor)) [[unlikely]]                 \
+                (trace).template format<level>(actor, __VA_ARGS__); \
+        }                                                            \
+    } while (false)
+
 #endif /* DEBUG_TRACING_H */
@@ -0,0 +1,414 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : BitSet.cpp (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/BitSet.h"
+
+#include "base/cpu.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+#ifdef BASE_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace base {
+namespace {
+using word_t = BitSet::word_t;
+
+enum class Op { And, Or, Xor, AndNot };
+
+template <Op op>
+inline word_t apply(word_t a, word_t b)
+{
+    if constexpr (op == Op::And)
+        return a & b;
+    else if constexpr (op == Op::Or)
+        return a | b;
+    else if constexpr (op == Op::Xor)
+        return a ^ b;
+    else
+        return a & ~b;
+}
+
+// Portable kernels, also used for small sets where the
+// dispatch would cost more than the loop.
+
+template <Op op>
+void combine_64(word_t* a, const word_t* b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        a[i] = apply<op>(a[i], b[i]);
+}
+
+bool isSubset_64(const word_t* a, const word_t* b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        if ((a[i] & ~b[i]) != 0)
+            return false;
+    return true;
+}
+
+bool intersects_64(const word_t* a, const word_t* b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        if ((a[i] & b[i]) != 0)
+            return true;
+    return false;
+}
+
+size_t count_64(const word_t* a, size_t n)
+{
+    size_t cnt = 0;
+    for (size_t i = 0; i < n; ++i)
+        cnt += std::popcount(a[i]);
+    return cnt;
+}
+
+#ifdef BASE_X86_DISPATCH
+
+BASE_TARGET("popcnt")
+size_t count_popcnt(const word_t* a, size_t n)
+{
+    size_t cnt = 0;
+    for (size_t i = 0; i < n; ++i)
+        cnt += std::popcount(a[i]);
+    return cnt;
+}
+
+// AVX2: 4 words per step, the remaining words with the portable loop.
+
+template <Op op>
+BASE_TARGET("avx2")
+void combine_avx2(word_t* a, const word_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        if constexpr (op == Op::And)
+            x = _mm256_and_si256(x, y);
+        else if constexpr (op == Op::Or)
+            x = _mm256_or_si256(x, y);
+        else if constexpr (op == Op::Xor)
+            x = _mm256_xor_si256(x, y);
+        else
+            x = _mm256_andnot_si256(y, x);
+        _mm256_storeu_si256((__m256i*)(a + i), x);
+    }
+    for (; i < n; ++i)
+        a[i] = apply<op>(a[i], b[i]);
+}
+
+BASE_TARGET("avx2")
+bool isSubset_avx2(const word_t* a, const word_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        if (!_mm256_testc_si256(y, x))  // (~y & x) != 0
+            return false;
+    }
+    return isSubset_64(a + i, b + i, n - i);
+}
+
+BASE_TARGET("avx2")
+bool intersects_avx2(const word_t* a, const word_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        if (!_mm256_testz_si256(x, y))
+            return true;
+    }
+    return intersects_64(a + i, b + i, n - i);
+}
+
+// AVX-512: 8 words per step, the tail with masked loads and stores.
+
+BASE_TARGET("avx512f")
+inline __mmask8 tailMask(size_t n) { return (__mmask8)((1u << n) - 1); }
+
+template <Op op>
+BASE_TARGET("avx512f")
+void combine_avx512(word_t* a, const word_t* b, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 m = n - i >= 8 ? (__mmask8)0xff : tailMask(n - i);
+        __m512i x = _mm512_maskz_loadu_epi64(m, a + i);
+        __m512i y = _mm512_maskz_loadu_epi64(m, b + i);
+        if constexpr (op == Op::And)
+            x = _mm512_and_si512(x, y);
+        else if constexpr (op == Op::Or)
+            x = _mm512_or_si512(x, y);
+        else if constexpr (op == Op::Xor)
+            x = _mm512_xor_si512(x, y);
+        else
+            x = _mm512_andnot_si512(y, x);
+        _mm512_mask_storeu_epi64(a + i, m, x);
+    }
+}
+
+BASE_TARGET("avx512f")
+bool isSubset_avx512(const word_t* a, const word_t* b, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 m = n - i >= 8 ? (__mmask8)0xff : tailMask(n - i);
+        __m512i x = _mm512_maskz_loadu_epi64(m, a + i);
+        __m512i y = _mm512_maskz_loadu_epi64(m, b + i);
+        __m512i d = _mm512_andnot_si512(y, x);
+        if (_mm512_test_epi64_mask(d, d))
+            return false;
+    }
+    return true;
+}
+
+BASE_TARGET("avx512f")
+bool intersects_avx512(const word_t* a, const word_t* b, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 m = n - i >= 8 ? (__mmask8)0xff : tailMask(n - i);
+        __m512i x = _mm512_maskz_loadu_epi64(m, a + i);
+        __m512i y = _mm512_maskz_loadu_epi64(m, b + i);
+        if (_mm512_test_epi64_mask(x, y))
+            return true;
+    }
+    return false;
+}
+
+#endif /* BASE_X86_DISPATCH */
+
+template <Op op>
+void combine(word_t* a, const word_t* b, size_t n)
+{
+#ifdef BASE_X86_DISPATCH
+    if (n > BitSet::INLINE_WORDS) {
+        uint32_t cpu = base_getCPUFeatures();
+        if (cpu & base_CPU_AVX512)
+            return combine_avx512<op>(a, b, n);
+        if (cpu & base_CPU_AVX2)
+            return combine_avx2<op>(a, b, n);
+    }
+#endif
+    combine_64<op>(a, b, n);
+}
+}  // namespace
+
+BitSet::BitSet(size_t size): words{local}, nbBits{size}, capacity{INLINE_WORDS}, local{}
+{
+    if (wordCount() > INLINE_WORDS) {
+        capacity = wordCount();
+        words = new word_t[capacity]{};
+    }
+}
+
+BitSet::BitSet(const BitSet& other): BitSet(other.nbBits)
+{
+    std::copy_n(other.words, wordCount(), words);
+}
+
+BitSet::BitSet(BitSet&& other) noexcept: words{local}, nbBits{other.nbBits}, capacity{INLINE_WORDS}, local{}
+{
+    if (other.isInline()) {
+        std::copy_n(other.local, INLINE_WORDS, local);
+    } else {
+        words = other.words;
+        capacity = other.capacity;
+        other.words = other.local;
+        other.capacity = INLINE_WORDS;
+    }
+    other.nbBits = 0;
+}
+
+BitSet& BitSet::operator=(const BitSet& other)
+{
+    if (this != &other) {
+        if (other.wordCount() > capacity) {
+            BitSet copy{other};
+            *this = std::move(copy);
+        } else {
+            nbBits = other.nbBits;
+            std::copy_n(other.words, wordCount(), words);
+        }
+    }
+    return *this;
+}
+
+BitSet& BitSet::operator=(BitSet&& other) noexcept
+{
+    if (this != &other) {
+        if (!isInline())
+            delete[] words;
+        words = local;
+        capacity = INLINE_WORDS;
+        nbBits = other.nbBits;
+        if (other.isInline()) {
+            std::copy_n(other.local, INLINE_WORDS, local);
+        } else {
+            words = other.words;
+            capacity = other.capacity;
+            other.words = other.local;
+            other.capacity = INLINE_WORDS;
+        }
+        other.nbBits = 0;
+    }
+    return *this;
+}
+
+BitSet::~BitSet()
+{
+    if (!isInline())
+        delete[] words;
+}
+
+void BitSet::resize(size_t size)
+{
+    const size_t oldWords = wordCount();
+    const size_t newWords = wordsFor(size);
+    if (newWords > capacity) {
+        auto newCapacity = std::max(newWords, 2 * capacity);
+        auto* newData = new word_t[newCapacity]{};
+        std::copy_n(words, oldWords, newData);
+        if (!isInline())
+            delete[] words;
+        words = newData;
+        capacity = newCapacity;
+    } else if (newWords > oldWords) {
+        std::fill(words + oldWords, words + newWords, 0);
+    }
+    nbBits = size;
+    clearTail();
+}
+
+void BitSet::clearTail()
+{
+    if (nbBits % WORD_BITS != 0)
+        words[nbBits / WORD_BITS] &= (word_t{1} << (nbBits % WORD_BITS)) - 1;
+}
+
+void BitSet::set()
+{
+    std::fill_n(words, wordCount(), ~word_t{0});
+    clearTail();
+}
+
+void BitSet::reset() { std::fill_n(words, wordCount(), 0); }
+
+size_t BitSet::count() const
+{
+#ifdef BASE_X86_DISPATCH
+    if (base_getCPUFeatures() & base_CPU_POPCNT)
+        return count_popcnt(words, wordCount());
+#endif
+    return count_64(words, wordCount());
+}
+
+bool BitSet::none() const
+{
+    word_t acc = 0;
+    for (size_t i = 0, n = wordCount(); i < n; ++i)
+        acc |= words[i];
+    return acc == 0;
+}
+
+BitSet& BitSet::operator&=(const BitSet& other)
+{
+    assert(nbBits == other.nbBits);
+    combine<Op::And>(words, other.words, wordCount());
+    return *this;
+}
+
+BitSet& BitSet::operator|=(const BitSet& other)
+{
+    assert(nbBits == other.nbBits);
+    combine<Op::Or>(words, other.words, wordCount());
+    return *this;
+}
+
+BitSet& BitSet::operator^=(const BitSet& other)
+{
+    assert(nbBits == other.nbBits);
+    combine<Op::Xor>(words, other.words, wordCount());
+    return *this;
+}
+
+BitSet& BitSet::andNot(const BitSet& other)
+{
+    assert(nbBits == other.nbBits);
+    combine<Op::AndNot>(words, other.words, wordCount());
+    return *this;
+}
+
+bool BitSet::isSubsetOf(const BitSet& other) const
+{
+    assert(nbBits == other.nbBits);
+    const size_t n = wordCount();
+#ifdef BASE_X86_DISPATCH
+    if (n > INLINE_WORDS) {
+        uint32_t cpu = base_getCPUFeatures();
+        if (cpu & base_CPU_AVX512)
+            return isSubset_avx512(words, other.words, n);
+        if (cpu & base_CPU_AVX2)
+            return isSubset_avx2(words, other.words, n);
+    }
+#endif
+    return isSubset_64(words, other.words, n);
+}
+
+bool BitSet::intersects(const BitSet& other) const
+{
+    assert(nbBits == other.nbBits);
+    const size_t n = wordCount();
+#ifdef BASE_X86_DISPATCH
+    if (n > INLINE_WORDS) {
+        uint32_t cpu = base_getCPUFeatures();
+        if (cpu & base_CPU_AVX512)
+            return intersects_avx512(words, other.words, n);
+        if (cpu & base_CPU_AVX2)
+            return intersects_avx2(words, other.words, n);
+    }
+#endif
+    return intersects_64(words, other.words, n);
+}
+
+bool BitSet::operator==(const BitSet& other) const
+{
+    return nbBits == other.nbBits && std::memcmp(words, other.words, wordCount() * sizeof(word_t)) == 0;
+}
+
+size_t BitSet::findNext(size_t i) const
+{
+    if (i >= nbBits)
+        return npos;
+    size_t w = i / WORD_BITS;
+    word_t b = words[w] & (~word_t{0} << (i % WORD_BITS));
+    for (const size_t n = wordCount(); b == 0;) {
+        if (++w == n)
+            return npos;
+        b = words[w];
+    }
+    return w * WORD_BITS + std::countr_zero(b);
+}
+
+std::ostream& operator<<(std::ostream& os, const BitSet& set)
+{
+    os << '{';
+    const char* sep = "";
+    set.forEach([&](size_t i) {
+        os << sep << i;
+        sep = ",";
+    });
+    return os << '}';
+}
+}  // namespace base
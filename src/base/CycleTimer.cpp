@@ -0,0 +1,46 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : CycleTimer.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/CycleTimer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace base {
+CycleTimer::calibration_t CycleTimer::calibrate()
+{
+#ifdef BASE_X86_DISPATCH
+    if (base_hasCPUFeatures(base_CPU_TSC)) {
+        // the median of 3 rounds of 2ms, each bracketed by serialized readings
+        using clock = std::chrono::steady_clock;
+        double rates[3];
+        for (auto& rate : rates) {
+            unsigned aux;
+            const auto t0 = clock::now();
+            const ticks_t c0 = __rdtscp(&aux);
+            auto t1 = t0;
+            while (t1 - t0 < std::chrono::milliseconds{2})
+                t1 = clock::now();
+            const ticks_t c1 = __rdtscp(&aux);
+            rate = (c1 - c0) / std::chrono::duration<double>(t1 - t0).count();
+        }
+        std::sort(std::begin(rates), std::end(rates));
+        const double frequency = rates[1];
+        if (std::isfinite(frequency) && frequency > 1e6)
+            return {true, frequency, 1 / frequency};
+    }
+#endif
+    return {false, 1e9, 1e-9};
+}
+
+// calibrate at startup rather than in the first measurement
+[[maybe_unused]] static const bool calibrated = CycleTimer::uses_tsc();
+}  // namespace base
@@ -16,6 +16,10 @@
 #include "base/file_stream.hpp"
 #include "debug/macros.h"
 
+#include <algorithm>
+#include <vector>
+#include <cstring>
+
 // When debugging we allocate more to
 // save the allocated size to check it.
 // This results in an offset of the allocated
@@ -156,20 +160,107 @@ void DataAllocator::reset()
 {
     assert(memPool);
 
-    memPool->next = nullptr;
-    freePtr = memPool->mem;
-    endFree = memPool->end;
-
     for (auto* pool = memPool->next; pool != nullptr;) {
         auto* next = pool->next;
         delete pool;
         pool = next;
     }
 
+    memPool->next = nullptr;
+    freePtr = memPool->mem;
+    endFree = memPool->end;
+
     // reset the free list too
     freeMem.reset();
 }
 
+/** Compaction:
+ * - measure the free memory of every full pool from the free lists
+ * - pick the sparse pools and drop their blocks from the free lists
+ * - reallocate the live blocks of sparse pools, which now lands in other pools
+ * - release the sparse pools
+ * The current pool is never evacuated.
+ */
+size_t DataAllocator::compact(const std::function<void(const relocate_t&)>& forEachLive, double maxUsage)
+{
+    assert(memPool);
+    assert(0 <= maxUsage && maxUsage <= 1);
+
+    // full pools sorted by address to find the pool of a block
+    auto pools = std::vector<Pool_t*>{};
+    for (Pool_t* pool = memPool->next; pool != nullptr; pool = pool->next)
+        pools.push_back(pool);
+    std::sort(pools.begin(), pools.end(),
+              [](const Pool_t* p1, const Pool_t* p2) { return (uintptr_t)p1 < (uintptr_t)p2; });
+
+    // index of the pool containing data or pools.size() if none
+    auto poolOf = [&pools](const uintptr_t* data) {
+        auto it = std::upper_bound(pools.begin(), pools.end(), (uintptr_t)data,
+                                   [](uintptr_t d, const Pool_t* pool) { return d < (uintptr_t)pool->mem; });
+        if (it == pools.begin() || (uintptr_t)data >= (uintptr_t)(*--it)->end)
+            return pools.size();
+        return (size_t)(it - pools.begin());
+    };
+
+    auto freeInPool = std::vector<size_t>(pools.size() + 1, 0);
+    size_t n = freeMem.size();
+    for (size_t i = 0; i < n; ++i)
+        for (uintptr_t* data = freeMem[i]; data != nullptr; data = getNext(*data))
+            freeInPool[poolOf(data)] += i;
+
+    auto sparse = std::vector<bool>(pools.size() + 1, false);
+    size_t nbSparse = 0;
+    for (size_t i = 0; i < pools.size(); ++i) {
+        if (CHUNK_SIZE - std::min<size_t>(freeInPool[i], CHUNK_SIZE) < maxUsage * (double)CHUNK_SIZE) {
+            sparse[i] = true;
+            ++nbSparse;
+        }
+    }
+    if (nbSparse == 0)
+        return 0;
+
+    // sparse pools must not serve allocations any more
+    for (size_t i = 0; i < n; ++i) {
+        uintptr_t* kept = nullptr;
+        for (uintptr_t* data = freeMem[i]; data != nullptr;) {
+            uintptr_t* next = getNext(*data);
+            if (!sparse[poolOf(data)]) {
+                *data = getNext(kept);
+                kept = data;
+            }
+            data = next;
+        }
+        freeMem[i] = kept;
+    }
+
+    forEachLive([&](void* ptr, size_t intSize) -> void* {
+        if (intSize == 0 || ptr == nullptr)
+            return ptr;
+        uintptr_t* data = ((uintptr_t*)ptr) - DEBUG_OFFSET;
+        if (!sparse[poolOf(data)])
+            return ptr;
+        assert(*data == arch_size(intSize) + DEBUG_OFFSET);  // check correct size + no corruption
+        void* moved = allocate(intSize);
+        std::memcpy(moved, ptr, intSize * sizeof(int32_t));
+        return moved;
+    });
+
+    // unlink and release the sparse pools (allocations above only add pools in front)
+    size_t released = 0;
+    for (Pool_t** link = &memPool->next; *link != nullptr;) {
+        Pool_t* pool = *link;
+        size_t i = poolOf(pool->mem);
+        if (i < pools.size() && sparse[i]) {
+            *link = pool->next;
+            delete pool;
+            released += sizeof(Pool_t);
+        } else {
+            link = &pool->next;
+        }
+    }
+    return released;
+}
+
 using fos = base::file_ostream;
 
 /** Print statistics, C style = wrapper to C++. */
@@ -0,0 +1,122 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : DiscreteSampler.cpp (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/DiscreteSampler.h"
+
+#include "base/exceptions.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace base {
+void DiscreteSampler::FenwickTree::reset(size_t n)
+{
+    tree.assign(n + 1, 0.);
+    top = n == 0 ? 0 : std::bit_floor(n);
+}
+
+void DiscreteSampler::FenwickTree::add(size_t i, double delta)
+{
+    for (++i; i < tree.size(); i += i & (~i + 1))
+        tree[i] += delta;
+}
+
+size_t DiscreteSampler::FenwickTree::find(double x) const
+{
+    size_t pos = 0;
+    for (size_t step = top; step > 0; step >>= 1) {
+        if (pos + step < tree.size() && tree[pos + step] <= x) {
+            pos += step;
+            x -= tree[pos];
+        }
+    }
+    return std::min(pos, tree.size() - 2);
+}
+
+DiscreteSampler::DiscreteSampler(std::vector<double> weights) { assign(std::move(weights)); }
+
+void DiscreteSampler::check(double weight)
+{
+    if (!(weight >= 0) || !std::isfinite(weight))
+        throw RuntimeException("DiscreteSampler: bad weight %g", weight);
+}
+
+void DiscreteSampler::assign(std::vector<double> values)
+{
+    if (values.size() > std::numeric_limits<uint32_t>::max())
+        throw RuntimeException("DiscreteSampler: too many weights %zu", values.size());
+    std::for_each(values.begin(), values.end(), check);
+    weights = std::move(values);
+    rebuild();
+}
+
+void DiscreteSampler::set_weight(size_t i, double weight)
+{
+    assert(i < size());
+    check(weight);
+    const double old = std::exchange(weights[i], weight);
+    weightTotal += weight - old;
+    const double b = bounds[i];
+    const double delta = std::max(weight - b, 0.) - std::max(old - b, 0.);
+    if (delta != 0) {
+        excess.add(i, delta);
+        excessTotal += delta;
+        massTotal = boundTotal + excessTotal;
+    }
+    accepts[i] = b > 0 ? std::min(weight, b) / b : 0.;
+    // sampling takes massTotal / weightTotal tries, and excess ones take O(log n)
+    const double accepted = weightTotal - excessTotal;
+    if (2 * excessTotal > massTotal || 2 * accepted < boundTotal)
+        rebuild();
+}
+
+void DiscreteSampler::rebuild()
+{
+    const size_t n = weights.size();
+    bounds = weights;
+    accepts.assign(n, 1.);
+    columns.resize(n);
+    excess.reset(n);
+    weightTotal = boundTotal = massTotal = std::accumulate(weights.begin(), weights.end(), 0.);
+    excessTotal = 0;
+    scale = boundTotal > 0 ? n / boundTotal : 0;
+    for (size_t i = 0; i < n; ++i)
+        if (weights[i] == 0)
+            accepts[i] = 0;  // never returned, even if rounding leaves it a column
+
+    // Vose: pair every column below 1 with one above 1 to fill it up
+    auto small = std::vector<uint32_t>{};
+    auto large = std::vector<uint32_t>{};
+    auto scaled = std::vector<double>(n);
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * scale;
+        (scaled[i] < 1 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        const uint32_t s = small.back();
+        const uint32_t l = large.back();
+        small.pop_back();
+        large.pop_back();
+        columns[s] = {scaled[s], l};
+        scaled[l] = (scaled[l] + scaled[s]) - 1;
+        (scaled[l] < 1 ? small : large).push_back(l);
+    }
+    // the rest is 1 up to rounding
+    for (auto i : large)
+        columns[i] = {1., i};
+    for (auto i : small)
+        columns[i] = {1., i};
+}
+}  // namespace base
@@ -0,0 +1,210 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : Histogram.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/Histogram.h"
+
+#include "base/exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+
+namespace base {
+namespace {
+constexpr char MAGIC = 'H';
+
+void checkPrecision(unsigned precision)
+{
+    if (precision < 1 || precision > Histogram::MAX_PRECISION)
+        throw RuntimeException("Histogram: precision %u out of range [1,%u]", precision,
+                               Histogram::MAX_PRECISION);
+}
+
+void putVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+uint64_t getVarint(std::string_view& in)
+{
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (in.empty())
+            throw RuntimeException("Histogram: truncated data");
+        const auto byte = static_cast<uint8_t>(in.front());
+        in.remove_prefix(1);
+        if (shift == 63 && byte > 1)
+            break;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (byte < 0x80)
+            return value;
+    }
+    throw RuntimeException("Histogram: bad varint");
+}
+}  // namespace
+
+Histogram::Snapshot::Snapshot(unsigned precision): bits{precision} { checkPrecision(precision); }
+
+double Histogram::Snapshot::mean() const
+{
+    if (total == 0)
+        return 0;
+    double sum = 0;
+    for (size_t i = 0; i < counts.size(); ++i)
+        if (counts[i])
+            sum += counts[i] * (0.5 * lowest(i, bits) + 0.5 * highest(i, bits));
+    return sum / total;
+}
+
+uint64_t Histogram::Snapshot::percentile(double p) const
+{
+    if (total == 0)
+        return 0;
+    const double rank = std::ceil(std::clamp(p, 0., 100.) / 100 * total);
+    const uint64_t target = std::max(uint64_t{1}, static_cast<uint64_t>(rank));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= target)
+            return std::clamp(highest(i, bits), minimum, maximum);
+    }
+    return maximum;
+}
+
+uint64_t Histogram::Snapshot::count_between(uint64_t low, uint64_t high) const
+{
+    if (low > high)
+        return 0;
+    const size_t last = std::min(index(high, bits) + 1, counts.size());
+    uint64_t n = 0;
+    for (size_t i = index(low, bits); i < last; ++i)
+        n += counts[i];
+    return n;
+}
+
+Histogram::Snapshot& Histogram::Snapshot::operator+=(const Snapshot& other)
+{
+    if (other.bits != bits)
+        throw RuntimeException("Histogram: merging precision %u into %u", other.bits, bits);
+    if (counts.size() < other.counts.size())
+        counts.resize(other.counts.size());
+    for (size_t i = 0; i < other.counts.size(); ++i)
+        counts[i] += other.counts[i];
+    total += other.total;
+    minimum = std::min(minimum, other.minimum);
+    maximum = std::max(maximum, other.maximum);
+    return *this;
+}
+
+std::string Histogram::Snapshot::serialize() const
+{
+    auto out = std::string{MAGIC};
+    putVarint(out, bits);
+    putVarint(out, min());
+    putVarint(out, maximum);
+    // a count c as 2c, a run of r empty buckets as 2r+1
+    for (size_t i = 0; i < counts.size();) {
+        if (counts[i]) {
+            putVarint(out, counts[i] << 1);
+            ++i;
+        } else {
+            size_t run = 1;
+            while (i + run < counts.size() && counts[i + run] == 0)
+                ++run;
+            putVarint(out, (uint64_t{run} << 1) | 1);
+            i += run;
+        }
+    }
+    return out;
+}
+
+Histogram::Snapshot Histogram::Snapshot::deserialize(std::string_view data)
+{
+    if (data.empty() || data.front() != MAGIC)
+        throw RuntimeException("Histogram: not a serialized histogram");
+    data.remove_prefix(1);
+    const uint64_t precision = getVarint(data);
+    if (precision > MAX_PRECISION)
+        throw RuntimeException("Histogram: bad precision %llu", (unsigned long long)precision);
+    auto s = Snapshot{static_cast<unsigned>(precision)};
+    const uint64_t minimum = getVarint(data);
+    s.maximum = getVarint(data);
+    const size_t buckets = bucket_count(s.bits);
+    while (!data.empty()) {
+        const uint64_t token = getVarint(data);
+        const uint64_t n = token >> 1;
+        if (n == 0 || s.counts.size() == buckets || ((token & 1) && n > buckets - s.counts.size()))
+            throw RuntimeException("Histogram: bad bucket data");
+        if (token & 1) {
+            s.counts.resize(s.counts.size() + n);
+        } else {
+            s.counts.push_back(n);
+            s.total += n;
+        }
+    }
+    if (s.total) {
+        s.minimum = minimum;
+        if (minimum > s.maximum || index(minimum, s.bits) >= s.counts.size() ||
+            index(s.maximum, s.bits) >= s.counts.size())
+            throw RuntimeException("Histogram: bad extremes");
+    }
+    return s;
+}
+
+Histogram::Histogram(unsigned precision): bits{precision}
+{
+    checkPrecision(precision);
+    counts = std::make_unique<std::atomic<uint64_t>[]>(bucket_count(precision));
+}
+
+Histogram::Snapshot Histogram::snapshot() const
+{
+    auto s = Snapshot{bits};
+    const size_t buckets = bucket_count(bits);
+    size_t first = buckets, used = 0;
+    s.counts.resize(buckets);
+    for (size_t i = 0; i < buckets; ++i) {
+        if (const uint64_t n = counts[i].load(std::memory_order_relaxed)) {
+            s.counts[i] = n;
+            s.total += n;
+            first = std::min(first, i);
+            used = i + 1;
+        }
+    }
+    s.counts.resize(used);
+    if (s.total) {
+        // the extremes of concurrent recordings may lag behind their counts
+        s.minimum = std::min(minimum.load(std::memory_order_relaxed), highest(first, bits));
+        s.maximum = std::max(maximum.load(std::memory_order_relaxed), lowest(used - 1, bits));
+    }
+    return s;
+}
+
+void Histogram::reset()
+{
+    const size_t buckets = bucket_count(bits);
+    for (size_t i = 0; i < buckets; ++i)
+        counts[i].store(0, std::memory_order_relaxed);
+    minimum.store(UINT64_MAX, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+std::ostream& operator<<(std::ostream& os, const Histogram::Snapshot& s)
+{
+    return os << "count=" << s.count() << " min=" << s.min() << " mean=" << s.mean()
+              << " p50=" << s.percentile(50) << " p90=" << s.percentile(90) << " p99=" << s.percentile(99)
+              << " p99.9=" << s.percentile(99.9) << " max=" << s.max();
+}
+}  // namespace base
@@ -0,0 +1,127 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : ProgressReporter.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/ProgressReporter.h"
+
+#include "base/exceptions.h"
+
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+namespace base {
+namespace {
+constexpr double SMOOTHING = 0.5;  // weight of the last period in the smoothed rates
+}
+
+ProgressReporter::ProgressReporter(callback_t callback, double period_in_seconds):
+    callback{std::move(callback)}, period{period_in_seconds}, start{clock::now()}, last{start},
+    due{start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>{period})}
+{
+    if (!(period_in_seconds > 0))
+        throw RuntimeException("ProgressReporter: bad period %g", period_in_seconds);
+}
+
+size_t ProgressReporter::add_counter(std::string name, kind_t kind, uint64_t total)
+{
+    auto lock = std::lock_guard{mutex};
+    if (counters.size() == MAX_COUNTERS)
+        throw RuntimeException("ProgressReporter: more than %zu counters", MAX_COUNTERS);
+    counters.push_back({std::move(name), kind, total, 0, 0, -1});
+    states.emplace_back();
+    nbCounters.store(counters.size(), std::memory_order_relaxed);
+    return counters.size() - 1;
+}
+
+void ProgressReporter::set_total(size_t counter, uint64_t total)
+{
+    auto lock = std::lock_guard{mutex};
+    counters.at(counter).total = total;
+}
+
+ProgressReporter::Worker ProgressReporter::worker()
+{
+    auto lock = std::lock_guard{mutex};
+    auto& slots = *workers.emplace_back(std::make_unique<Worker::slots_t>());
+    // checked twice per period by each worker, so a report is at most half a period late
+    return Worker{*this, slots, period / 2};
+}
+
+void ProgressReporter::poll()
+{
+    auto lock = std::unique_lock{mutex, std::try_to_lock};
+    if (lock && clock::now() >= due)
+        emit(false);
+}
+
+void ProgressReporter::report()
+{
+    auto lock = std::lock_guard{mutex};
+    emit(false);
+}
+
+void ProgressReporter::finish()
+{
+    auto lock = std::lock_guard{mutex};
+    emit(true);
+}
+
+void ProgressReporter::emit(bool final)
+{
+    const auto now = clock::now();
+    const double delta = std::chrono::duration<double>(now - last).count();
+    for (size_t c = 0; c < counters.size(); ++c) {
+        auto& counter = counters[c];
+        auto& state = states[c];
+        counter.value = 0;
+        for (const auto& slots : workers)
+            counter.value += (*slots)[c].value.load(std::memory_order_relaxed);
+        counter.rate = delta > 0 ? (counter.value - state.value) / delta : 0;
+        state.smoothed = state.rated ? SMOOTHING * counter.rate + (1 - SMOOTHING) * state.smoothed : counter.rate;
+        state.rated = true;
+        state.value = counter.value;
+        counter.eta = -1;
+        if (counter.kind == kind_t::count && counter.total > 0) {
+            const double remaining = double(counter.total) - counter.value;
+            if (remaining <= 0)
+                counter.eta = 0;
+            else if (state.smoothed > 0)
+                counter.eta = remaining / state.smoothed;
+        }
+    }
+    last = now;
+    due = now + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>{period});
+    if (callback)
+        callback(Report{std::chrono::duration<double>(now - start).count(), counters, final});
+}
+
+std::ostream& operator<<(std::ostream& os, const ProgressReporter::Report& report)
+{
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+    os << std::fixed << std::setprecision(1) << report.elapsed << 's';
+    for (const auto& c : report.counters) {
+        os << ' ' << c.name << ' ' << c.value << " (" << std::setprecision(0);
+        if (c.kind == ProgressReporter::kind_t::level && c.rate >= 0)
+            os << '+';
+        os << c.rate << "/s";
+        if (c.kind == ProgressReporter::kind_t::count && c.total > 0) {
+            os << ", " << std::floor(100. * c.value / c.total) << '%';
+            if (c.eta >= 0)
+                os << ", ETA " << std::ceil(c.eta) << 's';
+        }
+        os << ')' << std::setprecision(1);
+    }
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+}  // namespace base
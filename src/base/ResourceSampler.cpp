@@ -0,0 +1,117 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : ResourceSampler.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/ResourceSampler.h"
+
+#include "base/exceptions.h"
+#include "base/platform.h"
+
+#include <algorithm>
+
+namespace base {
+ResourceSampler::ResourceSampler(clock::duration interval, size_t capacity):
+    period{interval}
+{
+    if (interval <= clock::duration::zero() || capacity == 0)
+        throw RuntimeException("ResourceSampler: bad interval or capacity");
+    ring.resize(capacity);
+    base_initProcInfo();
+    sample();
+    worker = std::thread{&ResourceSampler::run, this};
+}
+
+ResourceSampler::~ResourceSampler()
+{
+    {
+        auto lock = std::lock_guard{mutex};
+        stopping = true;
+    }
+    wakeup.notify_all();
+    worker.join();
+}
+
+void ResourceSampler::run()
+{
+    auto lock = std::unique_lock{mutex};
+    auto due = clock::now() + period;
+    while (!wakeup.wait_until(lock, due, [this] { return stopping; })) {
+        lock.unlock();
+        sample();
+        lock.lock();
+        // on the schedule, without catching up after a stall
+        due = std::max(due + period, clock::now());
+    }
+}
+
+ResourceSampler::Sample ResourceSampler::sample()
+{
+    // recorded under the same lock to keep the series in time order
+    auto lock = std::lock_guard{readMutex};
+    auto info = procinfo_t{};
+    auto s = Sample{};
+    s.time = clock::now();
+    base_getProcInfo(&info);
+    s.mem_virt = info.mem_virt;
+    s.mem_work = info.mem_work;
+    s.mem_swap = info.mem_swap;
+    s.time_user = info.time_user;
+    s.time_sys = info.time_sys;
+    s.faults_major = info.faults_major;
+    record(s);
+    return s;
+}
+
+void ResourceSampler::record(const Sample& s)
+{
+    auto lock = std::lock_guard{mutex};
+    ring[next] = s;
+    next = (next + 1) % ring.size();
+    ++taken;
+    if (s.mem_work > maxima.mem_work || taken == 1)
+        maxima.time = s.time;
+    maxima.mem_virt = std::max(maxima.mem_virt, s.mem_virt);
+    maxima.mem_work = std::max(maxima.mem_work, s.mem_work);
+    maxima.mem_swap = std::max(maxima.mem_swap, s.mem_swap);
+    maxima.time_user = std::max(maxima.time_user, s.time_user);
+    maxima.time_sys = std::max(maxima.time_sys, s.time_sys);
+    maxima.faults_major = std::max(maxima.faults_major, s.faults_major);
+}
+
+ResourceSampler::Sample ResourceSampler::latest() const
+{
+    auto lock = std::lock_guard{mutex};
+    return ring[(next + ring.size() - 1) % ring.size()];
+}
+
+ResourceSampler::Sample ResourceSampler::peak() const
+{
+    auto lock = std::lock_guard{mutex};
+    return maxima;
+}
+
+std::vector<ResourceSampler::Sample> ResourceSampler::series(clock::time_point since) const
+{
+    auto lock = std::lock_guard{mutex};
+    const size_t kept = std::min(taken, ring.size());
+    auto samples = std::vector<Sample>{};
+    samples.reserve(kept);
+    for (size_t i = (next + ring.size() - kept) % ring.size(), n = 0; n < kept; ++n, i = (i + 1) % ring.size())
+        if (ring[i].time >= since)
+            samples.push_back(ring[i]);
+    return samples;
+}
+
+size_t ResourceSampler::count() const
+{
+    auto lock = std::lock_guard{mutex};
+    return taken;
+}
+}  // namespace base
@@ -0,0 +1,483 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : RoaringBitmap.cpp (base)
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/RoaringBitmap.h"
+
+#include "base/bitstring.h"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+
+namespace base {
+namespace {
+using word_t = BitSet::word_t;
+
+/** set the bits first..last (inclusive) of a bitmap */
+void setRange(BitSet& bits, uint32_t first, uint32_t last)
+{
+    word_t* words = bits.data();
+    const uint32_t fw = first / 64, lw = last / 64;
+    const word_t fmask = ~word_t{0} << (first % 64);
+    const word_t lmask = ~word_t{0} >> (63 - last % 64);
+    if (fw == lw) {
+        words[fw] |= fmask & lmask;
+        return;
+    }
+    words[fw] |= fmask;
+    std::fill(words + fw + 1, words + lw, ~word_t{0});
+    words[lw] |= lmask;
+}
+
+/** intersection of sorted arrays without data dependent branches:
+ * random sets mispredict about every other comparison in std::set_intersection
+ */
+void intersectArrays(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b, std::vector<uint16_t>& out)
+{
+    out.resize(std::min(a.size(), b.size()) + 1);
+    size_t i = 0, j = 0, k = 0;
+    while (i < a.size() && j < b.size()) {
+        const uint16_t x = a[i], y = b[j];
+        out[k] = x;
+        k += x == y;
+        i += x <= y;
+        j += y <= x;
+    }
+    out.resize(k);
+}
+}  // namespace
+
+bool RoaringBitmap::Container::contains(uint16_t low) const
+{
+    switch (kind) {
+    case ARRAY: {
+        const size_t i = lowerBound(array, low);
+        return i != array.size() && array[i] == low;
+    }
+    case BITMAP: return bitmap.test(low);
+    case RUN: {
+        auto it = std::upper_bound(runs.begin(), runs.end(), low,
+                                   [](uint16_t x, const Run& run) { return x < run.first; });
+        return it != runs.begin() && low <= std::prev(it)->last;
+    }
+    }
+    return false;
+}
+
+bool RoaringBitmap::Container::add(uint16_t low)
+{
+    if (kind == RUN)
+        unrun();
+    if (kind == ARRAY) {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (it != array.end() && *it == low)
+            return false;
+        if (array.size() < ARRAY_MAX) {
+            array.insert(it, low);
+            ++card;
+            return true;
+        }
+        bitmap = toBitmap();
+        kind = BITMAP;
+        array = std::vector<uint16_t>{};
+    }
+    if (bitmap.test(low))
+        return false;
+    bitmap.set(low);
+    ++card;
+    return true;
+}
+
+bool RoaringBitmap::Container::remove(uint16_t low)
+{
+    if (kind == RUN)
+        unrun();
+    if (kind == ARRAY) {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (it == array.end() || *it != low)
+            return false;
+        array.erase(it);
+        --card;
+        return true;
+    }
+    if (!bitmap.test(low))
+        return false;
+    bitmap.reset(low);
+    if (--card <= ARRAY_MAX)
+        setBitmap(std::move(bitmap), card);
+    return true;
+}
+
+void RoaringBitmap::Container::addRange(uint32_t first, uint32_t last)
+{
+    auto bits = toBitmap();
+    setRange(bits, first, last);
+    auto count = bits.count();
+    setBitmap(std::move(bits), count);
+}
+
+BitSet RoaringBitmap::Container::toBitmap() const
+{
+    if (kind == BITMAP)
+        return bitmap;
+    auto bits = BitSet{CONTAINER_BITS};
+    if (kind == ARRAY) {
+        for (auto low : array)
+            bits.set(low);
+    } else {
+        for (auto run : runs)
+            setRange(bits, run.first, run.last);
+    }
+    return bits;
+}
+
+void RoaringBitmap::Container::setBitmap(BitSet&& bits, uint32_t count)
+{
+    card = count;
+    runs = std::vector<Run>{};
+    if (count <= ARRAY_MAX) {
+        kind = ARRAY;
+        array.clear();
+        array.reserve(count);
+        bits.forEach([&](size_t low) { array.push_back(low); });
+        bitmap = BitSet{};
+    } else {
+        kind = BITMAP;
+        array = std::vector<uint16_t>{};
+        bitmap = std::move(bits);
+    }
+}
+
+void RoaringBitmap::Container::setArray(std::vector<uint16_t>&& values)
+{
+    if (values.size() <= ARRAY_MAX) {
+        kind = ARRAY;
+        card = values.size();
+        array = std::move(values);
+        runs = std::vector<Run>{};
+        bitmap = BitSet{};
+    } else {
+        auto bits = BitSet{CONTAINER_BITS};
+        for (auto low : values)
+            bits.set(low);
+        setBitmap(std::move(bits), values.size());
+    }
+}
+
+void RoaringBitmap::Container::unrun()
+{
+    if (kind != RUN)
+        return;
+    if (card <= ARRAY_MAX) {
+        auto values = std::vector<uint16_t>{};
+        values.reserve(card);
+        for (auto run : runs)
+            for (uint32_t low = run.first; low <= run.last; ++low)
+                values.push_back(low);
+        setArray(std::move(values));
+    } else {
+        setBitmap(toBitmap(), card);
+    }
+    runs = std::vector<Run>{};
+}
+
+void RoaringBitmap::Container::unionWith(const Container& other)
+{
+    if (kind == ARRAY && other.kind == ARRAY && array.size() + other.array.size() <= ARRAY_MAX) {
+        auto values = std::vector<uint16_t>{};
+        values.reserve(array.size() + other.array.size());
+        std::set_union(array.begin(), array.end(), other.array.begin(), other.array.end(),
+                       std::back_inserter(values));
+        setArray(std::move(values));
+        return;
+    }
+    // the result may be large: build it in a bitmap
+    auto bits = toBitmap();
+    switch (other.kind) {
+    case ARRAY:
+        for (auto low : other.array)
+            bits.set(low);
+        break;
+    case BITMAP: bits |= other.bitmap; break;
+    case RUN:
+        for (auto run : other.runs)
+            setRange(bits, run.first, run.last);
+        break;
+    }
+    auto count = bits.count();
+    setBitmap(std::move(bits), count);
+}
+
+void RoaringBitmap::Container::intersectWith(const Container& other)
+{
+    if (kind == ARRAY || other.kind == ARRAY) {
+        // the result is at most as large as the array: filter it
+        const auto& small = kind == ARRAY ? *this : other;
+        const auto& large = kind == ARRAY ? other : *this;
+        auto values = std::vector<uint16_t>{};
+        if (large.kind == ARRAY) {
+            intersectArrays(small.array, large.array, values);
+        } else {
+            values.reserve(small.array.size());
+            std::copy_if(small.array.begin(), small.array.end(), std::back_inserter(values),
+                         [&large](uint16_t low) { return large.contains(low); });
+        }
+        setArray(std::move(values));
+        return;
+    }
+    if (kind == RUN && other.kind == RUN) {
+        auto result = std::vector<Run>{};
+        auto a = runs.cbegin();
+        auto b = other.runs.cbegin();
+        uint32_t count = 0;
+        while (a != runs.end() && b != other.runs.end()) {
+            auto first = std::max(a->first, b->first);
+            auto last = std::min(a->last, b->last);
+            if (first <= last) {
+                result.push_back({first, last});
+                count += last - first + 1u;
+            }
+            if (a->last < b->last)
+                ++a;
+            else
+                ++b;
+        }
+        card = count;
+        runs = std::move(result);
+        return;
+    }
+    auto bits = toBitmap();
+    if (other.kind == BITMAP)
+        bits &= other.bitmap;
+    else
+        bits &= other.toBitmap();
+    auto count = bits.count();
+    setBitmap(std::move(bits), count);
+}
+
+RoaringBitmap::Container& RoaringBitmap::containerFor(uint16_t key)
+{
+    const size_t i = find(key);
+    if (i == keys.size() || keys[i] != key) {
+        keys.insert(keys.begin() + i, key);
+        containers.insert(containers.begin() + i, Container{})->key = key;
+    }
+    return containers[i];
+}
+
+void RoaringBitmap::updateKeys()
+{
+    keys.resize(containers.size());
+    for (size_t i = 0; i < containers.size(); ++i)
+        keys[i] = containers[i].key;
+}
+
+RoaringBitmap RoaringBitmap::fromBits(const uint32_t* bits, size_t n)
+{
+    constexpr size_t INTS = CONTAINER_BITS / 32;
+    auto res = RoaringBitmap{};
+    for (size_t key = 0; key * INTS < n; ++key) {
+        const uint32_t* chunk = bits + key * INTS;
+        const size_t size = std::min(INTS, n - key * INTS);
+        const uint32_t count = base_countBitsN(chunk, size);
+        if (count == 0)
+            continue;
+        auto& c = res.containers.emplace_back();
+        c.key = key;
+        c.card = count;
+        if (count <= ARRAY_MAX) {
+            c.kind = ARRAY;
+            c.array.reserve(count);
+            for (size_t i = 0; i < size; ++i)
+                for (uint32_t b = chunk[i]; b != 0; b &= b - 1)
+                    c.array.push_back(i * 32 + std::countr_zero(b));
+        } else {
+            c.kind = BITMAP;
+            c.bitmap = BitSet{CONTAINER_BITS};
+            word_t* words = c.bitmap.data();
+            for (size_t i = 0; i < size; ++i)
+                words[i / 2] |= word_t{chunk[i]} << (32 * (i % 2));
+        }
+    }
+    res.updateKeys();
+    return res;
+}
+
+void RoaringBitmap::toBits(uint32_t* bits, size_t n) const
+{
+    base_resetBits(bits, n);
+    for (const auto& c : containers) {
+        uint32_t* chunk = bits + size_t{c.key} * (CONTAINER_BITS / 32);
+        switch (c.kind) {
+        case ARRAY:
+            for (auto low : c.array) {
+                assert(size_t{c.key} * CONTAINER_BITS + low < n * 32);
+                base_setOneBit(chunk, low);
+            }
+            break;
+        case BITMAP: {
+            const word_t* words = c.bitmap.data();
+            const size_t size = std::min<size_t>(CONTAINER_BITS / 32, n - size_t{c.key} * (CONTAINER_BITS / 32));
+            for (size_t i = 0; i < size; ++i)
+                chunk[i] = static_cast<uint32_t>(words[i / 2] >> (32 * (i % 2)));
+            break;
+        }
+        case RUN:
+            for (auto run : c.runs)
+                for (uint32_t low = run.first; low <= run.last; ++low)
+                    base_setOneBit(chunk, low);
+            break;
+        }
+    }
+}
+
+bool RoaringBitmap::add(uint32_t x) { return containerFor(x >> 16).add(x & 0xffff); }
+
+void RoaringBitmap::addRange(uint32_t first, uint32_t last)
+{
+    assert(first <= last);
+    for (uint32_t key = first >> 16; key <= (last >> 16); ++key) {
+        const uint32_t lo = key == (first >> 16) ? first & 0xffff : 0;
+        const uint32_t hi = key == (last >> 16) ? last & 0xffff : 0xffff;
+        containerFor(key).addRange(lo, hi);
+    }
+}
+
+bool RoaringBitmap::remove(uint32_t x)
+{
+    const size_t i = find(x >> 16);
+    if (i == keys.size() || keys[i] != (x >> 16) || !containers[i].remove(x & 0xffff))
+        return false;
+    if (containers[i].card == 0) {
+        containers.erase(containers.begin() + i);
+        keys.erase(keys.begin() + i);
+    }
+    return true;
+}
+
+bool RoaringBitmap::contains(uint32_t x) const
+{
+    const size_t i = find(x >> 16);
+    return i != keys.size() && keys[i] == (x >> 16) && containers[i].contains(x & 0xffff);
+}
+
+size_t RoaringBitmap::cardinality() const
+{
+    size_t count = 0;
+    for (const auto& c : containers)
+        count += c.card;
+    return count;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other)
+{
+    auto result = std::vector<Container>{};
+    result.reserve(containers.size() + other.containers.size());
+    auto a = containers.begin();
+    auto b = other.containers.begin();
+    while (a != containers.end() || b != other.containers.end()) {
+        if (b == other.containers.end() || (a != containers.end() && a->key < b->key)) {
+            result.push_back(std::move(*a++));
+        } else if (a == containers.end() || b->key < a->key) {
+            result.push_back(*b++);
+        } else {
+            a->unionWith(*b++);
+            result.push_back(std::move(*a++));
+        }
+    }
+    containers = std::move(result);
+    updateKeys();
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other)
+{
+    auto out = containers.begin();
+    auto b = other.containers.begin();
+    for (auto a = containers.begin(); a != containers.end(); ++a) {
+        while (b != other.containers.end() && b->key < a->key)
+            ++b;
+        if (b == other.containers.end())
+            break;
+        if (b->key != a->key)
+            continue;
+        a->intersectWith(*b);
+        if (a->card != 0) {
+            if (out != a)
+                *out = std::move(*a);
+            ++out;
+        }
+    }
+    containers.erase(out, containers.end());
+    updateKeys();
+    return *this;
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap& other) const
+{
+    if (containers.size() != other.containers.size())
+        return false;
+    for (size_t i = 0; i < containers.size(); ++i) {
+        const auto& a = containers[i];
+        const auto& b = other.containers[i];
+        if (a.key != b.key || a.card != b.card)
+            return false;
+        if (a.kind == ARRAY && b.kind == ARRAY) {
+            if (a.array != b.array)
+                return false;
+        } else if (!(a.toBitmap() == b.toBitmap())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t RoaringBitmap::runOptimize()
+{
+    size_t converted = 0;
+    for (auto& c : containers) {
+        if (c.kind == RUN)
+            continue;
+        auto runs = std::vector<Run>{};
+        auto extend = [&runs](uint32_t low) {
+            if (!runs.empty() && runs.back().last + 1u == low)
+                runs.back().last = low;
+            else
+                runs.push_back({(uint16_t)low, (uint16_t)low});
+        };
+        if (c.kind == ARRAY)
+            std::for_each(c.array.begin(), c.array.end(), extend);
+        else
+            c.bitmap.forEach(extend);
+        const size_t current = c.kind == ARRAY ? c.array.size() * sizeof(uint16_t) : CONTAINER_BITS / 8;
+        if (runs.size() * sizeof(Run) < current) {
+            c.kind = RUN;
+            c.runs = std::move(runs);
+            c.runs.shrink_to_fit();
+            c.array = std::vector<uint16_t>{};
+            c.bitmap = BitSet{};
+            ++converted;
+        }
+    }
+    return converted;
+}
+
+size_t RoaringBitmap::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + containers.capacity() * sizeof(Container) + keys.capacity() * sizeof(uint16_t);
+    for (const auto& c : containers) {
+        bytes += c.array.capacity() * sizeof(uint16_t) + c.runs.capacity() * sizeof(Run);
+        if (c.bitmap.wordCount() > BitSet::INLINE_WORDS)
+            bytes += c.bitmap.wordCount() * sizeof(word_t);
+    }
+    return bytes;
+}
+}  // namespace base
@@ -0,0 +1,325 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Filename : ScopedProfiler.cpp
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/ScopedProfiler.h"
+
+#include "base/exceptions.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+namespace base {
+namespace {
+using Node = ScopedProfiler::Node;
+using Report = ScopedProfiler::Report;
+
+/** The nodes of a thread in chunks that never move, published by count */
+struct ThreadProfile
+{
+    static constexpr size_t CHUNK = 256;
+    static constexpr size_t MAX_CHUNKS = 4096;
+
+    std::array<std::atomic<Node*>, MAX_CHUNKS> chunks{};
+    std::atomic<size_t> count{0};
+    std::vector<std::unique_ptr<Node[]>> owned;  // of the owner thread only
+    bool released{false};                        // by its exited thread, guarded by the registry
+
+    Node* add(uint32_t zone, Node* parent)
+    {
+        const size_t n = count.load(std::memory_order_relaxed);
+        if (n % CHUNK == 0) {
+            if (n / CHUNK == MAX_CHUNKS)
+                throw RuntimeException("ScopedProfiler: more than %zu nodes in a call tree", n);
+            owned.push_back(std::make_unique<Node[]>(CHUNK));
+            chunks[n / CHUNK].store(owned.back().get(), std::memory_order_release);
+        }
+        Node* node = at(n);
+        node->zone = zone;
+        node->parent = parent;
+        count.store(n + 1, std::memory_order_release);
+        return node;
+    }
+
+    Node* at(size_t i) const { return chunks[i / CHUNK].load(std::memory_order_acquire) + i % CHUNK; }
+};
+
+/** Zone names by id and the profiles of the threads: the profile of a
+ * finished thread is kept and continued by the next new thread */
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::string> zones{""};  // 0 is the root of the threads
+    std::vector<std::unique_ptr<ThreadProfile>> threads;
+};
+
+/** Never destroyed: zones may be entered by other threads and static destructors at exit. */
+Registry& registry()
+{
+    static auto* value = new Registry;
+    return *value;
+}
+
+thread_local ThreadProfile* profile = nullptr;
+
+/** Releases the profile of the thread when it exits */
+struct ProfileRelease
+{
+    ~ProfileRelease()
+    {
+        auto& reg = registry();
+        auto lock = std::lock_guard{reg.mutex};
+        profile->released = true;
+    }
+};
+
+Report& childNamed(Report& parent, const std::string& name)
+{
+    for (auto& child : parent.children)
+        if (child.name == name)
+            return child;
+    auto& child = parent.children.emplace_back();
+    child.name = name;
+    return child;
+}
+
+void merge(Report& into, const Report& from)
+{
+    into.calls += from.calls;
+    into.inclusive += from.inclusive;
+    into.exclusive += from.exclusive;
+    for (const auto& child : from.children)
+        merge(childNamed(into, child.name), child);
+}
+
+/** Sibling zones with the same name are merged */
+struct TreeBuilder
+{
+    const std::vector<std::string>& names;
+    std::vector<const Node*> nodes;
+    std::vector<std::vector<size_t>> children;
+
+    TreeBuilder(const ThreadProfile& thread, const std::vector<std::string>& names): names{names}
+    {
+        const size_t count = thread.count.load(std::memory_order_acquire);
+        auto index = std::unordered_map<const Node*, size_t>{};
+        nodes.reserve(count);
+        children.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const Node* node = thread.at(i);
+            nodes.push_back(node);
+            index[node] = i;
+            if (i > 0)
+                children[index.at(node->parent)].push_back(i);
+        }
+    }
+
+    void add(Report& into, size_t i) const
+    {
+        const Node& node = *nodes[i];
+        const uint64_t ticks = node.ticks.load(std::memory_order_relaxed);
+        const uint64_t nested = node.childrenTicks.load(std::memory_order_relaxed);
+        into.calls += node.calls.load(std::memory_order_relaxed);
+        into.inclusive += CycleTimer::to_seconds(ticks);
+        // a zone still running has no ticks yet
+        into.exclusive += nested < ticks ? CycleTimer::to_seconds(ticks - nested) : 0;
+        for (const size_t child : children[i])
+            add(childNamed(into, names[nodes[child]->zone]), child);
+    }
+};
+
+void setRootTime(Report& root)
+{
+    root.inclusive = 0;
+    for (const auto& child : root.children)
+        root.inclusive += child.inclusive;
+}
+
+void writeJsonString(std::ostream& os, const std::string& s)
+{
+    os << '"';
+    for (const char c : s) {
+        switch (c) {
+        case '"': os << "\\\""; break;
+        case '\\': os << "\\\\"; break;
+        case '\n': os << "\\n"; break;
+        case '\t': os << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec
+                   << std::setfill(' ');
+            else
+                os << c;
+        }
+    }
+    os << '"';
+}
+
+void writeTreeNode(std::ostream& os, const Report& node, int depth)
+{
+    os << std::setw(12) << node.inclusive << std::setw(12) << node.exclusive << std::setw(12) << node.calls
+       << "  " << std::string(2 * depth, ' ') << node.name << '\n';
+    for (const auto& child : node.children)
+        writeTreeNode(os, child, depth + 1);
+}
+
+void writeChromeEvents(std::ostream& os, const Report& node, size_t tid, double ts, bool& first)
+{
+    os << (first ? "\n" : ",\n") << "{\"name\":";
+    first = false;
+    writeJsonString(os, node.name);
+    os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << ts * 1e6 << ",\"dur\":" << node.inclusive * 1e6
+       << ",\"args\":{\"calls\":" << node.calls << ",\"exclusive_us\":" << node.exclusive * 1e6 << "}}";
+    for (const auto& child : node.children) {
+        writeChromeEvents(os, child, tid, ts, first);
+        ts += child.inclusive;
+    }
+}
+
+void writeFoldedNode(std::ostream& os, const Report& node, const std::string& path)
+{
+    const auto microseconds = std::llround(node.exclusive * 1e6);
+    if (microseconds > 0)
+        os << path << ' ' << microseconds << '\n';
+    for (const auto& child : node.children)
+        writeFoldedNode(os, child, path + ';' + child.name);
+}
+
+/** Restores the format flags of a stream */
+class FormatGuard
+{
+public:
+    explicit FormatGuard(std::ostream& os): os{os}, saved{nullptr} { saved.copyfmt(os); }
+    ~FormatGuard() { os.copyfmt(saved); }
+
+private:
+    std::ostream& os;
+    std::ios saved;
+};
+}  // namespace
+
+ScopedProfiler::Zone::Zone(const char* name)
+{
+    auto& reg = registry();
+    auto lock = std::lock_guard{reg.mutex};
+    zoneId = static_cast<uint32_t>(reg.zones.size());
+    reg.zones.emplace_back(name);
+}
+
+ScopedProfiler::Node* ScopedProfiler::threadRoot()
+{
+    {
+        auto& reg = registry();
+        auto lock = std::lock_guard{reg.mutex};
+        const auto it = std::find_if(reg.threads.begin(), reg.threads.end(),
+                                     [](const auto& thread) { return thread->released; });
+        if (it != reg.threads.end()) {
+            (*it)->released = false;
+            profile = it->get();
+        } else {
+            profile = reg.threads.emplace_back(std::make_unique<ThreadProfile>()).get();
+        }
+    }
+    thread_local auto release = ProfileRelease{};
+    current = profile->count.load(std::memory_order_relaxed) > 0 ? profile->at(0) : profile->add(0, nullptr);
+    return current;
+}
+
+ScopedProfiler::Node* ScopedProfiler::addChild(Node* parent, uint32_t zone)
+{
+    Node* node = profile->add(zone, parent);
+    node->nextSibling = parent->firstChild;
+    parent->firstChild = node;
+    return node;
+}
+
+std::vector<ScopedProfiler::Report> ScopedProfiler::threadReports()
+{
+    auto& reg = registry();
+    auto lock = std::lock_guard{reg.mutex};
+    auto reports = std::vector<Report>{};
+    reports.reserve(reg.threads.size());
+    for (size_t t = 0; t < reg.threads.size(); ++t) {
+        auto& report = reports.emplace_back();
+        report.name = "thread " + std::to_string(t + 1);
+        TreeBuilder{*reg.threads[t], reg.zones}.add(report, 0);
+        setRootTime(report);
+    }
+    return reports;
+}
+
+ScopedProfiler::Report ScopedProfiler::report()
+{
+    auto all = Report{};
+    all.name = "all";
+    for (const auto& thread : threadReports())
+        for (const auto& child : thread.children)
+            merge(childNamed(all, child.name), child);
+    setRootTime(all);
+    return all;
+}
+
+void ScopedProfiler::writeTree(std::ostream& os)
+{
+    const auto guard = FormatGuard{os};
+    os << std::fixed << std::setprecision(6) << std::setw(12) << "inclusive" << std::setw(12) << "exclusive"
+       << std::setw(12) << "calls" << "  zone\n";
+    for (const auto& child : report().children)
+        writeTreeNode(os, child, 0);
+}
+
+void ScopedProfiler::writeChromeTrace(std::ostream& os)
+{
+    const auto guard = FormatGuard{os};
+    os << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    bool first = true;
+    const auto threads = threadReports();
+    for (size_t t = 0; t < threads.size(); ++t) {
+        os << (first ? "\n" : ",\n") << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << t + 1
+           << R"(,"args":{"name":)";
+        first = false;
+        writeJsonString(os, threads[t].name);
+        os << "}}";
+        double ts = 0;
+        for (const auto& child : threads[t].children) {
+            writeChromeEvents(os, child, t + 1, ts, first);
+            ts += child.inclusive;
+        }
+    }
+    os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void ScopedProfiler::writeFolded(std::ostream& os)
+{
+    for (const auto& child : report().children)
+        writeFoldedNode(os, child, child.name);
+}
+
+void ScopedProfiler::reset()
+{
+    auto& reg = registry();
+    auto lock = std::lock_guard{reg.mutex};
+    for (const auto& thread : reg.threads) {
+        const size_t count = thread->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            Node* node = thread->at(i);
+            node->calls.store(0, std::memory_order_relaxed);
+            node->ticks.store(0, std::memory_order_relaxed);
+            node->childrenTicks.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+}  // namespace base
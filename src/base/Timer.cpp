@@ -22,14 +22,14 @@ Timer::AutoStartStop::AutoStartStop(Timer& t): timer(t) { timer.start(); }
 
 Timer::AutoStartStop::~AutoStartStop() { timer.pause(); }
 
-Timer::Timer(bool running): paused(!running) { timer = std::chrono::system_clock::now(); }
+Timer::Timer(bool running): paused(!running) { timer = std::chrono::steady_clock::now(); }
 
 void Timer::pause()
 {
     assert(!paused);
     if (!paused) {
         paused = true;
-        auto end = std::chrono::system_clock::now();
+        auto end = std::chrono::steady_clock::now();
         nanoseconds += end - timer;
     }
 }
@@ -38,14 +38,14 @@ void Timer::start()
 {
     assert(paused);
     paused = false;
-    timer = std::chrono::system_clock::now();
+    timer = std::chrono::steady_clock::now();
 }
 
 double Timer::getElapsed()
 {
     auto time = nanoseconds;
     if (!paused) {
-        auto end = std::chrono::system_clock::now();
+        auto end = std::chrono::steady_clock::now();
         time += end - timer;
     }
     return std::chrono::duration_cast<std::chrono::milliseconds>(time).count() / 1000.0;
@@ -13,23 +13,274 @@
 
 #include "base/bitstring.h"
 
-/* Algorithm:
- * - go through bit table and index table in parallel
- * - write index when bit is set
+#include "base/cpu.h"
+
+/* Portable index table kernels: iterate over the set bits only,
+ * count trailing zeros gives the position of the lowest one and
+ * b &= b - 1 clears it.
  */
-size_t base_bits2indexTable(const uint32_t* bits, size_t n, cindex_t* table)
+
+static inline uint32_t bits_ctz(uint32_t b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(b);
+#else
+    uint32_t i = 0;
+    for (; (b & 1) == 0; b >>= 1)
+        ++i;
+    return i;
+#endif
+}
+
+static size_t bits2indexTable_ctz(const uint32_t* bits, size_t n, cindex_t* table)
 {
     size_t index = 0;
-    uint32_t b;
-    cindex_t* t;
-    assert(table && bits);
+    for (; n != 0; table += 32, --n) {
+        for (uint32_t b = *bits++; b != 0; b &= b - 1)
+            table[bits_ctz(b)] = (cindex_t)index++;
+    }
+    return index;
+}
+
+#ifdef BASE_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+/* Portable kernels: 64 bits at a time.
+ * memcpy avoids alignment issues and compiles to plain loads.
+ */
+
+static inline uint64_t bits_load64(const uint32_t* bits)
+{
+    uint64_t x;
+    memcpy(&x, bits, sizeof(x));
+    return x;
+}
+
+static inline uint32_t bits_count64(uint64_t x)
+{
+    x -= (x >> 1) & 0x5555555555555555ULL;
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (uint32_t)((x * 0x0101010101010101ULL) >> 56);
+}
+
+static uint32_t countBitsN_64(const uint32_t* bits, size_t n)
+{
+    uint32_t cnt = 0;
+    for (; n >= 2; bits += 2, n -= 2)
+        cnt += bits_count64(bits_load64(bits));
+    if (n)
+        cnt += base_countBits(*bits);
+    return cnt;
+}
+
+static bool areBitsReset_64(const uint32_t* bits, size_t n)
+{
+    uint64_t diff = 0;
+    for (; n >= 2; bits += 2, n -= 2)
+        diff |= bits_load64(bits);
+    if (n)
+        diff |= *bits;
+    return diff == 0;
+}
+
+static bool areBitsEqual_64(const uint32_t* bits1, const uint32_t* bits2, size_t n)
+{
+    uint64_t diff = 0;
+    for (; n >= 2; bits1 += 2, bits2 += 2, n -= 2)
+        diff |= bits_load64(bits1) ^ bits_load64(bits2);
+    if (n)
+        diff |= *bits1 ^ *bits2;
+    return diff == 0;
+}
+
+#ifdef BASE_X86_DISPATCH
+
+/* POPCNT: 4 independent counters to hide the instruction latency.
+ */
+BASE_TARGET("popcnt") static uint32_t countBitsN_popcnt(const uint32_t* bits, size_t n)
+{
+    uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    for (; n >= 8; bits += 8, n -= 8) {
+        c0 += __builtin_popcountll(bits_load64(bits));
+        c1 += __builtin_popcountll(bits_load64(bits + 2));
+        c2 += __builtin_popcountll(bits_load64(bits + 4));
+        c3 += __builtin_popcountll(bits_load64(bits + 6));
+    }
+    for (; n != 0; --n)
+        c0 += __builtin_popcount(*bits++);
+    return (uint32_t)(c0 + c1 + c2 + c3);
+}
+
+/* AVX2: nibble lookup table with vpshufb (W. Mula), the byte counts
+ * are summed into 64-bit lanes with vpsadbw.
+ */
+BASE_TARGET("avx2") static uint32_t countBitsN_avx2(const uint32_t* bits, size_t n)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1,
+                                            2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    uint64_t lanes[4];
+    uint32_t cnt;
+    for (; n >= 8; bits += 8, n -= 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)bits);
+        __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low));
+        __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    cnt = (uint32_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    return cnt + countBitsN_64(bits, n);
+}
+
+BASE_TARGET("avx2") static bool areBitsReset_avx2(const uint32_t* bits, size_t n)
+{
+    __m256i acc = _mm256_setzero_si256();
+    for (; n >= 8; bits += 8, n -= 8)
+        acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i*)bits));
+    return _mm256_testz_si256(acc, acc) && areBitsReset_64(bits, n);
+}
+
+BASE_TARGET("avx2") static bool areBitsEqual_avx2(const uint32_t* bits1, const uint32_t* bits2, size_t n)
+{
+    __m256i acc = _mm256_setzero_si256();
+    for (; n >= 8; bits1 += 8, bits2 += 8, n -= 8)
+        acc = _mm256_or_si256(acc, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)bits1),
+                                                     _mm256_loadu_si256((const __m256i*)bits2)));
+    return _mm256_testz_si256(acc, acc) && areBitsEqual_64(bits1, bits2, n);
+}
+
+/* AVX512: 16 ints at a time, the tail is read with a masked load.
+ */
+static inline __mmask16 bits_tailMask(size_t n) { return (__mmask16)((1u << n) - 1); }
+
+BASE_TARGET("avx512f,avx512vpopcntdq") static uint32_t countBitsN_avx512(const uint32_t* bits, size_t n)
+{
+    __m512i acc = _mm512_setzero_si512();
+    for (; n >= 16; bits += 16, n -= 16)
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512(bits)));
+    if (n)
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi32(bits_tailMask(n), bits)));
+    return (uint32_t)_mm512_reduce_add_epi64(acc);
+}
 
+BASE_TARGET("avx512f") static bool areBitsReset_avx512(const uint32_t* bits, size_t n)
+{
+    __m512i acc = _mm512_setzero_si512();
+    for (; n >= 16; bits += 16, n -= 16)
+        acc = _mm512_or_si512(acc, _mm512_loadu_si512(bits));
+    if (n)
+        acc = _mm512_or_si512(acc, _mm512_maskz_loadu_epi32(bits_tailMask(n), bits));
+    return _mm512_test_epi64_mask(acc, acc) == 0;
+}
+
+BASE_TARGET("avx512f") static bool areBitsEqual_avx512(const uint32_t* bits1, const uint32_t* bits2, size_t n)
+{
+    __m512i acc = _mm512_setzero_si512();
+    for (; n >= 16; bits1 += 16, bits2 += 16, n -= 16)
+        acc = _mm512_ternarylogic_epi64(acc, _mm512_loadu_si512(bits1), _mm512_loadu_si512(bits2), 0xf6); /* a|(b^c) */
+    if (n) {
+        __mmask16 tail = bits_tailMask(n);
+        acc = _mm512_ternarylogic_epi64(acc, _mm512_maskz_loadu_epi32(tail, bits1),
+                                        _mm512_maskz_loadu_epi32(tail, bits2), 0xf6);
+    }
+    return _mm512_test_epi64_mask(acc, acc) == 0;
+}
+
+/* vpexpandd writes consecutive elements of the source to the lanes
+ * selected by the mask, in order: expanding 0,1,2,... gives the rank
+ * of every set bit, which is stored with the same mask. 16 bits per step.
+ * Sparse words are cheaper with the ctz loop.
+ */
+BASE_TARGET("avx512f,popcnt")
+static size_t bits2indexTable_avx512(const uint32_t* bits, size_t n, cindex_t* table)
+{
+    const __m512i iota = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    size_t index = 0;
     for (; n != 0; table += 32, --n) {
-        for (b = *bits++, t = table; b != 0; ++t, b >>= 1) {
-            if (b & 1)
-                *t = index++;
+        uint32_t b = *bits++;
+        if (__builtin_popcount(b) <= 4) {
+            for (; b != 0; b &= b - 1)
+                table[__builtin_ctz(b)] = (cindex_t)index++;
+            continue;
+        }
+        for (cindex_t* t = table; b != 0; t += 16, b >>= 16) {
+            __mmask16 m = (__mmask16)b;
+            if (m) {
+                __m512i ranks = _mm512_maskz_expand_epi32(m, iota);
+                ranks = _mm512_add_epi32(ranks, _mm512_set1_epi32((int)index));
+                _mm512_mask_storeu_epi32(t, m, ranks);
+                index += (uint32_t)__builtin_popcount(m);
+            }
         }
     }
-
     return index;
 }
+
+#endif /* BASE_X86_DISPATCH */
+
+uint32_t base_countBitsNWide(const uint32_t* bits, size_t n)
+{
+    assert(n == 0 || bits);
+#ifdef BASE_X86_DISPATCH
+    uint32_t cpu = base_getCPUFeatures();
+    if (cpu & base_CPU_AVX512POPCNT)
+        return countBitsN_avx512(bits, n);
+    if (cpu & base_CPU_AVX2)
+        return countBitsN_avx2(bits, n);
+    if (cpu & base_CPU_POPCNT)
+        return countBitsN_popcnt(bits, n);
+#endif
+    return countBitsN_64(bits, n);
+}
+
+bool base_areBitsResetWide(const uint32_t* bits, size_t n)
+{
+    assert(n == 0 || bits);
+#ifdef BASE_X86_DISPATCH
+    uint32_t cpu = base_getCPUFeatures();
+    if (cpu & base_CPU_AVX512)
+        return areBitsReset_avx512(bits, n);
+    if (cpu & base_CPU_AVX2)
+        return areBitsReset_avx2(bits, n);
+#endif
+    return areBitsReset_64(bits, n);
+}
+
+bool base_areBitsEqualWide(const uint32_t* bits1, const uint32_t* bits2, size_t n)
+{
+    assert(n == 0 || (bits1 && bits2));
+#ifdef BASE_X86_DISPATCH
+    uint32_t cpu = base_getCPUFeatures();
+    if (cpu & base_CPU_AVX512)
+        return areBitsEqual_avx512(bits1, bits2, n);
+    if (cpu & base_CPU_AVX2)
+        return areBitsEqual_avx2(bits1, bits2, n);
+#endif
+    return areBitsEqual_64(bits1, bits2, n);
+}
+
+size_t base_bits2indexTable(const uint32_t* bits, size_t n, cindex_t* table)
+{
+    assert(n == 0 || (table && bits));
+#ifdef BASE_X86_DISPATCH
+    if (base_getCPUFeatures() & base_CPU_AVX512)
+        return bits2indexTable_avx512(bits, n, table);
+#endif
+    return bits2indexTable_ctz(bits, n, table);
+}
+
+void base_indexTable2bits(const cindex_t* indices, size_t size, uint32_t* bits, size_t n)
+{
+    assert(size == 0 || indices);
+    /* indices are increasing: build every word in a register */
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t b = 0;
+        for (; size != 0 && (*indices >> 5) == i; --size, ++indices)
+            b |= 1u << (*indices & 31);
+        bits[i] = b;
+    }
+    assert(size == 0);
+}
@@ -0,0 +1,57 @@
+/* -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/*********************************************************************
+ *
+ * Filename : cpu.cpp (base)
+ *
+ * This file is a part of the UPPAAL toolkit.
+ * Copyright (c) 2026, Aalborg University.
+ * All right reserved.
+ *
+ *********************************************************************/
+
+#include "base/cpu.h"
+
+#include <atomic>
+
+#ifdef BASE_X86_DISPATCH
+#include <cpuid.h>
+#endif
+
+static uint32_t cpu_detect()
+{
+    uint32_t features = 0;
+#ifdef BASE_X86_DISPATCH
+    // the builtins also check that the OS saves the extended registers
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("popcnt"))
+        features |= base_CPU_POPCNT;
+    if (__builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2"))
+        features |= base_CPU_BMI2;
+    if (__builtin_cpu_supports("sse2"))
+        features |= base_CPU_SSE2;
+    if (__builtin_cpu_supports("avx2"))
+        features |= base_CPU_AVX2;
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vl")) {
+        features |= base_CPU_AVX512;
+        if (__builtin_cpu_supports("avx512vpopcntdq"))
+            features |= base_CPU_AVX512POPCNT;
+    }
+    // invariant TSC: constant rate in all power states, synchronized across cores
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)) &&
+        __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) && (edx & (1u << 27)))  // rdtscp
+        features |= base_CPU_TSC;
+#endif
+    return features;
+}
+
+static std::atomic<uint32_t> cpu_mask{base_CPU_ALL};
+
+uint32_t base_getCPUFeatures()
+{
+    static const uint32_t features = cpu_detect();
+    return features & cpu_mask.load(std::memory_order_relaxed);
+}
+
+void base_setCPUFeatureMask(uint32_t mask) { cpu_mask.store(mask, std::memory_order_relaxed); }
@@ -15,34 +15,435 @@
 
 #include "base/intutils.h"
 
+#include "base/cpu.h"
 #include "debug/macros.h"
 
 #include <algorithm>
-#include <numeric>
 #include <cassert>
 
-/* Optimistic implementation of equality: accumulate
- * a difference and test it at the end.
+#ifdef BASE_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+/* The kernels accumulate differences without branches and test the
+ * accumulator once per block: equal vectors, the common case, are
+ * read at full bandwidth and different ones still exit early.
+ * Inputs up to INT_INLINE_MAX ints do not pay for the dispatch.
  */
-uint32_t base_diff(const void* data, size_t n, uint32_t mask)
+enum { INT_INLINE_MAX = 8 };
+
+static uint32_t diff_32(const uint32_t* a, size_t n, uint32_t mask)
+{
+    uint32_t acc = 0;
+    for (size_t i = 0; i < n; ++i)
+        acc |= a[i] ^ mask;
+    return acc;
+}
+
+static bool areEqual_32(const uint32_t* a, const uint32_t* b, size_t n)
+{
+    uint32_t acc = 0;
+    for (size_t i = 0; i < n; ++i)
+        acc |= a[i] ^ b[i];
+    return acc == 0;
+}
+
+static size_t firstDifference_32(const int32_t* a, const int32_t* b, size_t n)
 {
-    const uint32_t* a = (uint32_t*)data;
-    return std::accumulate(a, a + n, 0, [mask](auto sum, auto value) { return sum | (value ^ mask); });
+    size_t i = 0;
+    while (i < n && a[i] == b[i])
+        ++i;
+    return i;
 }
 
-/* Semi-optimistic implementation of equality testing.
+/* Relations accumulate which of a > b and a < b happened:
+ * both means base_DIFFERENT.
  */
+static inline relation_t int_relation(bool greater, bool less)
+{
+    return (relation_t)((greater ? 0 : base_SUBSET) | (less ? 0 : base_SUPERSET));
+}
+
+static relation_t relation_32(const int32_t* a, const int32_t* b, size_t n)
+{
+    bool gt = false, lt = false;
+    for (size_t i = 0; i < n; ++i) {
+        gt |= a[i] > b[i];
+        lt |= a[i] < b[i];
+        if (gt && lt)
+            return base_DIFFERENT;
+    }
+    return int_relation(gt, lt);
+}
+
+#ifdef BASE_X86_DISPATCH
+
+/* SSE2: blocks of 4 vectors = 16 ints. */
+
+BASE_TARGET("sse2")
+static uint32_t diff_sse2(const uint32_t* a, size_t n, uint32_t mask)
+{
+    const __m128i m = _mm_set1_epi32((int)mask);
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_or_si128(acc, _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i)), m));
+    acc = _mm_or_si128(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_or_si128(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(acc) | diff_32(a + i, n - i, mask);
+}
+
+BASE_TARGET("sse2")
+static bool areEqual_sse2(const uint32_t* a, const uint32_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i acc = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        for (size_t j = 4; j < 16; j += 4)
+            acc = _mm_or_si128(acc, _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i + j)),
+                                                  _mm_loadu_si128((const __m128i*)(b + i + j))));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(acc, _mm_setzero_si128())) != 0xffff)
+            return false;
+    }
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_or_si128(acc, _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i)),
+                                              _mm_loadu_si128((const __m128i*)(b + i))));
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(acc, _mm_setzero_si128())) == 0xffff && areEqual_32(a + i, b + i, n - i);
+}
+
+BASE_TARGET("sse2")
+static void fill_sse2(uint32_t* a, size_t n, uint32_t value)
+{
+    const __m128i v = _mm_set1_epi32((int)value);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_si128((__m128i*)(a + i), v);
+    for (; i < n; ++i)
+        a[i] = value;
+}
+
+BASE_TARGET("sse2")
+static size_t firstDifference_sse2(const int32_t* a, const int32_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        unsigned ne = ~(unsigned)_mm_movemask_ps(_mm_castsi128_ps(eq)) & 0xf;
+        if (ne)
+            return i + __builtin_ctz(ne);
+    }
+    return i + firstDifference_32(a + i, b + i, n - i);
+}
+
+BASE_TARGET("sse2")
+static relation_t relation_sse2(const int32_t* a, const int32_t* b, size_t n)
+{
+    __m128i gt = _mm_setzero_si128(), lt = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        gt = _mm_or_si128(gt, _mm_cmpgt_epi32(x, y));
+        lt = _mm_or_si128(lt, _mm_cmplt_epi32(x, y));
+        if ((i & 12) == 12 && _mm_movemask_epi8(gt) && _mm_movemask_epi8(lt))
+            return base_DIFFERENT;
+    }
+    relation_t rel = int_relation(_mm_movemask_epi8(gt), _mm_movemask_epi8(lt));
+    return rel == base_DIFFERENT ? rel : (relation_t)(rel & relation_32(a + i, b + i, n - i));
+}
+
+/* AVX2: blocks of 4 vectors = 32 ints. */
+
+BASE_TARGET("avx2")
+static uint32_t diff_avx2(const uint32_t* a, size_t n, uint32_t mask)
+{
+    const __m256i m = _mm256_set1_epi32((int)mask);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        acc = _mm256_or_si256(acc, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i)), m));
+    __m128i r = _mm_or_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    r = _mm_or_si128(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2)));
+    r = _mm_or_si128(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(r) | diff_32(a + i, n - i, mask);
+}
+
+BASE_TARGET("avx2")
+static bool areEqual_avx2(const uint32_t* a, const uint32_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i acc = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                       _mm256_loadu_si256((const __m256i*)(b + i)));
+        for (size_t j = 8; j < 32; j += 8)
+            acc = _mm256_or_si256(acc, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i + j)),
+                                                        _mm256_loadu_si256((const __m256i*)(b + i + j))));
+        if (!_mm256_testz_si256(acc, acc))
+            return false;
+    }
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8)
+        acc = _mm256_or_si256(acc, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                                    _mm256_loadu_si256((const __m256i*)(b + i))));
+    return _mm256_testz_si256(acc, acc) && areEqual_32(a + i, b + i, n - i);
+}
+
+BASE_TARGET("avx2")
+static void fill_avx2(uint32_t* a, size_t n, uint32_t value)
+{
+    const __m256i v = _mm256_set1_epi32((int)value);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_si256((__m256i*)(a + i), v);
+    for (; i < n; ++i)
+        a[i] = value;
+}
+
+/* Skip the equal prefix with the block test of areEqual, then
+ * locate the difference: one movemask gives the first unequal int.
+ */
+BASE_TARGET("avx2")
+static size_t firstDifference_avx2(const int32_t* a, const int32_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t j = 0; j < 32; j += 8)
+            acc = _mm256_or_si256(acc, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i + j)),
+                                                        _mm256_loadu_si256((const __m256i*)(b + i + j))));
+        if (!_mm256_testz_si256(acc, acc))
+            break;
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                        _mm256_loadu_si256((const __m256i*)(b + i)));
+        unsigned ne = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(eq)) & 0xff;
+        if (ne)
+            return i + __builtin_ctz(ne);
+    }
+    return i + firstDifference_32(a + i, b + i, n - i);
+}
+
+BASE_TARGET("avx2")
+static relation_t relation_avx2(const int32_t* a, const int32_t* b, size_t n)
+{
+    __m256i gt = _mm256_setzero_si256(), lt = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        gt = _mm256_or_si256(gt, _mm256_cmpgt_epi32(x, y));
+        lt = _mm256_or_si256(lt, _mm256_cmpgt_epi32(y, x));
+        if ((i & 24) == 24 && !_mm256_testz_si256(gt, gt) && !_mm256_testz_si256(lt, lt))
+            return base_DIFFERENT;
+    }
+    relation_t rel = int_relation(!_mm256_testz_si256(gt, gt), !_mm256_testz_si256(lt, lt));
+    return rel == base_DIFFERENT ? rel : (relation_t)(rel & relation_32(a + i, b + i, n - i));
+}
+
+/* AVX-512: blocks of 4 vectors = 64 ints, masked tail. */
+
+BASE_TARGET("avx512f")
+static inline __mmask16 int_tailMask(size_t n) { return (__mmask16)((1u << n) - 1); }
+
+BASE_TARGET("avx512f")
+static uint32_t diff_avx512(const uint32_t* a, size_t n, uint32_t mask)
+{
+    const __m512i m = _mm512_set1_epi32((int)mask);
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        acc = _mm512_or_si512(acc, _mm512_xor_si512(_mm512_loadu_si512(a + i), m));
+    if (i < n) {
+        const __mmask16 t = int_tailMask(n - i);
+        acc = _mm512_mask_or_epi32(acc, t, acc, _mm512_xor_si512(_mm512_maskz_loadu_epi32(t, a + i), m));
+    }
+    return (uint32_t)_mm512_reduce_or_epi32(acc);
+}
+
+BASE_TARGET("avx512f")
+static bool areEqual_avx512(const uint32_t* a, const uint32_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i acc = _mm512_xor_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+        for (size_t j = 16; j < 64; j += 16)
+            acc = _mm512_or_si512(acc, _mm512_xor_si512(_mm512_loadu_si512(a + i + j), _mm512_loadu_si512(b + i + j)));
+        if (_mm512_test_epi32_mask(acc, acc))
+            return false;
+    }
+    __m512i acc = _mm512_setzero_si512();
+    for (; i + 16 <= n; i += 16)
+        acc = _mm512_or_si512(acc, _mm512_xor_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+    if (i < n) {
+        const __mmask16 t = int_tailMask(n - i);
+        acc = _mm512_or_si512(acc, _mm512_xor_si512(_mm512_maskz_loadu_epi32(t, a + i), _mm512_maskz_loadu_epi32(t, b + i)));
+    }
+    return _mm512_test_epi32_mask(acc, acc) == 0;
+}
+
+BASE_TARGET("avx512f")
+static void fill_avx512(uint32_t* a, size_t n, uint32_t value)
+{
+    const __m512i v = _mm512_set1_epi32((int)value);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_si512(a + i, v);
+    if (i < n)
+        _mm512_mask_storeu_epi32(a + i, int_tailMask(n - i), v);
+}
+
+BASE_TARGET("avx512f")
+static size_t firstDifference_avx512(const int32_t* a, const int32_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i acc = _mm512_xor_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+        for (size_t j = 16; j < 64; j += 16)
+            acc = _mm512_or_si512(acc, _mm512_xor_si512(_mm512_loadu_si512(a + i + j), _mm512_loadu_si512(b + i + j)));
+        if (_mm512_test_epi32_mask(acc, acc))
+            break;
+    }
+    for (; i < n; i += 16) {
+        const __mmask16 t = n - i >= 16 ? (__mmask16)0xffff : int_tailMask(n - i);
+        __mmask16 ne = _mm512_mask_cmpneq_epi32_mask(t, _mm512_maskz_loadu_epi32(t, a + i),
+                                                     _mm512_maskz_loadu_epi32(t, b + i));
+        if (ne)
+            return i + __builtin_ctz(ne);
+    }
+    return n;
+}
+
+BASE_TARGET("avx512f")
+static relation_t relation_avx512(const int32_t* a, const int32_t* b, size_t n)
+{
+    __mmask16 gt = 0, lt = 0;
+    for (size_t i = 0; i < n; i += 16) {
+        const __mmask16 t = n - i >= 16 ? (__mmask16)0xffff : int_tailMask(n - i);
+        __m512i x = _mm512_maskz_loadu_epi32(t, a + i);
+        __m512i y = _mm512_maskz_loadu_epi32(t, b + i);
+        gt |= _mm512_cmpgt_epi32_mask(x, y);
+        lt |= _mm512_cmplt_epi32_mask(x, y);
+        if (gt && lt)
+            return base_DIFFERENT;
+    }
+    return int_relation(gt, lt);
+}
+
+#endif /* BASE_X86_DISPATCH */
+
+typedef relation_t (*relation_f)(const int32_t*, const int32_t*, size_t);
+
+static relation_f relationKernel(size_t n)
+{
+#ifdef BASE_X86_DISPATCH
+    if (n > INT_INLINE_MAX) {
+        uint32_t cpu = base_getCPUFeatures();
+        if (cpu & base_CPU_AVX512)
+            return relation_avx512;
+        if (cpu & base_CPU_AVX2)
+            return relation_avx2;
+        if (cpu & base_CPU_SSE2)
+            return relation_sse2;
+    }
+#endif
+    return relation_32;
+}
+
+uint32_t base_diff(const void* data, size_t n, uint32_t mask)
+{
+    const uint32_t* a = (const uint32_t*)data;
+    assert(n == 0 || a);
+#ifdef BASE_X86_DISPATCH
+    if (n > INT_INLINE_MAX) {
+        uint32_t cpu = base_getCPUFeatures();
+        if (cpu & base_CPU_AVX512)
+            return diff_avx512(a, n, mask);
+        if (cpu & base_CPU_AVX2)
+            return diff_avx2(a, n, mask);
+        if (cpu & base_CPU_SSE2)
+            return diff_sse2(a, n, mask);
+    }
+#endif
+    return diff_32(a, n, mask);
+}
+
 bool base_areEqual(const void* data1, const void* data2, size_t n)
 {
     if (data1 == data2) {
         return true;
     } else if (data1 == nullptr || data2 == nullptr) {
         return false;  // since different pointers
-    } else {
-        const uint32_t* a = (uint32_t*)data1;
-        const uint32_t* b = (uint32_t*)data2;
-        return std::equal(a, a + n, b);
     }
+    const uint32_t* a = (const uint32_t*)data1;
+    const uint32_t* b = (const uint32_t*)data2;
+#ifdef BASE_X86_DISPATCH
+    if (n > INT_INLINE_MAX) {
+        uint32_t cpu = base_getCPUFeatures();
+        if (cpu & base_CPU_AVX512)
+            return areEqual_avx512(a, b, n);
+        if (cpu & base_CPU_AVX2)
+            return areEqual_avx2(a, b, n);
+        if (cpu & base_CPU_SSE2)
+            return areEqual_sse2(a, b, n);
+    }
+#endif
+    return areEqual_32(a, b, n);
+}
+
+void base_fill(int32_t* from, int32_t* to, uint32_t intval)
+{
+    assert(from <= to);
+    uint32_t* a = (uint32_t*)from;
+    const size_t n = to - from;
+#ifdef BASE_X86_DISPATCH
+    if (n > INT_INLINE_MAX) {
+        uint32_t cpu = base_getCPUFeatures();
+        if (cpu & base_CPU_AVX512)
+            return fill_avx512(a, n, intval);
+        if (cpu & base_CPU_AVX2)
+            return fill_avx2(a, n, intval);
+        if (cpu & base_CPU_SSE2)
+            return fill_sse2(a, n, intval);
+    }
+#endif
+    std::fill(a, a + n, intval);
+}
+
+size_t base_firstDifference(const int32_t* data1, const int32_t* data2, size_t n)
+{
+    assert(n == 0 || (data1 && data2));
+#ifdef BASE_X86_DISPATCH
+    if (n > INT_INLINE_MAX) {
+        uint32_t cpu = base_getCPUFeatures();
+        if (cpu & base_CPU_AVX512)
+            return firstDifference_avx512(data1, data2, n);
+        if (cpu & base_CPU_AVX2)
+            return firstDifference_avx2(data1, data2, n);
+        if (cpu & base_CPU_SSE2)
+            return firstDifference_sse2(data1, data2, n);
+    }
+#endif
+    return firstDifference_32(data1, data2, n);
 }
 
-void base_fill(int32_t* from, int32_t* to, uint32_t intval) { std::fill(from, to, intval); }
+relation_t base_relation(const int32_t* data1, const int32_t* data2, size_t n)
+{
+    assert(n == 0 || (data1 && data2));
+    return relationKernel(n)(data1, data2, n);
+}
+
+size_t base_relations(const int32_t* data1, const int32_t* const* data2, size_t count, size_t n,
+                      relation_t* relations)
+{
+    assert(count == 0 || (data2 && relations));
+    assert(n == 0 || count == 0 || data1);
+    const relation_f relation = relationKernel(n);
+    size_t included = 0;
+    for (size_t k = 0; k < count; ++k) {
+        relations[k] = relation(data1, data2[k], n);
+        included += (relations[k] & base_SUBSET) != 0;
+    }
+    return included;
+}
@@ -16,7 +16,6 @@
 
 #include <string.h>
 #include <time.h>
-#include <ctype.h>
 
 /* GCC -- ANSI C */
 
@@ -84,46 +83,94 @@ void base_getMemInfo(meminfo_t* info)
 
 #elif __linux__
 
-static uint64_t read_key_mem_kb(FILE* f, const char* key)
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+/* A /proc file read with one pread into a fixed buffer, the descriptor kept open
+ * (and closed in forked children for the files of /proc/self). */
+typedef struct proc_file_t
 {
-    int match = 0;
-    int c = fgetc(f);
-    for (; c != EOF; c = fgetc(f))
-        if (key[match] == c) {
-            ++match;
-            if (key[match] == '\0')
-                break;
-        } else
-            match = 0;
-    if (c == EOF)
-        return 0;
-    for (c = fgetc(f); c != EOF && isspace(c); c = fgetc(f))
-        ;
-    if (c == EOF)
-        return 0;
-    if (ungetc(c, f) == EOF)
-        return 0;
-    uint64_t res = 0;
-    c = fscanf(f, "%" SCNu64, &res);
-    if (c == EOF)
+    const char* path;
+    _Atomic int fd;  // -1 until opened
+} proc_file_t;
+
+static proc_file_t proc_meminfo = {"/proc/meminfo", -1};
+static proc_file_t proc_status = {"/proc/self/status", -1};
+
+static void proc_forget_self(void)
+{
+    int fd = atomic_exchange(&proc_status.fd, -1);
+    if (fd >= 0)
+        close(fd);
+}
+
+static void proc_register_fork(void) { pthread_atfork(NULL, NULL, proc_forget_self); }
+
+/* Reads the file into buf (NUL-terminated), returns the length, 0 on errors. */
+static size_t proc_read(proc_file_t* file, char* buf, size_t size)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    int fd = atomic_load_explicit(&file->fd, memory_order_acquire);
+    if (fd < 0) {
+        pthread_once(&once, proc_register_fork);
+        int opened = open(file->path, O_RDONLY | O_CLOEXEC);
+        if (opened < 0)
+            return 0;
+        fd = -1;
+        if (atomic_compare_exchange_strong(&file->fd, &fd, opened))
+            fd = opened;
+        else
+            close(opened);  // another thread was faster
+    }
+    ssize_t n = pread(fd, buf, size - 1, 0);
+    if (n <= 0)
         return 0;
-    return res;
+    buf[n] = '\0';
+    return n;
+}
+
+/* Scans the number after the key at the start of a line, from the cursor line on (the keys
+ * are read in the order of the file) or else from the start, returns 0 if not found. */
+static uint64_t scan_key(const char* text, const char** cursor, const char* key)
+{
+    size_t len = strlen(key);
+    const char* line = *cursor;
+    for (int pass = 0; pass < 2; ++pass, line = text) {
+        while (line != NULL && *line != '\0') {
+            if (strncmp(line, key, len) == 0) {
+                const char* p = line + len;
+                uint64_t value = 0;
+                while (*p == ' ' || *p == '\t')
+                    ++p;
+                for (; *p >= '0' && *p <= '9'; ++p)
+                    value = value * 10 + (*p - '0');
+                *cursor = p;
+                return value;
+            }
+            line = strchr(line, '\n');
+            if (line != NULL)
+                ++line;
+        }
+    }
+    return 0;
 }
 
 void base_getMemInfo(meminfo_t* info)
 {
     /* based on Linux/Documentation/filesystems/proc.txt#meminfo */
+    char buf[4096];
     memset(info, 0, sizeof(*info));
-    FILE* ps = fopen("/proc/meminfo", "r");
-    if (!ps)
+    if (proc_read(&proc_meminfo, buf, sizeof(buf)) == 0)
         return;
-    info->phys_total = read_key_mem_kb(ps, "MemTotal:");
-    info->phys_avail = read_key_mem_kb(ps, "MemFree:");
-    info->phys_cache = read_key_mem_kb(ps, "Buffers:");
-    info->phys_cache += read_key_mem_kb(ps, "Cached:");
-    info->swap_total = read_key_mem_kb(ps, "SwapTotal:");
-    info->swap_avail = read_key_mem_kb(ps, "SwapFree:");
-    fclose(ps);
+    const char* cursor = buf;
+    info->phys_total = scan_key(buf, &cursor, "MemTotal:");
+    info->phys_avail = scan_key(buf, &cursor, "MemFree:");
+    info->phys_cache = scan_key(buf, &cursor, "Buffers:");
+    info->phys_cache += scan_key(buf, &cursor, "Cached:");
+    info->swap_total = scan_key(buf, &cursor, "SwapTotal:");
+    info->swap_avail = scan_key(buf, &cursor, "SwapFree:");
     info->virt_total = info->phys_total + info->swap_total;
     info->virt_avail = info->phys_avail + info->swap_avail;
 }
@@ -224,6 +271,7 @@ void base_getProcInfo(procinfo_t* info)
     info->mem_virt = (pmc.WorkingSetSize + pmc.PagefileUsage) >> 10;
     info->mem_work = pmc.WorkingSetSize >> 10;
     info->mem_swap = pmc.PagefileUsage >> 10;
+    info->faults_major = 0;  // PageFaultCount includes the soft faults
 
     li.LowPart = now.dwLowDateTime;
     li.HighPart = now.dwHighDateTime;
@@ -257,15 +305,16 @@ void base_getProcInfo(procinfo_t* info)
             return;
         info->time_user = 1000LLU * usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000;
         info->time_sys = 1000LLU * usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000;
+        info->faults_major = usage.ru_majflt;
     }
     // /proc/self/status includes VmSize and VmSwap (absent in /statm and /stat)
-    FILE* ps = fopen("/proc/self/status", "r");
-    if (ps == NULL)
+    char buf[4096];
+    if (proc_read(&proc_status, buf, sizeof(buf)) == 0)
         return;
-    info->mem_virt = read_key_mem_kb(ps, "VmSize:");
-    info->mem_work = read_key_mem_kb(ps, "VmRSS:");
-    info->mem_swap = read_key_mem_kb(ps, "VmSwap:");
-    fclose(ps);
+    const char* cursor = buf;
+    info->mem_virt = scan_key(buf, &cursor, "VmSize:");
+    info->mem_work = scan_key(buf, &cursor, "VmRSS:");
+    info->mem_swap = scan_key(buf, &cursor, "VmSwap:");
 }
 
 #elif defined(__APPLE__) && defined(__MACH__)
@@ -287,6 +336,9 @@ void base_getProcInfo(procinfo_t* info)
 
     info->time_real = 1000LLU * now.tv_sec + now.tv_usec / 1000;
 
+    struct rusage usage;
+    info->faults_major = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_majflt : 0;
+
     // Process stats
     struct task_basic_info tinfo;
     struct task_thread_times_info thinfo;
@@ -324,4 +376,5 @@ void base_getProcInfoMax(procinfo_t* info)
     info->time_user = MAX(info->time_user, c.time_user);
     info->time_sys = MAX(info->time_sys, c.time_sys);
     info->time_real = MAX(info->time_real, c.time_real);
+    info->faults_major = MAX(info->faults_major, c.faults_major);
 }
@@ -10,6 +10,10 @@
 
 #include "base/random.h"
 
+#include "base/cpu.h"
+#include "base/fast_random.hpp"
+#include "base/random_engines.hpp"
+
 #include <boost/math/distributions/arcsine.hpp>
 #include <boost/random.hpp>
 #include <boost/random/beta_distribution.hpp>
@@ -22,46 +26,451 @@
 #include <boost/random/uniform_real_distribution.hpp>
 #include <boost/random/weibull_distribution.hpp>
 // #include <random> standard implementation is 3-4x slower than boost (on Linux), see bm_random.cpp
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <cmath>
+#include <variant>
+
+#ifdef BASE_X86_DISPATCH
+#include <immintrin.h>
+#endif
 
 using namespace boost::random;
 
+using engine_t = RandomGenerator::engine_t;
+
 struct RandomGenerator::internalstate
 {
-    mt19937 rnd;  // randomness generator
+    // randomness generator, mt19937 has 2.5KB of state and is allocated only if selected
+    std::variant<base::philox4x32, base::xoshiro256pp, base::pcg64, std::unique_ptr<mt19937>> rnd;
+    uint64_t seed{0};    // of the stream
+    uint64_t stream{0};  // of the seed
+    uint64_t splits{0};  // number of streams split from this one
+
+    internalstate(engine_t engine, uint64_t seed, uint64_t stream) { reset(engine, seed, stream); }
+
+    void reset(engine_t engine, uint64_t seed, uint64_t stream)
+    {
+        switch (engine) {
+        case engine_t::philox: rnd.emplace<base::philox4x32>(seed, stream); break;
+        case engine_t::xoshiro256pp: rnd.emplace<base::xoshiro256pp>(seed, stream); break;
+        case engine_t::pcg64: rnd.emplace<base::pcg64>(seed, stream); break;
+        // seeds of consecutive default constructed generators were consecutive
+        case engine_t::mt19937: rnd = std::make_unique<mt19937>(static_cast<uint32_t>(seed + stream)); break;
+        }
+        this->seed = seed;
+        this->stream = stream;
+        splits = 0;
+    }
+
+    /** @return f(engine) */
+    template <typename F>
+    decltype(auto) visit(F&& f)
+    {
+        return std::visit([&f](auto& engine) -> decltype(auto) { return f(deref(engine)); }, rnd);
+    }
+
+private:
+    template <typename Engine>
+    static Engine& deref(Engine& engine)
+    {
+        return engine;
+    }
+    static mt19937& deref(std::unique_ptr<mt19937>& engine) { return *engine; }
+};
+
+namespace {
+/** values transformed per engine fill in the bulk variates */
+constexpr size_t FILL_CHUNK = 256;
+constexpr size_t ZIGGURAT_LAYERS = base::ziggurat::LAYERS;
+
+using counter_t = std::array<uint32_t, 4>;
+using key_t = std::array<uint32_t, 2>;
+
+/** the i-th word of the engine output, low half first */
+inline uint64_t word(const uint32_t* raw, size_t i) { return raw[2 * i] | uint64_t{raw[2 * i + 1]} << 32; }
+
+void unit_64(const uint32_t* raw, double* out, size_t n)
+{
+    for (size_t k = 0; k < n; ++k)
+        out[k] = base::random_unit(word(raw, k));
+}
+
+/** The first try of the Ziggurat method (see base::ziggurat) for every word:
+ * out[k] = shift + scale * z, negated if the word has a bit of signMask.
+ * @return the number of rejected tries, whose indices are in rejects.
+ */
+size_t zigguratFirst_64(const double* x, const uint32_t* raw, size_t n, double shift, double scale,
+                        uint64_t signMask, double* out, uint32_t* rejects)
+{
+    size_t rejected = 0;
+    for (size_t k = 0; k < n; ++k) {
+        const uint64_t w = word(raw, k);
+        const size_t i = w & (ZIGGURAT_LAYERS - 1);
+        const double z = base::random_unit(w) * x[i];
+        rejects[rejected] = k;  // kept if rejected, without branches
+        rejected += !(z < x[i + 1]);
+        out[k] = shift + ((w & signMask) ? -scale : scale) * z;
+    }
+    return rejected;
+}
+
+#ifdef BASE_X86_DISPATCH
+
+/* Philox blocks with one block per 32-bit lane: the 32x32->64 bit
+ * products come from two _mul_epu32 on the even and odd lanes.
+ * The lanes are assigned to blocks so that the 4x4 transposes within
+ * 128-bit lanes leave the blocks in order for contiguous stores.
+ * The output is the same as base::philox4x32::generate_blocks.
+ */
+
+BASE_TARGET("sse2")
+void philox_blocks_sse2(counter_t ctr, key_t k, uint32_t* out, size_t count)
+{
+    const __m128i m0 = _mm_set1_epi32(0xD2511F53), m1 = _mm_set1_epi32(0xCD9E8D57);
+    const __m128i lowMask = _mm_set1_epi64x(0xFFFFFFFF), highMask = _mm_set1_epi64x(~0xFFFFFFFFull);
+    const __m128i signBit = _mm_set1_epi32(INT32_MIN);
+    uint64_t pos = ctr[0] | uint64_t{ctr[1]} << 32;
+    for (; count >= 4; count -= 4, pos += 4, out += 16) {
+        const __m128i low = _mm_set1_epi32(static_cast<uint32_t>(pos));
+        __m128i c0 = _mm_add_epi32(low, _mm_setr_epi32(0, 1, 2, 3));
+        const __m128i carry = _mm_cmpgt_epi32(_mm_xor_si128(low, signBit), _mm_xor_si128(c0, signBit));
+        __m128i c1 = _mm_sub_epi32(_mm_set1_epi32(static_cast<uint32_t>(pos >> 32)), carry);
+        __m128i c2 = _mm_set1_epi32(ctr[2]), c3 = _mm_set1_epi32(ctr[3]);
+        __m128i k0 = _mm_set1_epi32(k[0]), k1 = _mm_set1_epi32(k[1]);
+        for (int round = 0; round < 10; ++round) {
+            const __m128i p0even = _mm_mul_epu32(c0, m0), p0odd = _mm_mul_epu32(_mm_srli_epi64(c0, 32), m0);
+            const __m128i p1even = _mm_mul_epu32(c2, m1), p1odd = _mm_mul_epu32(_mm_srli_epi64(c2, 32), m1);
+            const __m128i hi0 = _mm_or_si128(_mm_srli_epi64(p0even, 32), _mm_and_si128(p0odd, highMask));
+            const __m128i hi1 = _mm_or_si128(_mm_srli_epi64(p1even, 32), _mm_and_si128(p1odd, highMask));
+            c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), k0);
+            c1 = _mm_or_si128(_mm_and_si128(p1even, lowMask), _mm_slli_epi64(p1odd, 32));
+            c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), k1);
+            c3 = _mm_or_si128(_mm_and_si128(p0even, lowMask), _mm_slli_epi64(p0odd, 32));
+            k0 = _mm_add_epi32(k0, _mm_set1_epi32(0x9E3779B9));
+            k1 = _mm_add_epi32(k1, _mm_set1_epi32(0xBB67AE85));
+        }
+        const __m128i t0 = _mm_unpacklo_epi32(c0, c1), t1 = _mm_unpacklo_epi32(c2, c3);
+        const __m128i t2 = _mm_unpackhi_epi32(c0, c1), t3 = _mm_unpackhi_epi32(c2, c3);
+        _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128((__m128i*)(out + 8), _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128((__m128i*)(out + 12), _mm_unpackhi_epi64(t2, t3));
+    }
+    base::philox4x32::generate_blocks({static_cast<uint32_t>(pos), static_cast<uint32_t>(pos >> 32), ctr[2], ctr[3]},
+                                      k, out, count);
+}
+
+BASE_TARGET("avx2")
+void philox_blocks_avx2(counter_t ctr, key_t k, uint32_t* out, size_t count)
+{
+    const __m256i m0 = _mm256_set1_epi32(0xD2511F53), m1 = _mm256_set1_epi32(0xCD9E8D57);
+    const __m256i signBit = _mm256_set1_epi32(INT32_MIN);
+    // lane 4q+j computes block 2j+q
+    const __m256i offsets = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    uint64_t pos = ctr[0] | uint64_t{ctr[1]} << 32;
+    for (; count >= 8; count -= 8, pos += 8, out += 32) {
+        const __m256i low = _mm256_set1_epi32(static_cast<uint32_t>(pos));
+        __m256i c0 = _mm256_add_epi32(low, offsets);
+        const __m256i carry = _mm256_cmpgt_epi32(_mm256_xor_si256(low, signBit), _mm256_xor_si256(c0, signBit));
+        __m256i c1 = _mm256_sub_epi32(_mm256_set1_epi32(static_cast<uint32_t>(pos >> 32)), carry);
+        __m256i c2 = _mm256_set1_epi32(ctr[2]), c3 = _mm256_set1_epi32(ctr[3]);
+        __m256i k0 = _mm256_set1_epi32(k[0]), k1 = _mm256_set1_epi32(k[1]);
+        for (int round = 0; round < 10; ++round) {
+            const __m256i p0even = _mm256_mul_epu32(c0, m0), p0odd = _mm256_mul_epu32(_mm256_srli_epi64(c0, 32), m0);
+            const __m256i p1even = _mm256_mul_epu32(c2, m1), p1odd = _mm256_mul_epu32(_mm256_srli_epi64(c2, 32), m1);
+            const __m256i hi0 = _mm256_blend_epi32(_mm256_srli_epi64(p0even, 32), p0odd, 0xAA);
+            const __m256i hi1 = _mm256_blend_epi32(_mm256_srli_epi64(p1even, 32), p1odd, 0xAA);
+            c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), k0);
+            c1 = _mm256_blend_epi32(p1even, _mm256_slli_epi64(p1odd, 32), 0xAA);
+            c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), k1);
+            c3 = _mm256_blend_epi32(p0even, _mm256_slli_epi64(p0odd, 32), 0xAA);
+            k0 = _mm256_add_epi32(k0, _mm256_set1_epi32(0x9E3779B9));
+            k1 = _mm256_add_epi32(k1, _mm256_set1_epi32(0xBB67AE85));
+        }
+        const __m256i t0 = _mm256_unpacklo_epi32(c0, c1), t1 = _mm256_unpacklo_epi32(c2, c3);
+        const __m256i t2 = _mm256_unpackhi_epi32(c0, c1), t3 = _mm256_unpackhi_epi32(c2, c3);
+        _mm256_storeu_si256((__m256i*)out, _mm256_unpacklo_epi64(t0, t1));
+        _mm256_storeu_si256((__m256i*)(out + 8), _mm256_unpackhi_epi64(t0, t1));
+        _mm256_storeu_si256((__m256i*)(out + 16), _mm256_unpacklo_epi64(t2, t3));
+        _mm256_storeu_si256((__m256i*)(out + 24), _mm256_unpackhi_epi64(t2, t3));
+    }
+    base::philox4x32::generate_blocks({static_cast<uint32_t>(pos), static_cast<uint32_t>(pos >> 32), ctr[2], ctr[3]},
+                                      k, out, count);
+}
+
+BASE_TARGET("avx512f")
+void philox_blocks_avx512(counter_t ctr, key_t k, uint32_t* out, size_t count)
+{
+    const __m512i m0 = _mm512_set1_epi32(0xD2511F53), m1 = _mm512_set1_epi32(0xCD9E8D57);
+    // lane 4q+j computes block 4j+q
+    const __m512i offsets = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __mmask16 odd = 0xAAAA;
+    uint64_t pos = ctr[0] | uint64_t{ctr[1]} << 32;
+    for (; count >= 16; count -= 16, pos += 16, out += 64) {
+        const __m512i low = _mm512_set1_epi32(static_cast<uint32_t>(pos));
+        const __m512i high = _mm512_set1_epi32(static_cast<uint32_t>(pos >> 32));
+        __m512i c0 = _mm512_add_epi32(low, offsets);
+        __m512i c1 = _mm512_mask_add_epi32(high, _mm512_cmplt_epu32_mask(c0, low), high, _mm512_set1_epi32(1));
+        __m512i c2 = _mm512_set1_epi32(ctr[2]), c3 = _mm512_set1_epi32(ctr[3]);
+        __m512i k0 = _mm512_set1_epi32(k[0]), k1 = _mm512_set1_epi32(k[1]);
+        for (int round = 0; round < 10; ++round) {
+            const __m512i p0even = _mm512_mul_epu32(c0, m0), p0odd = _mm512_mul_epu32(_mm512_srli_epi64(c0, 32), m0);
+            const __m512i p1even = _mm512_mul_epu32(c2, m1), p1odd = _mm512_mul_epu32(_mm512_srli_epi64(c2, 32), m1);
+            const __m512i hi0 = _mm512_mask_blend_epi32(odd, _mm512_srli_epi64(p0even, 32), p0odd);
+            const __m512i hi1 = _mm512_mask_blend_epi32(odd, _mm512_srli_epi64(p1even, 32), p1odd);
+            c0 = _mm512_ternarylogic_epi32(hi1, c1, k0, 0x96);  // xor of 3
+            c1 = _mm512_mask_blend_epi32(odd, p1even, _mm512_slli_epi64(p1odd, 32));
+            c2 = _mm512_ternarylogic_epi32(hi0, c3, k1, 0x96);
+            c3 = _mm512_mask_blend_epi32(odd, p0even, _mm512_slli_epi64(p0odd, 32));
+            k0 = _mm512_add_epi32(k0, _mm512_set1_epi32(0x9E3779B9));
+            k1 = _mm512_add_epi32(k1, _mm512_set1_epi32(0xBB67AE85));
+        }
+        const __m512i t0 = _mm512_unpacklo_epi32(c0, c1), t1 = _mm512_unpacklo_epi32(c2, c3);
+        const __m512i t2 = _mm512_unpackhi_epi32(c0, c1), t3 = _mm512_unpackhi_epi32(c2, c3);
+        _mm512_storeu_si512(out, _mm512_unpacklo_epi64(t0, t1));
+        _mm512_storeu_si512(out + 16, _mm512_unpackhi_epi64(t0, t1));
+        _mm512_storeu_si512(out + 32, _mm512_unpacklo_epi64(t2, t3));
+        _mm512_storeu_si512(out + 48, _mm512_unpackhi_epi64(t2, t3));
+    }
+    base::philox4x32::generate_blocks({static_cast<uint32_t>(pos), static_cast<uint32_t>(pos >> 32), ctr[2], ctr[3]},
+                                      k, out, count);
+}
+
+/* The transforms load the engine output as 64-bit words (x86 is little
+ * endian) and compute random_unit() as (1.m - 1) + lowest bit * 2^-53 with m the
+ * upper 52 bits: exact, so the results equal the portable ones.
+ */
+
+BASE_TARGET("avx2")
+inline __m256d unit_avx2(__m256i w)
+{
+    const __m256i one = _mm256_set1_epi64x(0x3FF0000000000000);
+    const __m256d m = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(w, 12), one)),
+                                    _mm256_set1_pd(1.0));
+    const __m256i last = _mm256_set1_epi64x(1 << 11);
+    const __m256i isSet = _mm256_cmpeq_epi64(_mm256_and_si256(w, last), last);
+    return _mm256_add_pd(m, _mm256_and_pd(_mm256_castsi256_pd(isSet), _mm256_set1_pd(0x1.0p-53)));
+}
+
+BASE_TARGET("avx2")
+void unit_avx2(const uint32_t* raw, double* out, size_t n)
+{
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4)
+        _mm256_storeu_pd(out + k, unit_avx2(_mm256_loadu_si256((const __m256i*)(raw + 2 * k))));
+    unit_64(raw + 2 * k, out + k, n - k);
+}
+
+BASE_TARGET("avx2")
+size_t zigguratFirst_avx2(const double* x, const uint32_t* raw, size_t n, double shift, double scale,
+                                 uint64_t signMask, double* out, uint32_t* rejects)
+{
+    const __m256i layerMask = _mm256_set1_epi64x(ZIGGURAT_LAYERS - 1);
+    const __m256i sign = _mm256_set1_epi64x(signMask);
+    const __m256d shiftv = _mm256_set1_pd(shift), scalev = _mm256_set1_pd(scale);
+    size_t rejected = 0, k = 0;
+    for (; k + 4 <= n; k += 4) {
+        const __m256i w = _mm256_loadu_si256((const __m256i*)(raw + 2 * k));
+        const __m256i i = _mm256_and_si256(w, layerMask);
+        const __m256d z = _mm256_mul_pd(unit_avx2(w), _mm256_i64gather_pd(x, i, 8));
+        const __m256d accepted = _mm256_cmp_pd(z, _mm256_i64gather_pd(x + 1, i, 8), _CMP_LT_OQ);
+        for (uint32_t r = ~_mm256_movemask_pd(accepted) & 0xF; r != 0; r &= r - 1)
+            rejects[rejected++] = k + std::countr_zero(r);
+        const __m256i positive = _mm256_cmpeq_epi64(_mm256_and_si256(w, sign), _mm256_setzero_si256());
+        const __m256d s = _mm256_xor_pd(scalev, _mm256_andnot_pd(_mm256_castsi256_pd(positive), _mm256_set1_pd(-0.0)));
+        _mm256_storeu_pd(out + k, _mm256_add_pd(shiftv, _mm256_mul_pd(s, z)));
+    }
+    const size_t rest = zigguratFirst_64(x, raw + 2 * k, n - k, shift, scale, signMask, out + k, rejects + rejected);
+    for (size_t r = rejected; r < rejected + rest; ++r)
+        rejects[r] += k;
+    return rejected + rest;
+}
+
+BASE_TARGET("avx512f")
+inline __m512d unit_avx512(__m512i w)
+{
+    const __m512d m = _mm512_sub_pd(
+        _mm512_castsi512_pd(_mm512_or_si512(_mm512_srli_epi64(w, 12), _mm512_set1_epi64(0x3FF0000000000000))),
+        _mm512_set1_pd(1.0));
+    const __mmask8 last = _mm512_test_epi64_mask(w, _mm512_set1_epi64(1 << 11));
+    return _mm512_mask_add_pd(m, last, m, _mm512_set1_pd(0x1.0p-53));
+}
+
+BASE_TARGET("avx512f")
+void unit_avx512(const uint32_t* raw, double* out, size_t n)
+{
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8)
+        _mm512_storeu_pd(out + k, unit_avx512(_mm512_loadu_si512(raw + 2 * k)));
+    unit_64(raw + 2 * k, out + k, n - k);
+}
+
+BASE_TARGET("avx512f")
+size_t zigguratFirst_avx512(const double* x, const uint32_t* raw, size_t n, double shift, double scale,
+                                   uint64_t signMask, double* out, uint32_t* rejects)
+{
+    const __m512i layerMask = _mm512_set1_epi64(ZIGGURAT_LAYERS - 1);
+    const __m512i sign = _mm512_set1_epi64(signMask);
+    const __m512d shiftv = _mm512_set1_pd(shift), scalev = _mm512_set1_pd(scale);
+    size_t rejected = 0, k = 0;
+    for (; k + 8 <= n; k += 8) {
+        const __m512i w = _mm512_loadu_si512(raw + 2 * k);
+        const __m512i i = _mm512_and_si512(w, layerMask);
+        const __m512d z = _mm512_mul_pd(unit_avx512(w), _mm512_i64gather_pd(i, x, 8));
+        const __mmask8 accepted = _mm512_cmp_pd_mask(z, _mm512_i64gather_pd(i, x + 1, 8), _CMP_LT_OQ);
+        for (uint32_t r = static_cast<uint8_t>(~accepted); r != 0; r &= r - 1)
+            rejects[rejected++] = k + std::countr_zero(r);
+        const __m512d s = _mm512_mask_sub_pd(scalev, _mm512_test_epi64_mask(w, sign), _mm512_setzero_pd(), scalev);
+        _mm512_storeu_pd(out + k, _mm512_add_pd(shiftv, _mm512_mul_pd(s, z)));
+    }
+    const size_t rest = zigguratFirst_64(x, raw + 2 * k, n - k, shift, scale, signMask, out + k, rejects + rejected);
+    for (size_t r = rejected; r < rejected + rest; ++r)
+        rejects[r] += k;
+    return rejected + rest;
+}
+
+#endif /* BASE_X86_DISPATCH */
+
+/** kernels of the bulk variates for the processor */
+struct fill_kernels_t
+{
+    void (*blocks)(counter_t, key_t, uint32_t*, size_t);
+    void (*unit)(const uint32_t*, double*, size_t);
+    size_t (*zigguratFirst)(const double*, const uint32_t*, size_t, double, double, uint64_t, double*, uint32_t*);
 };
 
-static uint32_t sharedseed = 42;
+fill_kernels_t fillKernels()
+{
+#ifdef BASE_X86_DISPATCH
+    uint32_t cpu = base_getCPUFeatures();
+    if (cpu & base_CPU_AVX512)
+        return {philox_blocks_avx512, unit_avx512, zigguratFirst_avx512};
+    if (cpu & base_CPU_AVX2)
+        return {philox_blocks_avx2, unit_avx2, zigguratFirst_avx2};
+    if (cpu & base_CPU_SSE2)
+        return {philox_blocks_sse2, unit_64, zigguratFirst_64};
+#endif
+    return {base::philox4x32::generate_blocks, unit_64, zigguratFirst_64};
+}
 
-RandomGenerator::RandomGenerator(): s{new internalstate()} { seed(sharedseed++); }
+/** raw[0..n) = the next n/2 64-bit words of the engine output, low half first */
+void fillRaw(base::philox4x32& rnd, uint32_t* raw, size_t n, const fill_kernels_t& kernels)
+{
+    rnd.fill(raw, n, kernels.blocks);
+}
+
+template <typename Engine>
+void fillRaw(Engine& rnd, uint32_t* raw, size_t n, const fill_kernels_t&)
+{
+    assert(n % 2 == 0);
+    for (size_t i = 0; i < n; i += 2) {
+        const uint64_t w = base::random_bits64(rnd);
+        raw[i] = static_cast<uint32_t>(w);
+        raw[i + 1] = static_cast<uint32_t>(w >> 32);
+    }
+}
 
+/** out[k] = shift + scale * variate of zig, first tries vectorized */
+template <typename Engine>
+void zigguratFill(const base::ziggurat& zig, Engine& rnd, double* out, size_t n, double shift, double scale)
+{
+    uint32_t raw[2 * FILL_CHUNK];
+    uint32_t rejects[FILL_CHUNK];
+    const double* x = zig.layers();
+    const uint64_t signMask = zig.sign_mask();
+    const auto kernels = fillKernels();
+    while (n > 0) {
+        const size_t m = std::min(n, FILL_CHUNK);
+        fillRaw(rnd, raw, 2 * m, kernels);
+        const size_t rejected = kernels.zigguratFirst(x, raw, m, shift, scale, signMask, out, rejects);
+        for (size_t r = 0; r < rejected; ++r) {
+            const uint64_t w = word(raw, rejects[r]);
+            const size_t i = w & (ZIGGURAT_LAYERS - 1);
+            const double s = (w & signMask) ? -scale : scale;
+            out[rejects[r]] = shift + s * zig.retry(rnd, i, base::random_unit(w) * x[i]);
+        }
+        out += m;
+        n -= m;
+    }
+}
+}  // namespace
+
+// the seed and next stream of default constructed generators, packed to update both at once
+static std::atomic<uint64_t> sharedstream{uint64_t{42} << 32};
+static std::atomic<engine_t> sharedengine{engine_t::philox};
+
+RandomGenerator::RandomGenerator()
+{
+    const uint64_t next = sharedstream.fetch_add(1, std::memory_order_relaxed);
+    s = std::make_unique<internalstate>(sharedengine.load(std::memory_order_relaxed), next >> 32,
+                                        static_cast<uint32_t>(next));
+}
+
+RandomGenerator::RandomGenerator(uint64_t seed, uint64_t stream):
+    RandomGenerator{seed, stream, sharedengine.load(std::memory_order_relaxed)}
+{}
+
+RandomGenerator::RandomGenerator(uint64_t seed, uint64_t stream, engine_t engine):
+    s{std::make_unique<internalstate>(engine, seed, stream)}
+{}
+
+RandomGenerator::RandomGenerator(RandomGenerator&&) noexcept = default;
+RandomGenerator& RandomGenerator::operator=(RandomGenerator&&) noexcept = default;
 RandomGenerator::~RandomGenerator() noexcept = default;
 
-void RandomGenerator::set_seed(const uint32_t seed) { sharedseed = seed; }
+void RandomGenerator::set_seed(const uint32_t seed)
+{
+    sharedstream.store(uint64_t{seed} << 32, std::memory_order_relaxed);
+}
+
+void RandomGenerator::set_engine(engine_t engine) { sharedengine.store(engine, std::memory_order_relaxed); }
 
-void RandomGenerator::seed(const uint32_t seed) { s->rnd.seed(seed); }
+RandomGenerator::engine_t RandomGenerator::engine() const { return static_cast<engine_t>(s->rnd.index()); }
+
+void RandomGenerator::seed(const uint32_t seed) { s->reset(engine(), seed, 0); }
+
+RandomGenerator RandomGenerator::split()
+{
+    // mixing makes the children of nearby streams far apart
+    const uint64_t stream = base::splitmix64(s->stream ^ base::splitmix64(++s->splits));
+    return RandomGenerator{s->seed, stream, engine()};
+}
+
+void RandomGenerator::jump(uint64_t n)
+{
+    s->visit([n](auto& g) { g.discard(n); });
+}
 
-uint32_t RandomGenerator::uni(const uint32_t max) { return uniform_int_distribution<uint32_t>{0, max}(s->rnd); }
+uint32_t RandomGenerator::uni(const uint32_t max)
+{
+    return s->visit([&](auto& g) { return uniform_int_distribution<uint32_t>{0, max}(g); });
+}
 
 uint32_t RandomGenerator::uni(const uint32_t from, const uint32_t till)
 {
     assert(from <= till);
-    return uniform_int_distribution<uint32_t>{from, till}(s->rnd);
+    return s->visit([&](auto& g) { return uniform_int_distribution<uint32_t>{from, till}(g); });
 }
 
 int32_t RandomGenerator::uni(const int32_t from, const int32_t till)
 {
     assert(from <= till);
-    return uniform_int_distribution<int32_t>{from, till}(s->rnd);
+    return s->visit([&](auto& g) { return uniform_int_distribution<int32_t>{from, till}(g); });
 }
 
-double RandomGenerator::uni_1() { return uniform_real_distribution<double>{0.0, 1.0}(s->rnd); }
+double RandomGenerator::uni_1()
+{
+    return s->visit([](auto& g) { return uniform_real_distribution<double>{0.0, 1.0}(g); });
+}
 
 double RandomGenerator::uni_r(const double max)
 {
     assert(max > 0.);
     assert(max <= std::numeric_limits<double>::max());
-    return uniform_real_distribution<double>{0.0, max}(s->rnd);
+    return s->visit([&](auto& g) { return uniform_real_distribution<double>{0.0, max}(g); });
 }
 
 double RandomGenerator::uni_r(const double from, const double till)
@@ -69,13 +478,13 @@ double RandomGenerator::uni_r(const double from, const double till)
     assert(from < till);                                    // contradicts spec: >=from and <till where from==till
     assert(from >= std::numeric_limits<double>::lowest());  // boost loops on infinities
     assert(till <= std::numeric_limits<double>::max());
-    return uniform_real_distribution<double>{from, till}(s->rnd);
+    return s->visit([&](auto& g) { return uniform_real_distribution<double>{from, till}(g); });
 }
 
 double RandomGenerator::exp(const double rate)
 {
     assert(rate != 0);
-    return exponential_distribution<double>{rate}(s->rnd);
+    return s->visit([&](auto& g) { return exponential_distribution<double>{rate}(g); });
 }
 
 double RandomGenerator::arcsine(const double minv, const double maxv)
@@ -84,19 +493,19 @@ double RandomGenerator::arcsine(const double minv, const double maxv)
     assert(maxv <= std::numeric_limits<double>::max());
     assert(minv <= maxv);
     boost::math::arcsine_distribution<double> dis{minv, maxv};
-    return quantile(dis, uniform_real_distribution<double>{0.0, 1.0}(s->rnd));
+    return quantile(dis, s->visit([](auto& g) { return uniform_real_distribution<double>{0.0, 1.0}(g); }));
 }
 
 double RandomGenerator::beta(const double alpha, const double beta)
 {
     assert(alpha > 0 && beta > 0);
-    return beta_distribution<double>{alpha, beta}(s->rnd);
+    return s->visit([&](auto& g) { return beta_distribution<double>{alpha, beta}(g); });
 }
 
 double RandomGenerator::gamma(const double shape, const double scale)
 {
     assert(shape > 0 && scale > 0);
-    return gamma_distribution<double>{shape, scale}(s->rnd);
+    return s->visit([&](auto& g) { return gamma_distribution<double>{shape, scale}(g); });
 }
 
 double RandomGenerator::normal(const double mean, const double stddev)
@@ -105,19 +514,19 @@ double RandomGenerator::normal(const double mean, const double stddev)
     assert(mean <= std::numeric_limits<double>::max());
     assert(stddev >= std::numeric_limits<double>::lowest());  // boost loops on infinities
     assert(stddev <= std::numeric_limits<double>::max());
-    return normal_distribution<double>{mean, stddev}(s->rnd);
+    return s->visit([&](auto& g) { return normal_distribution<double>{mean, stddev}(g); });
 }
 
 double RandomGenerator::poisson(const double mean_rate)
 {
     assert(mean_rate > 0);
-    return poisson_distribution<int, double>{mean_rate}(s->rnd);
+    return s->visit([&](auto& g) { return poisson_distribution<int, double>{mean_rate}(g); });
 }
 
 double RandomGenerator::weibull(const double shape, const double scale)
 {
     assert(shape > 0 && scale > 0);
-    return weibull_distribution<double>{shape, scale}(s->rnd);
+    return s->visit([&](auto& g) { return weibull_distribution<double>{shape, scale}(g); });
 }
 
 double RandomGenerator::tri(const double lower, const double mode, const double upper)
@@ -126,5 +535,65 @@ double RandomGenerator::tri(const double lower, const double mode, const double
     assert(upper <= std::numeric_limits<double>::max());
     assert(lower <= mode);
     assert(mode <= upper);
-    return triangle_distribution<double>{lower, mode, upper}(s->rnd);
+    return s->visit([&](auto& g) { return triangle_distribution<double>{lower, mode, upper}(g); });
+}
+
+namespace {
+/** the interface of the distributions of base/random_distributions.hpp on an engine */
+template <typename Engine>
+struct engine_variates
+{
+    Engine& rnd;
+
+    double uni_1() { return base::random_unit(base::random_bits64(rnd)); }
+    double normal(double mean, double stddev) { return mean + stddev * base::ziggurat::normal()(rnd); }
+};
+
+template <typename Engine>
+engine_variates(Engine&) -> engine_variates<Engine>;
+}  // namespace
+
+template <typename Distribution>
+double RandomGenerator::draw_from_engine(const Distribution& dist)
+{
+    return s->visit([&](auto& g) {
+        auto variates = engine_variates{g};
+        return dist(variates);
+    });
+}
+
+double RandomGenerator::draw(const base::arcsine_distribution& dist) { return draw_from_engine(dist); }
+double RandomGenerator::draw(const base::beta_distribution& dist) { return draw_from_engine(dist); }
+double RandomGenerator::draw(const base::gamma_distribution& dist) { return draw_from_engine(dist); }
+double RandomGenerator::draw(const base::poisson_distribution& dist) { return draw_from_engine(dist); }
+double RandomGenerator::draw(const base::weibull_distribution& dist) { return draw_from_engine(dist); }
+
+void RandomGenerator::fill_uni_1(double* out, size_t n)
+{
+    assert(n == 0 || out);
+    uint32_t raw[2 * FILL_CHUNK];
+    const auto kernels = fillKernels();
+    while (n > 0) {
+        const size_t m = std::min(n, FILL_CHUNK);
+        s->visit([&](auto& g) { fillRaw(g, raw, 2 * m, kernels); });
+        kernels.unit(raw, out, m);
+        out += m;
+        n -= m;
+    }
+}
+
+void RandomGenerator::fill_exp(const double rate, double* out, size_t n)
+{
+    assert(rate != 0);
+    assert(n == 0 || out);
+    s->visit([&](auto& g) { zigguratFill(base::ziggurat::exponential(), g, out, n, 0, 1 / rate); });
+}
+
+void RandomGenerator::fill_normal(const double mean, const double stddev, double* out, size_t n)
+{
+    assert(mean >= std::numeric_limits<double>::lowest());
+    assert(mean <= std::numeric_limits<double>::max());
+    assert(stddev >= 0 && stddev <= std::numeric_limits<double>::max());
+    assert(n == 0 || out);
+    s->visit([&](auto& g) { zigguratFill(base::ziggurat::normal(), g, out, n, mean, stddev); });
 }
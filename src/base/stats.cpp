@@ -11,105 +11,177 @@
 //
 ///////////////////////////////////////////////////////////////////
 
-#ifdef SHOW_STATS
-
 #include "base/stats.h"
 
-#include "hash/compute.h"
+#include "base/exceptions.h"
 #include "debug/macros.h"
 
+#include <algorithm>
+#include <array>
 #include <iostream>
-#include <cstdlib>
-#include <cstring>
-
-using namespace std;
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace base {
-// Entry sorter function.
-static int cmpentry(const void* a, const void* b)
+namespace {
+/** The slots of a thread in chunks that never move */
+struct Shard
+{
+    static constexpr size_t CHUNK = 512;
+    static constexpr size_t MAX_CHUNKS = 1024;
+
+    std::array<std::atomic<Stats::slot_t*>, MAX_CHUNKS> chunks{};
+    std::vector<std::unique_ptr<Stats::slot_t[]>> owned;  // of the owner thread only
+    bool released{false};                                 // by its exited thread, guarded by the registry
+
+    Stats::slot_t* slot(uint32_t id)
+    {
+        auto& chunk = chunks[id / CHUNK];
+        Stats::slot_t* slots = chunk.load(std::memory_order_relaxed);
+        if (!slots) {
+            slots = owned.emplace_back(std::make_unique<Stats::slot_t[]>(CHUNK)).get();
+            chunk.store(slots, std::memory_order_release);
+        }
+        return slots + id % CHUNK;
+    }
+
+    int64_t get(uint32_t id) const
+    {
+        const Stats::slot_t* slots = chunks[id / CHUNK].load(std::memory_order_acquire);
+        return slots ? slots[id % CHUNK].load(std::memory_order_relaxed) : 0;
+    }
+};
+
+struct Registry
 {
-    Stats::entry_t** first = (Stats::entry_t**)a;
-    Stats::entry_t** second = (Stats::entry_t**)b;
-    assert(a && b);
-    return strcmp((*first)->stat.name, (*second)->stat.name);
+    std::mutex mutex;
+    std::map<std::pair<std::string, std::string>, uint32_t> ids;  // sub-name "" for a main counter
+    std::vector<std::unique_ptr<Shard>> shards;                   // continued by the next new thread
+
+    uint32_t id(const char* statName, const char* subStat)
+    {
+        auto lock = std::lock_guard{mutex};
+        auto key = std::pair<std::string, std::string>{statName, subStat ? subStat : ""};
+        if (const auto it = ids.find(key); it != ids.end())
+            return it->second;
+        if (ids.size() == Shard::CHUNK * Shard::MAX_CHUNKS)
+            throw RuntimeException("Stats: too many counters %zu", ids.size());
+        const auto id = static_cast<uint32_t>(ids.size());
+        ids.emplace(std::move(key), id);
+        return id;
+    }
+
+    int64_t sum(uint32_t id)
+    {
+        int64_t total = 0;
+        for (const auto& shard : shards)
+            total += shard->get(id);
+        return total;
+    }
+};
+
+/** Never destroyed: the counters are printed by the destructor of the global Stats. */
+Registry& registry()
+{
+    static auto* value = new Registry;
+    return *value;
 }
 
-Stats stats;  // The global instance.
+thread_local Shard* shard = nullptr;
 
-Stats::~Stats()
+/** Releases the shard of the thread when it exits, its counts stay in the sums */
+struct ShardRelease
 {
-    // Convert table -> array.
-    size_t n = table.getNbBuckets();
-    entry_t** all = new entry_t*[n];
-    entry_t **end = &all[n], **a = all;
-    base::Enumerator<entry_t> tenum = table.getEnumerator();
-    for (entry_t* e = tenum.getNext(); e != NULL; ++a, e = tenum.getNext()) {
-        assert(a < end);
-        *a = e;
+    ~ShardRelease()
+    {
+        auto& reg = registry();
+        auto lock = std::lock_guard{reg.mutex};
+        shard->released = true;
     }
-    assert(a == end);
-    // Sort entries.
-    qsort(all, n, sizeof(entry_t*), cmpentry);
-
-    // Show stats.
-    cout.flush();
-    cerr.flush();
-    cerr << "\n******* Stats *******\n";
-    for (a = all; a < end; ++a) {
-        entry_t* s = *a;
-        cerr << BLUE(THIN) << s->stat.name << NORMAL ": " BLUE(BOLD) << s->stat.counter << NORMAL;
-        for (stat_t* sub = s->stat.next; sub != NULL; sub = sub->next) {
-            cerr << "; " BLUE(THIN) << sub->name << NORMAL ": " BLUE(BOLD) << sub->counter << NORMAL;
-            if (s->stat.counter) {
-                long pc = (100 * sub->counter) / s->stat.counter;
-                cerr << " (" << (pc > 75 ? GREEN(BOLD) : (pc < 25 ? RED(BOLD) : CYAN(BOLD))) << pc << "%" NORMAL ")";
+};
+
+/** @return the shard of the calling thread: released by a finished thread or new */
+Shard& threadShard()
+{
+    if (!shard) {
+        {
+            auto& reg = registry();
+            auto lock = std::lock_guard{reg.mutex};
+            const auto it = std::find_if(reg.shards.begin(), reg.shards.end(),
+                                         [](const auto& s) { return s->released; });
+            if (it != reg.shards.end()) {
+                (*it)->released = false;
+                shard = it->get();
+            } else {
+                shard = reg.shards.emplace_back(std::make_unique<Shard>()).get();
             }
         }
-        cerr << endl;
+        thread_local auto release = ShardRelease{};
+    }
+    return *shard;
+}
+}  // namespace
+
+Stats stats;  // The global instance.
+
+Stats::Counter::Counter(const char* statName, const char* subStat): id{registry().id(statName, subStat)} {}
+
+Stats::slot_t* Stats::Counter::slot() const { return threadShard().slot(id); }
+
+Stats::~Stats()
+{
+    const bool any = [] {
+        auto& reg = registry();
+        auto lock = std::lock_guard{reg.mutex};
+        return !reg.ids.empty();
+    }();
+    if (any) {
+        std::cout.flush();
+        std::cerr.flush();
+        print(std::cerr);
     }
+}
 
-    // Deallocate.
-    delete[] all;
-    table.resetDelete();
+void Stats::count(const char* statName, const char* subStat) { Counter{statName, subStat}.increment(); }
+
+int64_t Stats::get(const char* statName, const char* subStat) const
+{
+    auto& reg = registry();
+    auto lock = std::lock_guard{reg.mutex};
+    const auto it = reg.ids.find({statName, subStat ? subStat : ""});
+    return it == reg.ids.end() ? 0 : reg.sum(it->second);
 }
 
-void Stats::count(const char* statName, const char* subStat)
+void Stats::print(std::ostream& os) const
 {
-    uint32_t hashValue = hash_computeStr(statName, 0);
-    entry_t** entry = table.getAtBucket(hashValue);
-    entry_t* bucket = *entry;
-
-    while (bucket) {
-        if (bucket->info == hashValue && strcmp(bucket->stat.name, statName) == 0) {
-            if (!subStat)  // Main stat.
-            {
-                bucket->stat.counter++;
-            } else  // Sub-stat.
-            {
-                stat_t* sub;
-                for (sub = bucket->stat.next; sub != NULL; sub = sub->next) {
-                    if (strcmp(sub->name, subStat) == 0) {
-                        sub->counter++;
-                        return;
-                    }
-                }
-                // New sub stat!
-                bucket->stat.next = new stat_t(subStat, bucket->stat.next);
-            }
-            return;
+    auto& reg = registry();
+    auto lock = std::lock_guard{reg.mutex};
+    os << "\n******* Stats *******\n";
+    // sorted by name, the main counter first
+    const std::string* name = nullptr;
+    int64_t main = 0;
+    for (const auto& [names, id] : reg.ids) {
+        const int64_t counter = reg.sum(id);
+        if (!name || *name != names.first) {
+            if (name)
+                os << '\n';
+            name = &names.first;
+            main = names.second.empty() ? counter : 0;
+            os << BLUE(THIN) << names.first << NORMAL ": " BLUE(BOLD) << main << NORMAL;
+            if (names.second.empty())
+                continue;
+        }
+        os << "; " BLUE(THIN) << names.second << NORMAL ": " BLUE(BOLD) << counter << NORMAL;
+        if (main) {
+            const long pc = (100 * counter) / main;
+            os << " (" << (pc > 75 ? GREEN(BOLD) : (pc < 25 ? RED(BOLD) : CYAN(BOLD))) << pc << "%" NORMAL ")";
         }
-        bucket = bucket->getNext();
-    }
-    // New stat!
-    bucket = new entry_t(statName);
-    bucket->link(entry);
-    bucket->info = hashValue;
-    table.incBuckets();
-    if (subStat) {
-        bucket->stat.next = new stat_t(statName, NULL);
-        std::cerr << "Missing stat '" RED(BOLD) << statName << NORMAL "' added.\n";
     }
+    if (name)
+        os << '\n';
+    os.flush();
 }
 }  // namespace base
-
-#endif
@@ -23,10 +23,18 @@
 #include "debug/macros.h"
 #include "debug/malloc.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <execinfo.h>
 #include <assert.h>
 #include <iostream>
+#include <mutex>
 #include <stdlib.h>
 #include <string.h>
+#include <thread>
+#include <vector>
 
 // no mess please
 #ifdef new
@@ -42,8 +50,6 @@
 #undef free
 #endif
 
-// TODO: multithread support, if it's possible
-
 // Private hash table to store allocated memory.
 // 2 formats are available depending on the level
 // of verbosity, ie, debug information available.
@@ -54,6 +60,8 @@
 // position information on where the memory was allocated.
 
 #define INIT_SIZE     (1 << 10)
+#define SHARD_BITS    5
+#define NB_SHARDS     (1 << SHARD_BITS)
 #define EXTENSION_BIT 0x80000000
 #define NOSIZE        0x7fffffff
 #define BUCKETSIZE(B) ((B)->size & ~EXTENSION_BIT)
@@ -146,6 +154,11 @@ private:
 /** The hash table that stores all allocated
  * memory with new (and removes entries deleted
  * with delete).
+ * It is split in NB_SHARDS shards, each with its
+ * own lock, selected by the pointer, so threads
+ * seldom wait for each other. The statistics are
+ * atomic and the position of prepareDelete is
+ * per thread.
  */
 class NewPointerTable
 {
@@ -189,6 +202,10 @@ public:
      */
     void prepareDelete(const char* filename, int line, const char* function);
 
+    /** @return current total allocation (bytes).
+     */
+    size_t total() const { return totalAlloc.load(std::memory_order_relaxed); }
+
 private:
     /** Print allocation statistics (not the leaks).
      * @param isLeak: format the printout as
@@ -203,26 +220,13 @@ private:
      */
     static uintptr_t hashPtr(const void* ptr) { return ((uintptr_t)ptr) >> 2; }
 
-    /** Increment number of buckets, may rehash.
+    /** Account a new allocation in the statistics.
      */
-    void inc()
-    {
-        if (++nbBuckets > (mask >> 1))
-            rehash();
-    }
+    void allocated(size_t size);
 
-    /** Decrement number of buckets.
-     * @pre there is at least a bucket in the table.
+    /** Account the memory used by the table.
      */
-    void dec()
-    {
-        assert(nbBuckets > 0);
-        nbBuckets--;
-    }
-
-    /** Rehash the hash table.
-     */
-    void rehash();
+    void addOverhead(int bytes);
 
     /** Basic allocation information (bucket in
      * the hash table): pointer and size
@@ -246,18 +250,166 @@ private:
         PositionInfo_t pos; /**< where memory was allocated */
     };
 
-    PositionInfo_t pos;  /**< temporary position used by prepareDelete */
-    int peakAlloc;       /**< peak allocation == largest cumulated allocation */
-    uint minAlloc;       /**< smallest allocation == smallest unit */
-    uint maxAlloc;       /**< largest allocation == largest unit */
-    int totalAlloc;      /**< current total allocation */
-    int overhead;        /**< current overhead used by NewPointerTable */
-    int maxOverhead;     /**< maximal overhead ever used by NewPointerTable */
-    uint nbBuckets;      /**< current number of buckets */
-    uint mask;           /**< mask to access the hash table = size-1 where size=2^n */
-    MemBucket_t** table; /**< hash table of size mask+1 */
+    /** A part of the hash table with its own lock.
+     */
+    struct Shard_t
+    {
+        std::mutex mutex;    /**< guards the rest */
+        uint nbBuckets;      /**< current number of buckets */
+        uint mask;           /**< mask to access the hash table = size-1 where size=2^n */
+        MemBucket_t** table; /**< hash table of size mask+1 */
+    };
+
+    /** @return the shard of a pointer: by other bits
+     * than the hash within the shard.
+     */
+    Shard_t& shardOf(const void* ptr)
+    {
+        return shards[((uint64_t)(uintptr_t)ptr * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - SHARD_BITS)];
+    }
+
+    /** Increment number of buckets, may rehash.
+     */
+    void inc(Shard_t& shard)
+    {
+        if (++shard.nbBuckets > (shard.mask >> 1))
+            rehash(shard);
+    }
+
+    /** Decrement number of buckets.
+     * @pre there is at least a bucket in the shard.
+     */
+    void dec(Shard_t& shard)
+    {
+        assert(shard.nbBuckets > 0);
+        shard.nbBuckets--;
+    }
+
+    /** Rehash a shard of the hash table.
+     */
+    void rehash(Shard_t& shard);
+
+    static thread_local PositionInfo_t pos; /**< temporary position used by prepareDelete */
+    std::atomic<bool> active;               /**< constructed and not destroyed yet */
+    std::atomic<int> peakAlloc;             /**< peak allocation == largest cumulated allocation */
+    std::atomic<uint> minAlloc;             /**< smallest allocation == smallest unit */
+    std::atomic<uint> maxAlloc;             /**< largest allocation == largest unit */
+    std::atomic<int> totalAlloc;            /**< current total allocation */
+    std::atomic<int> overhead;              /**< current overhead used by NewPointerTable */
+    std::atomic<int> maxOverhead;           /**< maximal overhead ever used by NewPointerTable */
+    Shard_t shards[NB_SHARDS];              /**< the hash table */
 };
 
+/** Sampling heap profiler, used instead of NewPointerTable when the
+ * environment sets DEBUG_NEW_SAMPLE to the mean number of bytes between
+ * samples. The distances between the sampled bytes are exponentially
+ * distributed, so an allocation of some size is sampled with probability
+ * 1-exp(-size/rate) at the cost of a thread-local subtraction otherwise.
+ * A sampled allocation keeps its size and stack trace in a lock-free
+ * hash table until it is deleted.
+ * The live samples make a heap profile with the allocation sites,
+ * written at exit to the file named by DEBUG_NEW_PROFILE in the heap
+ * format of gperftools (pprof), or else summarized on stderr.
+ */
+class HeapSampler
+{
+public:
+    explicit HeapSampler(size_t rate);
+
+    /** Account an allocation, sampled at random.
+     * @param caller: return address of the allocation function,
+     * where the stack trace starts.
+     */
+    void allocated(const void* ptr, size_t size, const void* caller)
+    {
+        ThreadState& state = local;
+        state.left -= (int64_t)size;
+        if (state.left < 0) {
+            sample(state, ptr, size, caller);
+        }
+    }
+
+    /** Forget a deleted allocation if it was sampled.
+     */
+    void freed(const void* ptr)
+    {
+        if (ptr && nbLive.load(std::memory_order_relaxed) > 0) {
+            remove(ptr);
+        }
+    }
+
+    /** Write the live samples as a heap profile (heap_v2 format).
+     * @param out: where to write.
+     */
+    void writeProfile(FILE* out) const;
+
+    /** Print the allocation sites with the most live bytes.
+     * @param os: where to print.
+     * @param nbSites: how many sites.
+     */
+    void printTop(std::ostream& os, size_t nbSites) const;
+
+private:
+    enum : uintptr_t {
+        EMPTY = 0,   /**< key of a free slot */
+        CLAIMED = 1, /**< key of a slot being filled in */
+        BUSY = 1     /**< bit of a key whose sample is being copied */
+    };
+    enum { SLOTS = 8, BUCKET_BITS = 12, NB_BUCKETS = 1 << BUCKET_BITS, MAX_DEPTH = 24 };
+
+    /** A sampled allocation */
+    struct Sample_t
+    {
+        size_t size;             /**< allocated size */
+        int depth;               /**< number of frames */
+        void* frames[MAX_DEPTH]; /**< return addresses from the allocation site up */
+    };
+
+    /** Slots of the hash table with the same hash: the keys are the
+     * allocated pointers, all in one cache line for the lookups.
+     */
+    struct Bucket_t
+    {
+        alignas(64) std::atomic<uintptr_t> keys[SLOTS];
+        Sample_t samples[SLOTS];
+    };
+
+    /** Per-thread sampling state, zero initialized */
+    struct ThreadState
+    {
+        int64_t left;    /**< bytes until the next sample */
+        uint64_t random; /**< xorshift state, 0 before the first sample */
+        bool inside;     /**< the sampler itself allocates */
+    };
+
+    int64_t nextInterval(ThreadState& state) const;
+    void sample(ThreadState& state, const void* ptr, size_t size, const void* caller);
+    void remove(const void* ptr);
+
+    /** Copy the live samples, sorted by stack trace */
+    std::vector<Sample_t> snapshot() const;
+
+    /** @return the expected number of allocations represented by a sample */
+    double weight(size_t size) const { return 1.0 / -std::expm1(-(double)size / rate); }
+
+    static Bucket_t& bucketOf(Bucket_t* buckets, const void* ptr)
+    {
+        return buckets[((uint64_t)(uintptr_t)ptr * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - BUCKET_BITS)];
+    }
+
+    static thread_local ThreadState local;
+
+    const size_t rate;             /**< mean bytes between samples */
+    Bucket_t* buckets;             /**< hash table of NB_BUCKETS */
+    std::atomic<size_t> nbLive;    /**< number of live samples */
+    std::atomic<size_t> nbDropped; /**< samples without a free slot */
+    mutable std::mutex readers;    /**< one snapshot at a time */
+};
+
+/** @return the heap sampler if DEBUG_NEW_SAMPLE is set, nullptr otherwise
+ */
+static HeapSampler* heapSampler();
+
 /* Constructor: reset the hash table
  */
 StatsTable::StatsTable() { std::fill(table, table + STATS_SIZE, nullptr); }
@@ -334,23 +486,30 @@ void StatsTable::printStats(std::ostream& os) const
     } while (--n);
 }
 
+thread_local PositionInfo_t NewPointerTable::pos;
+
 /* Constructor for table of allocated memory
  * by new: reset the hash table and the statistics.
+ * The members are zero (inactive) before, when
+ * new is called by earlier static constructors.
  */
 NewPointerTable::NewPointerTable():
-    peakAlloc(0), minAlloc(0xffffffff), maxAlloc(0), totalAlloc(0), nbBuckets(0), mask(INIT_SIZE - 1)
+    peakAlloc(0), minAlloc(0xffffffff), maxAlloc(0), totalAlloc(0)
 {
-    table = (MemBucket_t**)malloc(INIT_SIZE * sizeof(MemBucket_t*));
-    if (!table) {
-        std::cerr << "Fatal: could not allocate table for monitor!\n";
-        throw std::bad_alloc();
+    const uint initSize = INIT_SIZE / NB_SHARDS;
+    for (Shard_t& shard : shards) {
+        shard.table = (MemBucket_t**)malloc(initSize * sizeof(MemBucket_t*));
+        if (!shard.table) {
+            std::cerr << "Fatal: could not allocate table for monitor!\n";
+            throw std::bad_alloc();
+        }
+        std::fill(shard.table, shard.table + initSize, nullptr);
+        shard.nbBuckets = 0;
+        shard.mask = initSize - 1;
     }
-    std::fill(table, table + INIT_SIZE, nullptr);
     overhead = INIT_SIZE * sizeof(MemBucket_t*) + sizeof(NewPointerTable);
-    maxOverhead = overhead;
-    pos.filename = nullptr;
-    pos.line = 0;
-    pos.function = nullptr;
+    maxOverhead = overhead.load();
+    active.store(true, std::memory_order_release);
 }
 
 /** Print memory usage:
@@ -370,7 +529,7 @@ static void new_print(const char* caption, uint mem)
  */
 void NewPointerTable::printStats(bool leak) const
 {
-    uint min = (minAlloc == 0xffffffff) ? 0 : minAlloc;
+    uint min = (minAlloc == 0xffffffff) ? 0 : minAlloc.load();
 
     std::cerr << CYAN(THIN) "Allocated memory stats:";
     new_print("\n\tPeak     = ", peakAlloc);
@@ -394,33 +553,45 @@ void NewPointerTable::printStats(bool leak) const
  * 4) deallocate (if any) the memory allocation
  *    records
  * 5) deallocate hash table
+ * Later calls are ignored.
  */
 NewPointerTable::~NewPointerTable()
 {
-    if (table) {
+    if (!active.exchange(false)) {
+        return;
+    }
+    // wait for the other threads to leave
+    for (Shard_t& shard : shards) {
+        shard.mutex.lock();
+    }
+    if (!heapSampler()) {  // otherwise not used: the sampler reports instead
         StatsTable stats;
         printStats(true);
 
-        MemBucket_t** entry = table;
-        uint n = mask + 1;
-        do {
-            MemBucket_t* bucket = *entry++;
-            while (bucket) {
-                if (bucket->size & EXTENSION_BIT) {
-                    ExtMemBucket_t* ebucket = static_cast<ExtMemBucket_t*>(bucket);
-                    stats.addLeak(BUCKETSIZE(ebucket), &ebucket->pos);
-                } else {
-                    stats.addLeak(bucket->size, nullptr);
+        for (Shard_t& shard : shards) {
+            MemBucket_t** entry = shard.table;
+            uint n = shard.mask + 1;
+            do {
+                MemBucket_t* bucket = *entry++;
+                while (bucket) {
+                    if (bucket->size & EXTENSION_BIT) {
+                        ExtMemBucket_t* ebucket = static_cast<ExtMemBucket_t*>(bucket);
+                        stats.addLeak(BUCKETSIZE(ebucket), &ebucket->pos);
+                    } else {
+                        stats.addLeak(bucket->size, nullptr);
+                    }
+                    bucket = bucket->getNext();
                 }
-                bucket = bucket->getNext();
-            }
-        } while (--n);
+            } while (--n);
+        }
 
         // need the PositionInfo_t to print the stats
         stats.printStats(std::cerr);
+    }
 
-        entry = table;
-        n = mask + 1;
+    for (Shard_t& shard : shards) {
+        MemBucket_t** entry = shard.table;
+        uint n = shard.mask + 1;
         do {
             MemBucket_t* bucket = *entry++;
             while (bucket) {
@@ -430,20 +601,51 @@ NewPointerTable::~NewPointerTable()
             }
         } while (--n);
 
-        free(table);
-        table = nullptr;
-        overhead = sizeof(NewPointerTable);
+        free(shard.table);
+        shard.table = nullptr;
+        shard.mutex.unlock();
     }
+    overhead = sizeof(NewPointerTable);
+}
+
+/* Largest/smallest so far, the values of the
+ * other threads may come in between.
+ */
+template <typename T>
+static void new_raise(std::atomic<T>& max, T value)
+{
+    T current = max.load(std::memory_order_relaxed);
+    while (current < value && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+template <typename T>
+static void new_lower(std::atomic<T>& min, T value)
+{
+    T current = min.load(std::memory_order_relaxed);
+    while (current > value && !min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+void NewPointerTable::allocated(size_t size)
+{
+    new_raise(peakAlloc, totalAlloc.fetch_add((int)size, std::memory_order_relaxed) + (int)size);
+    new_lower(minAlloc, (uint)size);
+    new_raise(maxAlloc, (uint)size);
+}
+
+void NewPointerTable::addOverhead(int bytes)
+{
+    new_raise(maxOverhead, overhead.fetch_add(bytes, std::memory_order_relaxed) + bytes);
 }
 
 /* Standard rehash based on power of 2.
- * rehash() doubles the hash table size.
+ * rehash() doubles the size of the shard.
+ * @pre the shard is locked.
  */
-void NewPointerTable::rehash()
+void NewPointerTable::rehash(Shard_t& shard)
 {
-    uint oldSize = mask + 1;
+    uint oldSize = shard.mask + 1;
     uint newSize = oldSize << 1;  // double size
-    MemBucket_t** oldBuckets = table;
+    MemBucket_t** oldBuckets = shard.table;
     MemBucket_t** newBuckets = (MemBucket_t**)malloc(newSize * sizeof(MemBucket_t*));
 
     if (!newBuckets) {
@@ -451,9 +653,9 @@ void NewPointerTable::rehash()
         return;
     }
 
-    overhead += newSize * sizeof(MemBucket_t*);
-    mask = newSize - 1;
-    table = newBuckets;
+    addOverhead(newSize * sizeof(MemBucket_t*));
+    shard.mask = newSize - 1;
+    shard.table = newBuckets;
     std::fill(newBuckets + oldSize, newBuckets + (2 * oldSize), nullptr);
 
     uint i = 0;
@@ -470,17 +672,19 @@ void NewPointerTable::rehash()
 
     free(oldBuckets);
     overhead -= oldSize * sizeof(MemBucket_t*);
-    if (overhead > maxOverhead) {
-        maxOverhead = overhead;
-    }
 }
 
 /* Add a new bucket to the hash table.
  */
 void NewPointerTable::remember(void* ptr, size_t size)
 {
-    if (table) {
-        MemBucket_t** entry = &table[hashPtr(ptr) & mask];
+    if (active.load(std::memory_order_acquire)) {
+        Shard_t& shard = shardOf(ptr);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.table) {
+            return;  // destroyed meanwhile
+        }
+        MemBucket_t** entry = &shard.table[hashPtr(ptr) & shard.mask];
         MemBucket_t* bucket = *entry;
         bool warning = false;
 
@@ -512,10 +716,7 @@ void NewPointerTable::remember(void* ptr, size_t size)
             std::cerr << "Fatal: could not allocate bucket for monitor!\n";
             throw std::bad_alloc();
         }
-        overhead += sizeof(MemBucket_t);
-        if (overhead > maxOverhead) {
-            maxOverhead = overhead;
-        }
+        addOverhead(sizeof(MemBucket_t));
         bucket->link(entry);
         bucket->ptr = ptr;
         bucket->size = size;
@@ -523,18 +724,9 @@ void NewPointerTable::remember(void* ptr, size_t size)
         /* Allocation stats.
          */
         if (size != NOSIZE) {
-            totalAlloc += size;
-            if (peakAlloc < totalAlloc) {
-                peakAlloc = totalAlloc;
-            }
-            if (minAlloc > size) {
-                minAlloc = size;
-            }
-            if (maxAlloc < size) {
-                maxAlloc = size;
-            }
+            allocated(size);
         }
-        inc();  // one more bucket
+        inc(shard);  // one more bucket
     }
 }
 
@@ -543,8 +735,13 @@ void NewPointerTable::remember(void* ptr, size_t size)
  */
 void NewPointerTable::remember(void* ptr, size_t size, const char* filename, int line, const char* function)
 {
-    if (table) {
-        MemBucket_t** entry = &table[hashPtr(ptr) & mask];
+    if (active.load(std::memory_order_acquire)) {
+        Shard_t& shard = shardOf(ptr);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.table) {
+            return;  // destroyed meanwhile
+        }
+        MemBucket_t** entry = &shard.table[hashPtr(ptr) & shard.mask];
         MemBucket_t* bucket = *entry;
         bool warning1 = false, warning2 = false;
 
@@ -599,10 +796,7 @@ void NewPointerTable::remember(void* ptr, size_t size, const char* filename, int
             std::cerr << "Fatal: could not allocate bucket for monitor!\n";
             throw std::bad_alloc();
         }
-        overhead += sizeof(ExtMemBucket_t);
-        if (overhead > maxOverhead) {
-            maxOverhead = overhead;
-        }
+        addOverhead(sizeof(ExtMemBucket_t));
         ebucket->link(entry);
         ebucket->ptr = ptr;
         ebucket->size = size | EXTENSION_BIT;
@@ -613,18 +807,9 @@ void NewPointerTable::remember(void* ptr, size_t size, const char* filename, int
         /* Allocation stats
          */
         if (size != NOSIZE) {
-            totalAlloc += size;
-            if (peakAlloc < totalAlloc) {
-                peakAlloc = totalAlloc;
-            }
-            if (minAlloc > size) {
-                minAlloc = size;
-            }
-            if (maxAlloc < size) {
-                maxAlloc = size;
-            }
+            allocated(size);
         }
-        inc();  // one more bucket
+        inc(shard);  // one more bucket
     }
 }
 
@@ -635,8 +820,13 @@ void NewPointerTable::remember(void* ptr, size_t size, const char* filename, int
  */
 void NewPointerTable::forget(void* ptr, bool nosize)
 {
-    if (table && ptr) {
-        MemBucket_t** toBucket = &table[hashPtr(ptr) & mask];
+    if (ptr && active.load(std::memory_order_acquire)) {
+        Shard_t& shard = shardOf(ptr);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.table) {
+            return;  // destroyed meanwhile
+        }
+        MemBucket_t** toBucket = &shard.table[hashPtr(ptr) & shard.mask];
         MemBucket_t* bucket = *toBucket;
 
         while (bucket) {
@@ -650,7 +840,7 @@ void NewPointerTable::forget(void* ptr, bool nosize)
                 bucket->unlink(toBucket);
                 overhead -= (bucket->size & EXTENSION_BIT) ? sizeof(ExtMemBucket_t) : sizeof(MemBucket_t);
                 free(bucket);
-                dec();  // one fewer bucket
+                dec(shard);  // one fewer bucket
                 return;
             }
             toBucket = bucket->getAtNext();
@@ -690,6 +880,248 @@ void NewPointerTable::prepareDelete(const char* filename, int line, const char*
     pos.function = function;
 }
 
+
+thread_local HeapSampler::ThreadState HeapSampler::local;
+
+/* Allocate the hash table with malloc: new is being monitored.
+ */
+HeapSampler::HeapSampler(size_t rate): rate(rate), nbLive(0), nbDropped(0)
+{
+    buckets = (Bucket_t*)aligned_alloc(alignof(Bucket_t), NB_BUCKETS * sizeof(Bucket_t));
+    if (!buckets) {
+        std::cerr << "Fatal: could not allocate table for heap sampler!\n";
+        throw std::bad_alloc();
+    }
+    for (size_t i = 0; i < NB_BUCKETS; ++i) {
+        for (auto& key : buckets[i].keys) {
+            new (&key) std::atomic<uintptr_t>(EMPTY);
+        }
+    }
+    // the first backtrace loads its library, not when sampling
+    void* frame;
+    backtrace(&frame, 1);
+}
+
+/* Exponentially distributed with the mean rate, by xorshift64*.
+ */
+int64_t HeapSampler::nextInterval(ThreadState& state) const
+{
+    state.random ^= state.random >> 12;
+    state.random ^= state.random << 25;
+    state.random ^= state.random >> 27;
+    const double uniform = ((state.random * UINT64_C(0x2545F4914F6CDD1D)) >> 11) * 0x1.0p-53;  // [0,1)
+    return std::max<int64_t>(1, (int64_t)(-std::log1p(-uniform) * rate));
+}
+
+/* Draw the distance to the next sample and sample this allocation,
+ * unless the sampler itself allocates. The first allocation of a
+ * thread only starts its sampling (left was 0).
+ * Insert the sample in a free slot of its bucket: claim the slot,
+ * fill it in, then publish the pointer as its key.
+ */
+void HeapSampler::sample(ThreadState& state, const void* ptr, size_t size, const void* caller)
+{
+    if (state.random == 0) {
+        state.random = ((uintptr_t)&state ^ (uintptr_t)ptr) * UINT64_C(0x9E3779B97F4A7C15) | 1;
+        state.left = nextInterval(state) - (int64_t)size;
+        if (state.left >= 0) {
+            return;
+        }
+    }
+    state.left = nextInterval(state);
+    if (state.inside) {
+        return;
+    }
+    state.inside = true;
+    Bucket_t& bucket = bucketOf(buckets, ptr);
+    for (size_t i = 0; i < SLOTS; ++i) {
+        uintptr_t expected = EMPTY;
+        if (bucket.keys[i].compare_exchange_strong(expected, CLAIMED, std::memory_order_acquire)) {
+            Sample_t& s = bucket.samples[i];
+            s.size = size;
+            s.depth = backtrace(s.frames, MAX_DEPTH);
+            // start from the caller of new
+            int skip = 0;
+            while (skip < s.depth && s.frames[skip] != caller) {
+                ++skip;
+            }
+            if (skip < s.depth) {
+                s.depth -= skip;
+                std::copy(s.frames + skip, s.frames + skip + s.depth, s.frames);
+            }
+            bucket.keys[i].store((uintptr_t)ptr, std::memory_order_release);
+            nbLive.fetch_add(1, std::memory_order_relaxed);
+            state.inside = false;
+            return;
+        }
+    }
+    nbDropped.fetch_add(1, std::memory_order_relaxed);
+    state.inside = false;
+}
+
+/* Look for the key in its bucket and free the slot, after
+ * a reader is done copying the sample.
+ */
+void HeapSampler::remove(const void* ptr)
+{
+    const uintptr_t key = (uintptr_t)ptr;
+    Bucket_t& bucket = bucketOf(buckets, ptr);
+    for (auto& k : bucket.keys) {
+        if ((k.load(std::memory_order_relaxed) & ~BUSY) == key) {
+            uintptr_t expected = key;
+            while (!k.compare_exchange_weak(expected, EMPTY, std::memory_order_acq_rel)) {
+                expected = key;
+                std::this_thread::yield();
+            }
+            nbLive.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+/* Mark each live slot busy while copying its sample,
+ * so that it is not freed and reused meanwhile.
+ */
+std::vector<HeapSampler::Sample_t> HeapSampler::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(readers);
+    ThreadState& state = local;
+    const bool inside = state.inside;
+    state.inside = true;  // do not sample the copies
+    std::vector<Sample_t> result;
+    result.reserve(nbLive.load(std::memory_order_relaxed) + SLOTS);
+    for (size_t b = 0; b < NB_BUCKETS; ++b) {
+        for (size_t i = 0; i < SLOTS; ++i) {
+            auto& k = buckets[b].keys[i];
+            uintptr_t key = k.load(std::memory_order_relaxed);
+            if (key != CLAIMED && key != EMPTY &&
+                k.compare_exchange_strong(key, key | BUSY, std::memory_order_acquire)) {
+                result.push_back(buckets[b].samples[i]);
+                k.store(key, std::memory_order_release);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Sample_t& a, const Sample_t& b) {
+        return std::lexicographical_compare(a.frames, a.frames + a.depth, b.frames, b.frames + b.depth);
+    });
+    state.inside = inside;
+    return result;
+}
+
+/* Same stack traces are consecutive in the snapshot:
+ * one line per stack trace with the sampled counts
+ * and bytes, pprof scales them by the rate.
+ */
+void HeapSampler::writeProfile(FILE* out) const
+{
+    const std::vector<Sample_t> samples = snapshot();
+    auto sameSite = [](const Sample_t& a, const Sample_t& b) {
+        return std::equal(a.frames, a.frames + a.depth, b.frames, b.frames + b.depth);
+    };
+    size_t total = 0;
+    for (const Sample_t& s : samples) {
+        total += s.size;
+    }
+    fprintf(out, "heap profile: %6zu: %8zu [%6zu: %8zu] @ heap_v2/%zu\n", samples.size(), total, (size_t)0,
+            (size_t)0, rate);
+    for (size_t i = 0, j; i < samples.size(); i = j) {
+        size_t bytes = 0;
+        for (j = i; j < samples.size() && sameSite(samples[i], samples[j]); ++j) {
+            bytes += samples[j].size;
+        }
+        fprintf(out, "%6zu: %8zu [%6zu: %8zu] @", j - i, bytes, (size_t)0, (size_t)0);
+        for (int f = 0; f < samples[i].depth; ++f) {
+            fprintf(out, " 0x%" PRIxPTR, (uintptr_t)samples[i].frames[f]);
+        }
+        fputc('\n', out);
+    }
+    // pprof maps the addresses to the binaries with these
+    fputs("\nMAPPED_LIBRARIES:\n", out);
+    if (FILE* maps = fopen("/proc/self/maps", "r")) {
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), maps)) > 0) {
+            fwrite(buffer, 1, n, out);
+        }
+        fclose(maps);
+    }
+    fflush(out);
+}
+
+/* Estimate the live bytes of every site from its samples
+ * and print the largest with symbolic stack traces.
+ */
+void HeapSampler::printTop(std::ostream& os, size_t nbSites) const
+{
+    struct site_t
+    {
+        const Sample_t* sample; /**< the first of the site */
+        double bytes, count;    /**< estimated live */
+    };
+    const std::vector<Sample_t> samples = snapshot();
+    std::vector<site_t> sites;
+    double total = 0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const Sample_t& s = samples[i];
+        if (i == 0 || !std::equal(s.frames, s.frames + s.depth, samples[i - 1].frames,
+                                  samples[i - 1].frames + samples[i - 1].depth)) {
+            sites.push_back({&s, 0, 0});
+        }
+        const double w = weight(s.size);
+        sites.back().bytes += w * s.size;
+        sites.back().count += w;
+        total += w * s.size;
+    }
+    std::sort(sites.begin(), sites.end(), [](const site_t& a, const site_t& b) { return a.bytes > b.bytes; });
+
+    os << CYAN(THIN) "Sampled heap (1 in " << rate << " bytes): ~" << (size_t)total << " bytes live from "
+              << sites.size() << " sites, " << nbDropped.load(std::memory_order_relaxed) << " samples dropped" NORMAL
+              "\n";
+    for (size_t i = 0; i < sites.size() && i < nbSites; ++i) {
+        const Sample_t& s = *sites[i].sample;
+        os << RED(BOLD) "\t~" << (size_t)sites[i].bytes << " bytes in ~" << std::llround(sites[i].count)
+           << " allocations from:" NORMAL "\n";
+        char** symbols = backtrace_symbols(s.frames, std::min(s.depth, 6));
+        for (int f = 0; symbols && f < std::min(s.depth, 6); ++f) {
+            os << "\t\t" << symbols[f] << '\n';
+        }
+        free(symbols);
+    }
+}
+
+/* The sampler is created on the first use, from the environment,
+ * and reports at exit.
+ */
+static HeapSampler* heapSampler()
+{
+    static HeapSampler* sampler = []() -> HeapSampler* {
+        const char* rate = getenv("DEBUG_NEW_SAMPLE");
+        const long long n = rate ? atoll(rate) : 0;
+        if (n <= 0) {
+            return nullptr;
+        }
+        void* memory = malloc(sizeof(HeapSampler));  // never freed: used until the very end
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        HeapSampler* result = ::new (memory) HeapSampler((size_t)n);
+        atexit([] {
+            const char* path = getenv("DEBUG_NEW_PROFILE");
+            if (path && *path) {
+                if (FILE* out = fopen(path, "w")) {
+                    heapSampler()->writeProfile(out);
+                    fclose(out);
+                } else {
+                    fprintf(stderr, RED(BOLD) "Could not write the heap profile to %s" NORMAL "\n", path);
+                }
+            } else {
+                heapSampler()->printTop(std::cerr, 10);
+            }
+        });
+        return result;
+    }();
+    return sampler;
+}
 }  // namespace debug
 
 // Monitor instance
@@ -715,13 +1147,44 @@ static debug::NewPointerTable new_table;
 //
 //////////////////////////////////////////////////////////////////////////
 
+/* Monitor an allocation with the heap sampler if enabled, otherwise
+ * with the table. The caller is the return address of new or malloc.
+ */
+static inline void new_remember(void* ptr, size_t size, const void* caller)
+{
+    if (debug::HeapSampler* sampler = debug::heapSampler()) {
+        sampler->allocated(ptr, size, caller);
+    } else {
+        new_table.remember(ptr, size);
+    }
+}
+
+static inline void new_remember(void* ptr, size_t size, const void* caller, const char* filename, int line,
+                                const char* function)
+{
+    if (debug::HeapSampler* sampler = debug::heapSampler()) {
+        sampler->allocated(ptr, size, caller);
+    } else {
+        new_table.remember(ptr, size, filename, line, function);
+    }
+}
+
+static inline void new_forget(void* ptr)
+{
+    if (debug::HeapSampler* sampler = debug::heapSampler()) {
+        sampler->freed(ptr);
+    } else {
+        new_table.forget(ptr, false);
+    }
+}
+
 void* operator new(size_t size)
 {
     void* ptr = malloc(size);
     if (!ptr) {
         throw std::bad_alloc();
     }
-    new_table.remember(ptr, size);
+    new_remember(ptr, size, __builtin_return_address(0));
     return ptr;
 }
 
@@ -731,29 +1194,34 @@ void* operator new[](size_t size)
     if (!ptr) {
         throw std::bad_alloc();
     }
-    new_table.remember(ptr, size);
+    new_remember(ptr, size, __builtin_return_address(0));
     return ptr;
 }
 
 void operator delete(void* ptr) noexcept
 {
-    new_table.forget(ptr, false);
+    new_forget(ptr);
     if (ptr)
         free(ptr);
 }
 
 void operator delete[](void* ptr) noexcept
 {
-    new_table.forget(ptr, false);
+    new_forget(ptr);
     if (ptr)
         free(ptr);
 }
 
+// the sized deletes of C++14 would otherwise free with the default, not knowing the malloc above
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+
+void operator delete[](void* ptr, size_t) noexcept { operator delete[](ptr); }
+
 void* operator new(size_t size, const std::nothrow_t&) noexcept
 {
     void* ptr = malloc(size);
     if (ptr) {
-        new_table.remember(ptr, size);
+        new_remember(ptr, size, __builtin_return_address(0));
     } else {
         std::cerr << "NULL pointer crash soon!\n";
     }
@@ -764,7 +1232,7 @@ void* operator new[](size_t size, const std::nothrow_t&) noexcept
 {
     void* ptr = malloc(size);
     if (ptr) {
-        new_table.remember(ptr, size);
+        new_remember(ptr, size, __builtin_return_address(0));
     } else {
         std::cerr << "NULL pointer crash soon!\n";
     }
@@ -773,14 +1241,14 @@ void* operator new[](size_t size, const std::nothrow_t&) noexcept
 
 void operator delete(void* ptr, const std::nothrow_t&) noexcept
 {
-    new_table.forget(ptr, false);
+    new_forget(ptr);
     if (ptr)
         free(ptr);
 }
 
 void operator delete[](void* ptr, const std::nothrow_t&) noexcept
 {
-    new_table.forget(ptr, false);
+    new_forget(ptr);
     if (ptr)
         free(ptr);
 }
@@ -790,7 +1258,7 @@ void* operator new(size_t size, const char* filename, int line, const char* func
 {
     void* ptr = malloc(size);
     if (ptr) {
-        new_table.remember(ptr, size, filename, line, function);
+        new_remember(ptr, size, __builtin_return_address(0), filename, line, function);
     } else {
         std::cerr << "NULL pointer crash soon!\n";
     }
@@ -802,7 +1270,7 @@ void* operator new[](size_t size, const char* filename, int line, const char* fu
 {
     void* ptr = malloc(size);
     if (ptr) {
-        new_table.remember(ptr, size, filename, line, function);
+        new_remember(ptr, size, __builtin_return_address(0), filename, line, function);
     } else {
         std::cerr << "NULL pointer crash soon!\n";
     }
@@ -814,7 +1282,8 @@ void debug_prepareDelete(const char* filename, int line, const char* function)
     new_table.prepareDelete(filename, line, function);
 }
 
-static debug::PositionInfo_t localPosition = {filename : nullptr, line : 0, function : nullptr};
+// per thread, as the positions of prepareDelete
+static thread_local debug::PositionInfo_t localPosition = {nullptr, 0, nullptr};
 
 void debug_pushPosition(const char* filename, int line, const char* function)
 {
@@ -829,7 +1298,7 @@ void* debug_monitoredMalloc(size_t size, const char* filename, int line, const c
 {
     void* ptr = malloc(size);
     if (ptr) {
-        new_table.remember(ptr, size, filename, line, function);
+        new_remember(ptr, size, __builtin_return_address(0), filename, line, function);
     } else {
         std::cerr << "Warning: malloc returns NULL...\n";
     }
@@ -840,7 +1309,7 @@ void* debug_monitoredMalloc(size_t size, const char* filename, int line, const c
 void debug_monitoredFree(void* ptr, const char* filename, int line, const char* function)
 {
     new_table.prepareDelete(filename, line, function);
-    new_table.forget(ptr, false);
+    new_forget(ptr);
     if (ptr) {
         free(ptr);
     } else {
@@ -852,21 +1321,38 @@ void debug_monitoredFree(void* ptr, const char* filename, int line, const char*
 void* debug_rememberPointer(void* ptr, const char* filename, int line, const char* function)
 {
     // fprintf(stderr, "Remember 0x%x\n", (uintptr_t) ptr);
-    new_table.remember(ptr, NOSIZE, filename, line, function);
+    if (!debug::heapSampler()) {  // only allocations are sampled
+        new_table.remember(ptr, NOSIZE, filename, line, function);
+    }
     return ptr;
 }
 
 void debug_forgetPointer(void* ptr, const char* filename, int line, const char* function)
 {
     // fprintf(stderr, "Forget 0x%x\n", (uintptr_t) ptr);
-    new_table.prepareDelete(filename, line, function);
-    new_table.forget(ptr, true);
+    if (!debug::heapSampler()) {
+        new_table.prepareDelete(filename, line, function);
+        new_table.forget(ptr, true);
+    }
 }
 
 void debug_forgetPtr(void* ptr)
 {
     // fprintf(stderr, "Forget 0x%x\n", (uintptr_t) ptr);
-    new_table.forget(ptr, true);
+    if (!debug::heapSampler()) {
+        new_table.forget(ptr, true);
+    }
 }
 
+int debug_writeHeapProfile(FILE* file)
+{
+    if (debug::HeapSampler* sampler = debug::heapSampler()) {
+        sampler->writeProfile(file);
+        return 1;
+    }
+    return 0;
+}
+
+size_t debug_allocatedMemory(void) { return debug::heapSampler() ? 0 : new_table.total(); }
+
 #endif
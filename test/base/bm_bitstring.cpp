@@ -0,0 +1,93 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Benchmark bit string to index table conversions.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/bitstring.h"
+#include "base/cpu.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+/**
+ * The first argument is the size of the bit string in ints,
+ * the second is the density of set bits in percent.
+ * ./bm_bitstring --benchmark_filter=bits2indexTable
+ */
+
+static std::vector<uint32_t> random_bits(size_t n, int density)
+{
+    auto rng = std::mt19937{42};
+    auto bit = std::bernoulli_distribution{density / 100.0};
+    auto res = std::vector<uint32_t>(n);
+    for (size_t i = 0; i < n * 32; ++i)
+        if (bit(rng))
+            base_setOneBit(res.data(), i);
+    return res;
+}
+
+/** the original loop shifting through every bit */
+static size_t bits2indexTable_shift(const uint32_t* bits, size_t n, cindex_t* table)
+{
+    size_t index = 0;
+    for (; n != 0; table += 32, --n)
+        for (uint32_t b = *bits++, *t = table; b != 0; ++t, b >>= 1)
+            if (b & 1)
+                *t = index++;
+    return index;
+}
+
+static void bits2indexTable_args(benchmark::internal::Benchmark* bm)
+{
+    for (auto n : {1, 4, 32, 1024})
+        for (auto density : {5, 50, 95})
+            bm->Args({n, density});
+}
+
+static void bm_bits2indexTable_shift(benchmark::State& state)
+{
+    auto bits = random_bits(state.range(0), state.range(1));
+    auto table = std::vector<cindex_t>(bits.size() * 32);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bits2indexTable_shift(bits.data(), bits.size(), table.data()));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(bm_bits2indexTable_shift)->Apply(bits2indexTable_args);
+
+static void bm_bits2indexTable(benchmark::State& state, uint32_t features)
+{
+    auto bits = random_bits(state.range(0), state.range(1));
+    auto table = std::vector<cindex_t>(bits.size() * 32);
+    base_setCPUFeatureMask(features);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(base_bits2indexTable(bits.data(), bits.size(), table.data()));
+        benchmark::ClobberMemory();
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
+BENCHMARK_CAPTURE(bm_bits2indexTable, ctz, 0u)->Apply(bits2indexTable_args);
+BENCHMARK_CAPTURE(bm_bits2indexTable, avx512, (uint32_t)base_CPU_ALL)->Apply(bits2indexTable_args);
+
+static void bm_indexTable2bits(benchmark::State& state)
+{
+    auto bits = random_bits(state.range(0), state.range(1));
+    auto table = std::vector<cindex_t>(bits.size() * 32);
+    auto indices = std::vector<cindex_t>{};
+    for (size_t i = 0; i < bits.size() * 32; ++i)
+        if (base_getOneBit(bits.data(), i))
+            indices.push_back(i);
+    for (auto _ : state) {
+        base_indexTable2bits(indices.data(), indices.size(), bits.data(), bits.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(bm_indexTable2bits)->Apply(bits2indexTable_args);
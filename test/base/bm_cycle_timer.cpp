@@ -0,0 +1,51 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Benchmark the clock readings of CycleTimer against std::chrono.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/CycleTimer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+
+template <typename Clock>
+static void bm_chrono_now(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Clock::now());
+}
+BENCHMARK(bm_chrono_now<std::chrono::system_clock>);
+BENCHMARK(bm_chrono_now<std::chrono::steady_clock>);
+
+static void bm_now(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(base::CycleTimer::now());
+}
+BENCHMARK(bm_now);
+
+static void bm_now_precise(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(base::CycleTimer::now_precise());
+}
+BENCHMARK(bm_now_precise);
+
+/** a timed phase: start and pause */
+static void bm_auto_start_stop(benchmark::State& state)
+{
+    auto timer = base::CycleTimer{false};
+    for (auto _ : state) {
+        auto phase = base::CycleTimer::AutoStartStop{timer};
+        benchmark::DoNotOptimize(timer);
+    }
+    state.counters["ticks"] = timer.getTicks();
+}
+BENCHMARK(bm_auto_start_stop);
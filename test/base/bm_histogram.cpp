@@ -0,0 +1,59 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Benchmark recording into and querying Histogram.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/Histogram.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+static std::vector<uint64_t> latencies(size_t n)
+{
+    auto gen = std::mt19937_64{2026};
+    auto dist = std::lognormal_distribution<double>{8, 1.5};
+    auto values = std::vector<uint64_t>(n);
+    for (auto& v : values)
+        v = static_cast<uint64_t>(dist(gen));
+    return values;
+}
+
+static void bm_record(benchmark::State& state)
+{
+    static auto h = base::Histogram{};
+    const auto values = latencies(4096);
+    size_t i = 0;
+    for (auto _ : state)
+        h.record(values[i++ % values.size()]);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(bm_record)->ThreadRange(1, 4);
+
+static void bm_snapshot_percentile(benchmark::State& state)
+{
+    auto h = base::Histogram{};
+    for (auto v : latencies(100000))
+        h.record(v);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(h.snapshot().percentile(99.9));
+}
+BENCHMARK(bm_snapshot_percentile);
+
+static void bm_serialize(benchmark::State& state)
+{
+    auto h = base::Histogram{};
+    for (auto v : latencies(100000))
+        h.record(v);
+    const auto s = h.snapshot();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(base::Histogram::Snapshot::deserialize(s.serialize()));
+}
+BENCHMARK(bm_serialize);
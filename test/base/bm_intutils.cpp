@@ -0,0 +1,176 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Benchmark the kernels of intutils.h on every instruction set.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/intutils.h"
+#include "base/cpu.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+/**
+ * The argument is the size in ints. The std variants are
+ * the former implementations, for reference.
+ * ./bm_intutils --benchmark_filter=areEqual
+ */
+
+static void bm_areEqual_std(benchmark::State& state)
+{
+    auto a = std::vector<uint32_t>(state.range(0), 42);
+    auto b = a;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::equal(a.begin(), a.end(), b.begin()));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(bm_areEqual_std)->RangeMultiplier(4)->Range(16, 4096);
+
+static void bm_areEqual(benchmark::State& state, uint32_t features)
+{
+    auto a = std::vector<uint32_t>(state.range(0), 42);
+    auto b = a;
+    base_setCPUFeatureMask(features);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(base_areEqual(a.data(), b.data(), a.size()));
+        benchmark::ClobberMemory();
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
+BENCHMARK_CAPTURE(bm_areEqual, scalar, 0u)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_areEqual, sse2, (uint32_t)base_CPU_SSE2)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_areEqual, avx2, (uint32_t)(base_CPU_SSE2 | base_CPU_AVX2))->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_areEqual, avx512, (uint32_t)base_CPU_ALL)->RangeMultiplier(4)->Range(16, 4096);
+
+static void bm_diff_std(benchmark::State& state)
+{
+    auto a = std::vector<uint32_t>(state.range(0), 42);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            std::accumulate(a.begin(), a.end(), 0u, [](uint32_t sum, uint32_t value) { return sum | (value ^ 42); }));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(bm_diff_std)->RangeMultiplier(4)->Range(16, 4096);
+
+static void bm_diff(benchmark::State& state, uint32_t features)
+{
+    auto a = std::vector<uint32_t>(state.range(0), 42);
+    base_setCPUFeatureMask(features);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(base_diff(a.data(), a.size(), 42));
+        benchmark::ClobberMemory();
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
+BENCHMARK_CAPTURE(bm_diff, scalar, 0u)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_diff, sse2, (uint32_t)base_CPU_SSE2)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_diff, avx2, (uint32_t)(base_CPU_SSE2 | base_CPU_AVX2))->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_diff, avx512, (uint32_t)base_CPU_ALL)->RangeMultiplier(4)->Range(16, 4096);
+
+static void bm_fill(benchmark::State& state, uint32_t features)
+{
+    auto a = std::vector<int32_t>(state.range(0));
+    base_setCPUFeatureMask(features);
+    for (auto _ : state) {
+        base_fill(a.data(), a.data() + a.size(), 42);
+        benchmark::ClobberMemory();
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
+BENCHMARK_CAPTURE(bm_fill, scalar, 0u)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_fill, sse2, (uint32_t)base_CPU_SSE2)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_fill, avx2, (uint32_t)(base_CPU_SSE2 | base_CPU_AVX2))->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_fill, avx512, (uint32_t)base_CPU_ALL)->RangeMultiplier(4)->Range(16, 4096);
+
+static void bm_compare_std(benchmark::State& state)
+{
+    auto a = std::vector<int32_t>(state.range(0), 42);
+    auto b = a;
+    b.back() = 43;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end()));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(bm_compare_std)->RangeMultiplier(4)->Range(16, 4096);
+
+static void bm_compare(benchmark::State& state, uint32_t features)
+{
+    auto a = std::vector<int32_t>(state.range(0), 42);
+    auto b = a;
+    b.back() = 43;
+    base_setCPUFeatureMask(features);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(base_compare(a.data(), b.data(), a.size()));
+        benchmark::ClobberMemory();
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
+BENCHMARK_CAPTURE(bm_compare, scalar, 0u)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_compare, sse2, (uint32_t)base_CPU_SSE2)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_compare, avx2, (uint32_t)(base_CPU_SSE2 | base_CPU_AVX2))->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(bm_compare, avx512, (uint32_t)base_CPU_ALL)->RangeMultiplier(4)->Range(16, 4096);
+
+/** the relation as clients computed it, one loop per vector */
+static relation_t relation_loop(const int32_t* a, const int32_t* b, size_t n)
+{
+    bool le = true, ge = true;
+    for (size_t i = 0; i < n && (le || ge); ++i) {
+        le = le && a[i] <= b[i];
+        ge = ge && a[i] >= b[i];
+    }
+    return (relation_t)((le ? base_SUBSET : 0) | (ge ? base_SUPERSET : 0));
+}
+
+/** DBM-like data: a passed list of 1000 vectors of the argument
+ * size, all slightly larger than the query apart from the end */
+static std::vector<std::vector<int32_t>> passed_list(size_t n)
+{
+    auto res = std::vector<std::vector<int32_t>>(1000, std::vector<int32_t>(n, 43));
+    for (size_t k = 0; k < res.size(); k += 2)
+        res[k].back() = 41;
+    return res;
+}
+
+static void bm_relations_loop(benchmark::State& state)
+{
+    auto a = std::vector<int32_t>(state.range(0), 42);
+    auto list = passed_list(a.size());
+    auto relations = std::vector<relation_t>(list.size());
+    for (auto _ : state) {
+        for (size_t k = 0; k < list.size(); ++k)
+            relations[k] = relation_loop(a.data(), list[k].data(), a.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(bm_relations_loop)->Arg(9)->Arg(25)->Arg(100)->Arg(400);
+
+static void bm_relations(benchmark::State& state, uint32_t features)
+{
+    auto a = std::vector<int32_t>(state.range(0), 42);
+    auto list = passed_list(a.size());
+    auto pointers = std::vector<const int32_t*>{};
+    for (auto& b : list)
+        pointers.push_back(b.data());
+    auto relations = std::vector<relation_t>(list.size());
+    base_setCPUFeatureMask(features);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(base_relations(a.data(), pointers.data(), pointers.size(), a.size(), relations.data()));
+        benchmark::ClobberMemory();
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
+BENCHMARK_CAPTURE(bm_relations, scalar, 0u)->Arg(9)->Arg(25)->Arg(100)->Arg(400);
+BENCHMARK_CAPTURE(bm_relations, sse2, (uint32_t)base_CPU_SSE2)->Arg(9)->Arg(25)->Arg(100)->Arg(400);
+BENCHMARK_CAPTURE(bm_relations, avx2, (uint32_t)(base_CPU_SSE2 | base_CPU_AVX2))->Arg(9)->Arg(25)->Arg(100)->Arg(400);
+BENCHMARK_CAPTURE(bm_relations, avx512, (uint32_t)base_CPU_ALL)->Arg(9)->Arg(25)->Arg(100)->Arg(400);
@@ -0,0 +1,100 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Benchmark the memory and process information queries of platform.h.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/platform.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+
+static void bm_getMemInfo(benchmark::State& state)
+{
+    meminfo_t info;
+    for (auto _ : state) {
+        base_getMemInfo(&info);
+        benchmark::DoNotOptimize(info);
+    }
+    state.counters["phys_total"] = info.phys_total;
+}
+BENCHMARK(bm_getMemInfo);
+
+static void bm_getProcInfo(benchmark::State& state)
+{
+    procinfo_t info;
+    base_initProcInfo();
+    for (auto _ : state) {
+        base_getProcInfo(&info);
+        benchmark::DoNotOptimize(info);
+    }
+    state.counters["mem_work"] = info.mem_work;
+}
+BENCHMARK(bm_getProcInfo);
+
+#ifdef __linux__
+/* the former stdio parsing, for comparison */
+static uint64_t read_key_mem_kb(FILE* f, const char* key)
+{
+    int match = 0;
+    int c = fgetc(f);
+    for (; c != EOF; c = fgetc(f))
+        if (key[match] == c) {
+            ++match;
+            if (key[match] == '\0')
+                break;
+        } else
+            match = 0;
+    if (c == EOF)
+        return 0;
+    for (c = fgetc(f); c != EOF && isspace(c); c = fgetc(f))
+        ;
+    if (c == EOF || ungetc(c, f) == EOF)
+        return 0;
+    uint64_t res = 0;
+    if (fscanf(f, "%" SCNu64, &res) == EOF)
+        return 0;
+    return res;
+}
+
+static void bm_stdio_status(benchmark::State& state)
+{
+    uint64_t rss = 0;
+    for (auto _ : state) {
+        FILE* ps = fopen("/proc/self/status", "r");
+        read_key_mem_kb(ps, "VmSize:");
+        rss = read_key_mem_kb(ps, "VmRSS:");
+        read_key_mem_kb(ps, "VmSwap:");
+        fclose(ps);
+        benchmark::DoNotOptimize(rss);
+    }
+    state.counters["mem_work"] = rss;
+}
+BENCHMARK(bm_stdio_status);
+
+static void bm_stdio_meminfo(benchmark::State& state)
+{
+    uint64_t total = 0;
+    for (auto _ : state) {
+        FILE* ps = fopen("/proc/meminfo", "r");
+        total = read_key_mem_kb(ps, "MemTotal:");
+        read_key_mem_kb(ps, "MemFree:");
+        read_key_mem_kb(ps, "Buffers:");
+        read_key_mem_kb(ps, "Cached:");
+        read_key_mem_kb(ps, "SwapTotal:");
+        read_key_mem_kb(ps, "SwapFree:");
+        fclose(ps);
+        benchmark::DoNotOptimize(total);
+    }
+    state.counters["phys_total"] = total;
+}
+BENCHMARK(bm_stdio_meminfo);
+#endif
@@ -1,4 +1,7 @@
 #include "base/random.h"
+#include "base/DiscreteSampler.h"
+#include "base/fast_random.hpp"
+#include "base/random_engines.hpp"
 
 #include <boost/random.hpp>
 #include <boost/random/exponential_distribution.hpp>
@@ -26,9 +29,22 @@ result_t benchmark_random(Generator&& gen, size_t count = 100'000'000u)
     return {sum / count, std::chrono::duration<double>(t1 - t0).count()};
 }
 
+/** same as benchmark_random for bulk generators called as fill(out, count) */
+template <typename Fill>
+result_t benchmark_fill(Fill&& fill, size_t count = 100'000'000u)
+{
+    auto res = std::vector<double>(count);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    fill(res.data(), res.size());
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto sum = std::accumulate(std::begin(res), std::end(res), 0.);
+    return {sum / count, std::chrono::duration<double>(t1 - t0).count()};
+}
+
 constexpr auto from = -100.;
 constexpr auto till = 200.;
 constexpr auto rate = 0.5;
+constexpr auto few = 10'000'000u;  // draws for the variants, to keep the run short
 
 auto rd = std::random_device{};
 auto std_gen = std::mt19937{rd()};
@@ -41,6 +57,22 @@ auto boost_exp = boost::random::exponential_distribution<double>{rate};
 
 RandomGenerator rng;
 
+using engine_t = RandomGenerator::engine_t;
+const auto engines = std::map<std::string, engine_t>{{"philox", engine_t::philox},
+                                                     {"xoshiro", engine_t::xoshiro256pp},
+                                                     {"pcg64", engine_t::pcg64},
+                                                     {"mt19937", engine_t::mt19937}};
+
+/** raw engine output as uniform [0,1) */
+template <typename Engine>
+double unit(Engine& engine)
+{
+    if constexpr (sizeof(typename Engine::result_type) == 8)
+        return static_cast<double>(static_cast<int64_t>(engine() >> 11)) * 0x1.0p-53;
+    else
+        return engine() * 0x1.0p-32;
+}
+
 int main()
 {
     auto res = std::map<std::string, result_t>{};
@@ -51,6 +83,71 @@ int main()
     res["exp   std"] = benchmark_random([]() { return std_exp(std_gen); });
     res["exp boost"] = benchmark_random([]() { return boost_exp(boost_gen); });
     res["exp   rng"] = benchmark_random([]() { return rng.exp(rate); });
+    res["exp  fill"] = benchmark_fill([](double* out, size_t n) { rng.fill_exp(rate, out, n); }, few);
+
+    res["uni_1 rng"] = benchmark_random([]() { return rng.uni_1(); }, few);
+    res["uni_1fill"] = benchmark_fill([](double* out, size_t n) { rng.fill_uni_1(out, n); }, few);
+
+    res["norm  rng"] = benchmark_random([]() { return rng.normal(1., 2.); }, few);
+    res["norm fill"] = benchmark_fill([](double* out, size_t n) { rng.fill_normal(1., 2., out, n); }, few);
+
+    // engines: raw output, single and bulk variates, creation and seeding
+    auto philox = base::philox4x32{rd()};
+    auto xoshiro = base::xoshiro256pp{rd()};
+    auto pcg = base::pcg64{rd()};
+    res["raw  philox"] = benchmark_random([&]() { return unit(philox); }, few);
+    res["raw xoshiro"] = benchmark_random([&]() { return unit(xoshiro); }, few);
+    res["raw   pcg64"] = benchmark_random([&]() { return unit(pcg); }, few);
+    res["raw mt19937"] = benchmark_random([]() { return unit(boost_gen); }, few);
+    for (auto& [name, engine] : engines) {
+        auto gen = RandomGenerator{rd(), 0, engine};
+        res["uni_1 " + name] = benchmark_random([&]() { return gen.uni_1(); }, few);
+        res["uni_1fill " + name] = benchmark_fill([&](double* out, size_t n) { gen.fill_uni_1(out, n); }, few);
+        res["norm fill " + name] = benchmark_fill([&](double* out, size_t n) { gen.fill_normal(1., 2., out, n); }, few);
+        auto stream = uint64_t{0};
+        res["seed " + name] = benchmark_random(
+            [&]() { return RandomGenerator{42, stream++, engine}.uni_1(); }, 1'000'000u);
+    }
+
+    // header-only generator, inlined into the loops
+    auto fast_philox = base::FastRandom<base::philox4x32>{rd()};
+    auto fast_xoshiro = base::FastRandom<base::xoshiro256pp>{rd()};
+    res["fast uni_1 philox"] = benchmark_random([&]() { return fast_philox.uni_1(); }, few);
+    res["fast uni_1 xoshiro"] = benchmark_random([&]() { return fast_xoshiro.uni_1(); }, few);
+    res["fast uni   xoshiro"] = benchmark_random([&]() { return fast_xoshiro.uni(1000u); }, few);
+    res["fast exp   xoshiro"] = benchmark_random([&]() { return fast_xoshiro.exp(rate); }, few);
+    res["fast norm  philox"] = benchmark_random([&]() { return fast_philox.normal(1., 2.); }, few);
+    res["fast norm  xoshiro"] = benchmark_random([&]() { return fast_xoshiro.normal(1., 2.); }, few);
+    res["fast gamma xoshiro"] = benchmark_random([&]() { return fast_xoshiro.gamma(2., 2.); }, few);
+    auto xoshiro_gen = RandomGenerator{rd(), 0, engine_t::xoshiro256pp};
+    res["rng  gamma xoshiro"] = benchmark_random([&]() { return xoshiro_gen.gamma(2., 2.); }, few);
+
+    // parameter-bound distributions against the single calls
+    auto gamma = xoshiro_gen.make_gamma(2., 2.);
+    auto poisson = xoshiro_gen.make_poisson(50.);
+    auto weibull = xoshiro_gen.make_weibull(1.5, 2.);
+    auto fast_poisson = fast_xoshiro.make_poisson(50.);
+    res["bound gamma   rng"] = benchmark_random([&]() { return gamma(); }, few);
+    res["bound poisson rng"] = benchmark_random([&]() { return poisson(); }, few);
+    res["bound poisson fast"] = benchmark_random([&]() { return fast_poisson(); }, few);
+    res["bound weibull rng"] = benchmark_random([&]() { return weibull(); }, few);
+    res["rng  poisson xoshiro"] = benchmark_random([&]() { return xoshiro_gen.poisson(50.); }, few);
+    res["rng  weibull xoshiro"] = benchmark_random([&]() { return xoshiro_gen.weibull(1.5, 2.); }, few);
+    res["fast poisson xoshiro"] = benchmark_random([&]() { return fast_xoshiro.poisson(50.); }, few);
+
+    // weighted choice among 1000 edges
+    auto weights = std::vector<double>(1000);
+    std::generate(weights.begin(), weights.end(), [&]() { return xoshiro_gen.uni_r(1.); });
+    auto std_discrete = std::discrete_distribution<size_t>{weights.begin(), weights.end()};
+    auto sampler = base::DiscreteSampler{weights};
+    res["discrete   std"] = benchmark_random([&]() { return std_discrete(std_gen); }, few);
+    res["discrete   rng"] = benchmark_random([&]() { return sampler(xoshiro_gen); }, few);
+    res["discrete  fast"] = benchmark_random([&]() { return sampler(fast_xoshiro); }, few);
+    res["discrete update"] = benchmark_random([&]() {
+        const auto i = fast_xoshiro.uni(999u);
+        sampler.set_weight(i, fast_xoshiro.uni_1());
+        return sampler(fast_xoshiro);
+    }, few);
 
     for (auto& [name, res] : res)
         std::cout << name << ": " << res.mean << " in " << res.seconds << "\n";
@@ -0,0 +1,147 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Benchmark base::RoaringBitmap against flat bit strings.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/RoaringBitmap.h"
+#include "base/bitstring.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+/**
+ * The index space has 2^24 values, the argument is the number of
+ * values set per 2^16, i.e., per roaring container.
+ * The bytes counter reports the memory used by one set.
+ * ./bm_roaring_bitmap --benchmark_counters_tabular=true
+ */
+
+constexpr size_t SPACE = 1u << 24;
+constexpr size_t INTS = SPACE / 32;
+
+static std::vector<uint32_t> random_values(size_t perContainer, uint32_t seed)
+{
+    auto rng = std::mt19937{seed};
+    auto dist = std::uniform_int_distribution<uint32_t>{0, SPACE - 1};
+    auto res = std::vector<uint32_t>(perContainer * (SPACE >> 16));
+    for (auto& x : res)
+        x = dist(rng);
+    return res;
+}
+
+static std::vector<uint32_t> flat_bits(const std::vector<uint32_t>& values)
+{
+    auto res = std::vector<uint32_t>(INTS);
+    for (auto x : values)
+        base_setOneBit(res.data(), x);
+    return res;
+}
+
+static base::RoaringBitmap roaring(const std::vector<uint32_t>& values)
+{
+    auto res = base::RoaringBitmap{};
+    for (auto x : values)
+        res.add(x);
+    return res;
+}
+
+static void bm_flat_union(benchmark::State& state)
+{
+    auto a = flat_bits(random_values(state.range(0), 1));
+    auto b = flat_bits(random_values(state.range(0), 2));
+    for (auto _ : state) {
+        auto c = a;
+        for (size_t i = 0; i < INTS; ++i)
+            c[i] |= b[i];
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.counters["bytes"] = INTS * sizeof(uint32_t);
+}
+BENCHMARK(bm_flat_union)->RangeMultiplier(8)->Range(8, 32768);
+
+static void bm_roaring_union(benchmark::State& state)
+{
+    auto a = roaring(random_values(state.range(0), 1));
+    auto b = roaring(random_values(state.range(0), 2));
+    for (auto _ : state) {
+        auto c = a;
+        c |= b;
+        benchmark::DoNotOptimize(c);
+    }
+    state.counters["bytes"] = a.memoryUsage();
+}
+BENCHMARK(bm_roaring_union)->RangeMultiplier(8)->Range(8, 32768);
+
+static void bm_flat_intersection(benchmark::State& state)
+{
+    auto a = flat_bits(random_values(state.range(0), 1));
+    auto b = flat_bits(random_values(state.range(0), 2));
+    for (auto _ : state) {
+        auto c = a;
+        for (size_t i = 0; i < INTS; ++i)
+            c[i] &= b[i];
+        benchmark::DoNotOptimize(c.data());
+    }
+}
+BENCHMARK(bm_flat_intersection)->RangeMultiplier(8)->Range(8, 32768);
+
+static void bm_roaring_intersection(benchmark::State& state)
+{
+    auto a = roaring(random_values(state.range(0), 1));
+    auto b = roaring(random_values(state.range(0), 2));
+    for (auto _ : state) {
+        auto c = a;
+        c &= b;
+        benchmark::DoNotOptimize(c);
+    }
+}
+BENCHMARK(bm_roaring_intersection)->RangeMultiplier(8)->Range(8, 32768);
+
+static void bm_flat_scan(benchmark::State& state)
+{
+    auto a = flat_bits(random_values(state.range(0), 1));
+    auto table = std::vector<cindex_t>(SPACE);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(base_bits2indexTable(a.data(), INTS, table.data()));
+}
+BENCHMARK(bm_flat_scan)->RangeMultiplier(8)->Range(8, 32768);
+
+static void bm_roaring_scan(benchmark::State& state)
+{
+    auto a = roaring(random_values(state.range(0), 1));
+    auto table = std::vector<cindex_t>(SPACE);
+    for (auto _ : state) {
+        cindex_t index = 0;
+        a.forEach([&](uint32_t x) { table[x] = index++; });
+        benchmark::DoNotOptimize(index);
+    }
+}
+BENCHMARK(bm_roaring_scan)->RangeMultiplier(8)->Range(8, 32768);
+
+static void bm_flat_contains(benchmark::State& state)
+{
+    auto a = flat_bits(random_values(state.range(0), 1));
+    auto queries = random_values(16, 3);
+    for (auto _ : state)
+        for (auto x : queries)
+            benchmark::DoNotOptimize(base_getOneBit(a.data(), x));
+}
+BENCHMARK(bm_flat_contains)->RangeMultiplier(8)->Range(8, 32768);
+
+static void bm_roaring_contains(benchmark::State& state)
+{
+    auto a = roaring(random_values(state.range(0), 1));
+    auto queries = random_values(16, 3);
+    for (auto _ : state)
+        for (auto x : queries)
+            benchmark::DoNotOptimize(a.contains(x));
+}
+BENCHMARK(bm_roaring_contains)->RangeMultiplier(8)->Range(8, 32768);
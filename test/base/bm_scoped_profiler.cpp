@@ -0,0 +1,57 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Benchmark entering and leaving the zones of ScopedProfiler.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/ScopedProfiler.h"
+
+#include <benchmark/benchmark.h>
+
+/** a zone with an existing node */
+static void bm_zone(benchmark::State& state)
+{
+    for (auto _ : state) {
+        BASE_PROFILE_ZONE("bm_zone");
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(bm_zone);
+
+/** a zone among many siblings */
+static void bm_zone_siblings(benchmark::State& state)
+{
+    BASE_PROFILE_ZONE("bm_zone_siblings");
+    {
+        BASE_PROFILE_ZONE("a");
+    }
+    {
+        BASE_PROFILE_ZONE("b");
+    }
+    {
+        BASE_PROFILE_ZONE("c");
+    }
+    for (auto _ : state) {
+        BASE_PROFILE_ZONE("d");
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(bm_zone_siblings);
+
+/** two nested zones per iteration */
+static void bm_nested_zones(benchmark::State& state)
+{
+    for (auto _ : state) {
+        BASE_PROFILE_ZONE("outer");
+        {
+            BASE_PROFILE_ZONE("inner");
+            benchmark::ClobberMemory();
+        }
+    }
+}
+BENCHMARK(bm_nested_zones);
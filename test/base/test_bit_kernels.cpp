@@ -0,0 +1,105 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Test the run-time dispatched kernels of bitstring.h
+// against simple reference implementations on every instruction set.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/bitstring.h"
+#include "base/cpu.h"
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+
+namespace {
+uint32_t refCount(const std::vector<uint32_t>& bits)
+{
+    uint32_t count = 0;
+    for (auto b : bits)
+        for (; b != 0; b >>= 1)
+            count += b & 1;
+    return count;
+}
+
+/** feature sets to test, from the best to none */
+const uint32_t featureMasks[] = {base_CPU_ALL, base_CPU_ALL & ~base_CPU_AVX512POPCNT,
+                                 base_CPU_ALL & ~(base_CPU_AVX512 | base_CPU_AVX512POPCNT), base_CPU_POPCNT, 0};
+}  // namespace
+
+TEST_CASE("bit string kernels")
+{
+    auto gen = std::mt19937{std::random_device{}()};
+    auto rnd = std::uniform_int_distribution<uint32_t>{};
+    for (auto mask : featureMasks) {
+        base_setCPUFeatureMask(mask);
+        for (size_t n = 0; n < 200; n += (n < 40 ? 1 : 13)) {
+            auto bits = std::vector<uint32_t>(n + 1);  // +1 to have a valid pointer
+            for (auto& b : bits)
+                b = rnd(gen);
+            bits.pop_back();
+            CHECK(base_countBitsN(bits.data(), n) == refCount(bits));
+
+            auto copy = bits;
+            CHECK(base_areBitsEqual(bits.data(), copy.data(), n));
+            base_resetBits(copy.data(), n);
+            CHECK(refCount(copy) == 0);
+            CHECK(base_areBitsReset(copy.data(), n));
+            auto other = bits;
+            for (size_t i = 0; i < n * 32; i += 7) {
+                base_setOneBit(copy.data(), i);
+                CHECK_FALSE(base_areBitsReset(copy.data(), n));
+                CHECK(base_countBitsN(copy.data(), n) == 1);
+                base_resetOneBit(copy.data(), i);
+                base_toggleOneBit(other.data(), i);
+                CHECK_FALSE(base_areBitsEqual(bits.data(), other.data(), n));
+                base_toggleOneBit(other.data(), i);
+                CHECK(base_areBitsEqual(bits.data(), other.data(), n));
+            }
+        }
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
+
+TEST_CASE("bit string to index table and back")
+{
+    auto gen = std::mt19937{std::random_device{}()};
+    auto rnd = std::uniform_int_distribution<uint32_t>{};
+    for (auto mask : featureMasks) {
+        base_setCPUFeatureMask(mask);
+        for (size_t n = 0; n < 100; n += (n < 20 ? 1 : 9)) {
+            auto bits = std::vector<uint32_t>(n + 1);
+            for (auto& b : bits)
+                b = rnd(gen) & rnd(gen);  // sparser
+            bits.pop_back();
+            if (n > 2)
+                bits[1] = ~0u;  // dense word
+
+            auto table = std::vector<cindex_t>(n * 32 + 1, ~0u);
+            auto count = base_bits2indexTable(bits.data(), n, table.data());
+            REQUIRE(count == refCount(bits));
+            auto indices = std::vector<cindex_t>(count + 1);
+            size_t index = 0;
+            for (size_t i = 0; i < n * 32; ++i) {
+                if (base_getOneBit(bits.data(), i)) {
+                    CHECK(table[i] == index);
+                    indices[index++] = i;
+                } else {
+                    CHECK(table[i] == ~0u);  // untouched
+                }
+            }
+            CHECK(table[n * 32] == ~0u);
+
+            auto packed = std::vector<uint32_t>(n + 1, ~0u);
+            base_indexTable2bits(indices.data(), count, packed.data(), n);
+            CHECK(packed[n] == ~0u);
+            packed.pop_back();
+            CHECK(packed == bits);
+        }
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
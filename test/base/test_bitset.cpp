@@ -0,0 +1,157 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Test base::BitSet against std::vector<bool> on every instruction set.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/BitSet.h"
+#include "base/cpu.h"
+#include <doctest/doctest.h>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using base::BitSet;
+
+namespace {
+auto gen = std::mt19937{std::random_device{}()};
+
+std::vector<bool> randomBits(size_t size, double density)
+{
+    auto bit = std::bernoulli_distribution{density};
+    auto res = std::vector<bool>(size);
+    for (size_t i = 0; i < size; ++i)
+        res[i] = bit(gen);
+    return res;
+}
+
+BitSet toBitSet(const std::vector<bool>& bits)
+{
+    auto res = BitSet{bits.size()};
+    for (size_t i = 0; i < bits.size(); ++i)
+        if (bits[i])
+            res.set(i);
+    return res;
+}
+
+bool same(const BitSet& set, const std::vector<bool>& bits)
+{
+    if (set.size() != bits.size())
+        return false;
+    for (size_t i = 0; i < bits.size(); ++i)
+        if (set[i] != bits[i])
+            return false;
+    return true;
+}
+
+const uint32_t featureMasks[] = {base_CPU_ALL, base_CPU_ALL & ~(base_CPU_AVX512 | base_CPU_AVX512POPCNT), 0};
+const size_t sizes[] = {0, 1, 63, 64, 65, 255, 256, 257, 300, 511, 512, 700, 1029};
+}  // namespace
+
+TEST_CASE("BitSet single bits and iteration")
+{
+    for (auto size : sizes) {
+        auto ref = randomBits(size, 0.3);
+        auto set = toBitSet(ref);
+        REQUIRE(same(set, ref));
+        auto positions = std::vector<size_t>{};
+        for (size_t i = 0; i < size; ++i)
+            if (ref[i])
+                positions.push_back(i);
+        CHECK(set.count() == positions.size());
+        CHECK(set.none() == positions.empty());
+        CHECK(std::vector<size_t>(set.begin(), set.end()) == positions);
+        auto visited = std::vector<size_t>{};
+        set.forEach([&](size_t i) { visited.push_back(i); });
+        CHECK(visited == positions);
+
+        set.set();
+        CHECK(set.count() == size);
+        set.reset();
+        CHECK(set.none());
+        CHECK(set.findFirst() == BitSet::npos);
+    }
+}
+
+TEST_CASE("BitSet copy, move and resize")
+{
+    for (auto size : sizes) {
+        auto ref = randomBits(size, 0.5);
+        auto set = toBitSet(ref);
+        auto copy = set;
+        CHECK(copy == set);
+        auto moved = std::move(copy);
+        CHECK(moved == set);
+        CHECK(copy.size() == 0);
+        copy = moved;
+        CHECK(copy == set);
+        copy = BitSet{3};
+        CHECK(copy.size() == 3);
+
+        // grow: the new bits are reset
+        set.set();
+        set.resize(size + 100);
+        CHECK(set.count() == size);
+        // shrink then grow: the dropped bits are gone
+        set.resize(size / 2);
+        CHECK(set.count() == size / 2);
+        set.resize(size);
+        CHECK(set.count() == size / 2);
+    }
+    auto os = std::ostringstream{};
+    auto set = BitSet{10};
+    set.set(1);
+    set.set(4);
+    set.set(5);
+    os << set;
+    CHECK(os.str() == "{1,4,5}");
+}
+
+TEST_CASE("BitSet bulk operations")
+{
+    for (auto mask : featureMasks) {
+        base_setCPUFeatureMask(mask);
+        for (auto size : sizes) {
+            auto ra = randomBits(size, 0.5);
+            auto rb = randomBits(size, 0.5);
+            auto a = toBitSet(ra);
+            auto b = toBitSet(rb);
+            auto rand = ra, ror = ra, rxor = ra, randNot = ra;
+            bool subset = true, intersects = false;
+            for (size_t i = 0; i < size; ++i) {
+                rand[i] = ra[i] && rb[i];
+                ror[i] = ra[i] || rb[i];
+                rxor[i] = ra[i] != rb[i];
+                randNot[i] = ra[i] && !rb[i];
+                subset = subset && (!ra[i] || rb[i]);
+                intersects = intersects || (ra[i] && rb[i]);
+            }
+            CHECK(same(a & b, rand));
+            CHECK(same(a | b, ror));
+            CHECK(same(a ^ b, rxor));
+            CHECK(same(BitSet{a}.andNot(b), randNot));
+            CHECK(a.isSubsetOf(b) == subset);
+            CHECK(a.intersects(b) == intersects);
+
+            auto sub = a & b;
+            CHECK(sub.isSubsetOf(a));
+            CHECK(sub.isSubsetOf(b));
+            CHECK(sub.intersects(BitSet{a}.andNot(b)) == false);
+            if (size > 0) {
+                // a single bit decides, at every position of the last words
+                for (size_t i = size > 200 ? size - 200 : 0; i < size; ++i) {
+                    auto one = BitSet{size};
+                    one.set(i);
+                    CHECK(one.isSubsetOf(a) == ra[i]);
+                    CHECK(one.intersects(a) == ra[i]);
+                }
+            }
+        }
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
@@ -0,0 +1,99 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Test DataAllocator compaction.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/DataAllocator.h"
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+
+namespace {
+struct Cell
+{
+    uint32_t size{0};
+    int32_t* data{nullptr};
+};
+
+void fill(Cell& cell, int32_t seed)
+{
+    for (uint32_t j = 0; j < cell.size; ++j)
+        cell.data[j] = seed + j;
+}
+
+bool check(const Cell& cell, int32_t seed)
+{
+    for (uint32_t j = 0; j < cell.size; ++j)
+        if (cell.data[j] != seed + (int32_t)j)
+            return false;
+    return true;
+}
+}  // namespace
+
+TEST_CASE("DataAllocator compaction")
+{
+    auto gen = std::mt19937{42};
+    auto sizes = std::uniform_int_distribution<uint32_t>{1, 900};
+    auto alloc = base::DataAllocator{};
+    auto cells = std::vector<Cell>(50'000);
+    for (auto& cell : cells) {
+        cell.size = sizes(gen);
+        cell.data = (int32_t*)alloc.allocate(cell.size);
+    }
+    auto enumerate = [&cells](const base::DataAllocator::relocate_t& relocate) {
+        for (auto& cell : cells)
+            if (cell.data)
+                cell.data = (int32_t*)relocate(cell.data, cell.size);
+    };
+
+    SUBCASE("nothing to compact when pools are full")
+    {
+        for (size_t i = 0; i < cells.size(); ++i)
+            fill(cells[i], i);
+        auto moved = size_t{0};
+        auto released = alloc.compact([&](const base::DataAllocator::relocate_t& relocate) {
+            for (auto& cell : cells) {
+                auto* data = (int32_t*)relocate(cell.data, cell.size);
+                moved += data != cell.data;
+                cell.data = data;
+            }
+        });
+        CHECK(released == 0);
+        CHECK(moved == 0);
+        for (size_t i = 0; i < cells.size(); ++i)
+            CHECK(check(cells[i], i));
+    }
+    SUBCASE("sparse pools are released and live data is preserved")
+    {
+        auto keep = std::bernoulli_distribution{0.1};
+        for (auto& cell : cells) {
+            if (!keep(gen)) {
+                alloc.deallocate(cell.data, cell.size);
+                cell.data = nullptr;
+            }
+        }
+        for (size_t i = 0; i < cells.size(); ++i)
+            if (cells[i].data)
+                fill(cells[i], i);
+        auto released = alloc.compact(enumerate);
+        CHECK(released > 0);
+        for (size_t i = 0; i < cells.size(); ++i)
+            if (cells[i].data)
+                CHECK(check(cells[i], i));
+        // the former current pool may be evacuated in a second pass
+        alloc.compact(enumerate);
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (cells[i].data) {
+                CHECK(check(cells[i], i));
+                alloc.deallocate(cells[i].data, cells[i].size);
+                cells[i].data = nullptr;
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#include "base/CycleTimer.h"
+#include <doctest/doctest.h>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+using base::CycleTimer;
+using namespace std::chrono_literals;
+
+TEST_CASE("CycleTimer is calibrated")
+{
+    CHECK(CycleTimer::frequency() > 1e6);
+    CHECK(std::abs(CycleTimer::to_seconds(CycleTimer::frequency()) - 1) < 1e-9);
+    if (!CycleTimer::uses_tsc())
+        CHECK(CycleTimer::frequency() == 1e9);
+    MESSAGE((CycleTimer::uses_tsc() ? "time-stamp counter at " : "steady clock at ")
+            << CycleTimer::frequency() << " Hz");
+}
+
+TEST_CASE("CycleTimer is monotonic")
+{
+    auto last = CycleTimer::now();
+    for (auto i = 0; i < 100000; ++i) {
+        const auto t = i % 2 ? CycleTimer::now() : CycleTimer::now_precise();
+        REQUIRE(t >= last);
+        last = t;
+    }
+}
+
+TEST_CASE("CycleTimer agrees with the steady clock")
+{
+    // generous bounds for slow and loaded hosts
+    const auto t0 = std::chrono::steady_clock::now();
+    auto t = CycleTimer{};
+    std::this_thread::sleep_for(50ms);
+    const auto ticks = t.getTicks();
+    const auto steady = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    CHECK(CycleTimer::to_seconds(ticks) >= 0.049);
+    CHECK(CycleTimer::to_seconds(ticks) <= steady * 1.01 + 1e-3);
+    CHECK(CycleTimer::to_duration(ticks) >= 49ms);
+}
+
+TEST_CASE("CycleTimer pauses")
+{
+    auto t = CycleTimer{false};
+    CHECK(t.getTicks() == 0);
+    std::this_thread::sleep_for(20ms);
+    CHECK(t.getTicks() == 0);
+    {
+        auto measure = CycleTimer::AutoStartStop{t};
+        std::this_thread::sleep_for(20ms);
+    }
+    const auto paused = t.getTicks();
+    CHECK(t.getElapsed() >= 0.019);
+    std::this_thread::sleep_for(20ms);
+    CHECK(t.getTicks() == paused);
+    t.start();
+    std::this_thread::sleep_for(20ms);
+    CHECK(t.getElapsed() >= 0.039);
+    t.reset();
+    CHECK(t.getElapsed() < 0.019);
+}
@@ -0,0 +1,110 @@
+#include "base/DiscreteSampler.h"
+#include "base/exceptions.h"
+#include "base/fast_random.hpp"
+#include "base/random.h"
+#include <doctest/doctest.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using base::DiscreteSampler;
+
+/** checks that the frequencies of n samples are within 5 standard deviations of the probabilities */
+template <typename Rng>
+static void check_frequencies(const DiscreteSampler& sampler, Rng& rng, size_t n = 200000)
+{
+    auto counts = std::vector<size_t>(sampler.size());
+    for (size_t k = 0; k < n; ++k) {
+        const size_t i = sampler(rng);
+        REQUIRE(i < sampler.size());
+        ++counts[i];
+    }
+    for (size_t i = 0; i < sampler.size(); ++i) {
+        const double p = sampler.probability(i);
+        if (p == 0)
+            CHECK(counts[i] == 0);
+        else
+            CHECK(std::abs(counts[i] - n * p) <= 5 * std::sqrt(n * p * (1 - p)) + 1);
+    }
+}
+
+TEST_CASE("DiscreteSampler samples by weight")
+{
+    auto rng = RandomGenerator{2026, 1};
+    SUBCASE("uneven")
+    {
+        const auto sampler = DiscreteSampler{{1, 2, 3, 4, 0, 10}};
+        CHECK(sampler.size() == 6);
+        CHECK(sampler.total() == 20);
+        CHECK(sampler.probability(5) == 0.5);
+        check_frequencies(sampler, rng);
+    }
+    SUBCASE("single")
+    {
+        const auto sampler = DiscreteSampler{{0, 0, 3}};
+        for (auto k = 0; k < 100; ++k)
+            CHECK(sampler(rng) == 2);
+    }
+    SUBCASE("skewed")
+    {
+        auto weights = std::vector<double>(1000, 1e-6);
+        weights[17] = 1e6;
+        weights[999] = 1;
+        check_frequencies(DiscreteSampler{weights}, rng);
+    }
+    SUBCASE("FastRandom")
+    {
+        auto fast = base::FastRandom<base::xoshiro256pp>{5};
+        check_frequencies(DiscreteSampler{{0.5, 0.25, 0.125, 0.125}}, fast);
+    }
+}
+
+TEST_CASE("DiscreteSampler updates weights")
+{
+    auto rng = RandomGenerator{2026, 2};
+    auto sampler = DiscreteSampler{{1, 1, 1, 1, 1, 1, 1, 1}};
+    SUBCASE("decrease and increase")
+    {
+        sampler.set_weight(0, 0);
+        sampler.set_weight(1, 0.5);
+        sampler.set_weight(2, 1.5);
+        CHECK(sampler.total() == 7);
+        check_frequencies(sampler, rng);
+        sampler.set_weight(0, 3);
+        CHECK(sampler.weight(0) == 3);
+        check_frequencies(sampler, rng);
+    }
+    SUBCASE("from zero")
+    {
+        for (size_t i = 0; i < sampler.size(); ++i)
+            sampler.set_weight(i, 0);
+        CHECK(sampler.total() == 0);
+        sampler.set_weight(3, 2);
+        for (auto k = 0; k < 100; ++k)
+            CHECK(sampler(rng) == 3);
+    }
+    SUBCASE("random walk")
+    {
+        auto weights = std::vector<double>(100, 1.);
+        sampler.assign(weights);
+        for (auto step = 0; step < 10000; ++step) {
+            const auto i = rng.uni(99u);
+            weights[i] = rng.uni(3u) == 0 ? 0. : rng.uni_r(10.);
+            sampler.set_weight(i, weights[i]);
+        }
+        for (size_t i = 0; i < weights.size(); ++i)
+            CHECK(sampler.weight(i) == weights[i]);
+        check_frequencies(sampler, rng);
+    }
+}
+
+TEST_CASE("DiscreteSampler rejects bad weights")
+{
+    CHECK_THROWS_AS(DiscreteSampler({1, -1}), RuntimeException);
+    CHECK_THROWS_AS(DiscreteSampler({1, std::numeric_limits<double>::infinity()}), RuntimeException);
+    CHECK_THROWS_AS(DiscreteSampler({std::numeric_limits<double>::quiet_NaN()}), RuntimeException);
+    auto sampler = DiscreteSampler{{1, 2}};
+    CHECK_THROWS_AS(sampler.set_weight(0, -2), RuntimeException);
+    CHECK(sampler.weight(0) == 1);
+    CHECK(DiscreteSampler{}.empty());
+}
@@ -0,0 +1,118 @@
+#include "base/fast_random.hpp"
+#include <doctest/doctest.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using base::FastRandom;
+
+template <typename Engine>
+void check_ranges()
+{
+    auto rng = FastRandom<Engine>{7, 3};
+    {  // integers
+        bool lower_bound = false, upper_bound = false;
+        for (auto i = 0; i < 200; ++i) {
+            auto r = rng.uni(-5, 5);
+            CHECK(-5 <= r);
+            CHECK(r <= 5);
+            lower_bound |= r == -5;
+            upper_bound |= r == 5;
+        }
+        CHECK(lower_bound);
+        CHECK(upper_bound);
+        CHECK(rng.uni(5, 5) == 5);
+        CHECK(rng.uni(7u, 7u) == 7u);
+        CHECK(rng.uni(0u) == 0u);
+        rng.uni(std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max());
+        rng.uni(std::numeric_limits<uint32_t>::max());
+        for (auto i = 0; i < 100; ++i)
+            CHECK(rng.uni(2u, 1000000000u) >= 2u);
+    }
+    {  // reals
+        for (auto i = 0; i < 1000; ++i) {
+            auto u = rng.uni_1();
+            CHECK(0 <= u);
+            CHECK(u < 1);
+            auto r = rng.uni_r(-3., 2.);
+            CHECK(-3 <= r);
+            CHECK(r < 2);
+            CHECK(rng.uni_r(1e-300) < 1e-300);
+            CHECK(rng.exp(2) >= 0);
+            CHECK(rng.weibull(1.5, 2) >= 0);
+            auto t = rng.tri(1, 2, 4);
+            CHECK(1 <= t);
+            CHECK(t <= 4);
+            auto a = rng.arcsine(-1, 1);
+            CHECK(-1 <= a);
+            CHECK(a <= 1);
+            auto b = rng.beta(0.5, 2);
+            CHECK(0 <= b);
+            CHECK(b <= 1);
+            CHECK(rng.gamma(0.1, 1) >= 0);
+            CHECK(rng.poisson(1e-3) >= 0);
+        }
+        // till - from overflows
+        const auto max = std::numeric_limits<double>::max();
+        for (auto i = 0; i < 100; ++i) {
+            auto r = rng.uni_r(-max, max);
+            CHECK(std::isfinite(r));
+            CHECK(r < max);
+        }
+    }
+}
+
+template <typename Engine>
+void check_moments()
+{
+    auto rng = FastRandom<Engine>{2026};
+    constexpr auto n = 200000;
+    auto check = [&](auto&& gen, double mean, double variance) {
+        auto sum = 0., sum2 = 0.;
+        for (auto i = 0; i < n; ++i) {
+            const double x = gen();
+            sum += x;
+            sum2 += x * x;
+        }
+        const auto m = sum / n;
+        const auto v = sum2 / n - m * m;
+        // 6 standard errors of the mean and 10% of the variance
+        CHECK(std::abs(m - mean) < 6 * std::sqrt(variance / n));
+        CHECK(std::abs(v - variance) < 0.1 * variance);
+    };
+    check([&] { return rng.uni(0u, 9u); }, 4.5, 8.25);
+    check([&] { return rng.exp(0.5); }, 2, 4);
+    check([&] { return rng.normal(-1, 3); }, -1, 9);
+    check([&] { return rng.gamma(3, 2); }, 6, 12);
+    check([&] { return rng.poisson(3); }, 3, 3);
+    check([&] { return rng.poisson(1000); }, 1000, 1000);
+}
+
+TEST_CASE("FastRandom ranges")
+{
+    check_ranges<base::philox4x32>();
+    check_ranges<base::xoshiro256pp>();
+    check_ranges<base::pcg64>();
+}
+
+TEST_CASE("FastRandom moments")
+{
+    check_moments<base::philox4x32>();
+    check_moments<base::xoshiro256pp>();
+    check_moments<base::pcg64>();
+}
+
+TEST_CASE("FastRandom is reproducible")
+{
+    auto a = FastRandom<>{5, 1};
+    auto b = FastRandom<>{base::philox4x32{5, 1}};
+    for (auto i = 0; i < 100; ++i) {
+        CHECK(a.normal(0, 1) == b.normal(0, 1));
+        CHECK(a.uni(100u) == b.uni(100u));
+    }
+    auto c = FastRandom<>{5, 2};
+    auto same = 0;
+    for (auto i = 0; i < 100; ++i)
+        same += a.uni_1() == c.uni_1();
+    CHECK(same == 0);
+}
@@ -0,0 +1,139 @@
+#include "base/Histogram.h"
+#include "base/exceptions.h"
+#include <doctest/doctest.h>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using base::Histogram;
+
+static double relative_error(uint64_t reported, uint64_t exact)
+{
+    return exact ? std::abs(double(reported) - double(exact)) / double(exact) : double(reported);
+}
+
+TEST_CASE("Histogram buckets")
+{
+    for (unsigned p : {1u, 3u, 7u, 14u}) {
+        CHECK(Histogram::index(0, p) == 0);
+        CHECK(Histogram::index(UINT64_MAX, p) == Histogram::bucket_count(p) - 1);
+        CHECK(Histogram::highest(Histogram::bucket_count(p) - 1, p) == UINT64_MAX);
+        // exact below 2^(p+1)
+        for (uint64_t v = 0; v < (uint64_t{2} << p); ++v)
+            REQUIRE(Histogram::lowest(Histogram::index(v, p), p) == v);
+        // contiguous buckets with the bounded relative width
+        for (size_t i = 1; i < Histogram::bucket_count(p); ++i) {
+            REQUIRE(Histogram::lowest(i, p) == Histogram::highest(i - 1, p) + 1);
+            REQUIRE(Histogram::index(Histogram::lowest(i, p), p) == i);
+            REQUIRE(Histogram::index(Histogram::highest(i, p), p) == i);
+            const double width = Histogram::highest(i, p) - Histogram::lowest(i, p);
+            REQUIRE(width <= Histogram::lowest(i, p) / double(uint64_t{1} << p));
+        }
+    }
+    CHECK(Histogram::bucket_count(Histogram::DEFAULT_PRECISION) == 7424);
+    CHECK_THROWS_AS(Histogram{0}, RuntimeException);
+    CHECK_THROWS_AS(Histogram{Histogram::MAX_PRECISION + 1}, RuntimeException);
+}
+
+TEST_CASE("Histogram percentiles")
+{
+    auto h = Histogram{};
+    CHECK(h.snapshot().empty());
+    CHECK(h.snapshot().percentile(50) == 0);
+    auto values = std::vector<uint64_t>{};
+    auto gen = std::mt19937_64{2026};
+    auto dist = std::lognormal_distribution<double>{10, 2};
+    for (int i = 0; i < 100000; ++i) {
+        values.push_back(static_cast<uint64_t>(dist(gen)));
+        h.record(values.back());
+    }
+    std::sort(values.begin(), values.end());
+    const auto s = h.snapshot();
+    CHECK(s.count() == values.size());
+    CHECK(s.min() == values.front());
+    CHECK(s.max() == values.back());
+    CHECK(s.percentile(0) == values.front());
+    CHECK(s.percentile(100) == values.back());
+    for (double p : {1., 25., 50., 90., 99., 99.9}) {
+        const auto exact = values[static_cast<size_t>(std::ceil(p / 100 * values.size())) - 1];
+        MESSAGE("p" << p << ": " << s.percentile(p) << " vs " << exact);
+        CHECK(relative_error(s.percentile(p), exact) <= 1. / 128);
+    }
+    double mean = 0;
+    for (auto v : values)
+        mean += double(v) / values.size();
+    CHECK(std::abs(s.mean() - mean) <= mean / 128);
+    CHECK(s.count_between(0, UINT64_MAX) == s.count());
+    const auto top = Histogram::index(values.back(), s.precision());
+    CHECK(s.count_between(Histogram::lowest(top, s.precision()), UINT64_MAX) >= 1);
+    CHECK(s.count_between(Histogram::highest(top, s.precision()) + 1, UINT64_MAX) == 0);
+    MESSAGE(s);
+    h.reset();
+    CHECK(h.snapshot().empty());
+}
+
+TEST_CASE("Histogram records concurrently")
+{
+    auto h = Histogram{};
+    auto threads = std::vector<std::thread>{};
+    for (uint64_t t = 0; t < 4; ++t)
+        threads.emplace_back([&h, t] {
+            for (uint64_t i = 1; i <= 100000; ++i)
+                h.record(i * (t + 1));
+        });
+    for (auto& t : threads)
+        t.join();
+    const auto s = h.snapshot();
+    CHECK(s.count() == 400000);
+    CHECK(s.min() == 1);
+    CHECK(s.max() == 400000);
+}
+
+TEST_CASE("Histogram snapshots merge and serialize")
+{
+    auto a = Histogram{}, b = Histogram{}, all = Histogram{};
+    for (uint64_t i = 0; i < 1000; ++i) {
+        a.record(i * i, 2);
+        all.record(i * i, 2);
+        b.record(i * 1000003 + 17);
+        all.record(i * 1000003 + 17);
+    }
+    auto merged = a.snapshot();
+    merged += b.snapshot();
+    const auto expected = all.snapshot();
+    CHECK(merged.count() == expected.count());
+    CHECK(merged.min() == expected.min());
+    CHECK(merged.max() == expected.max());
+    CHECK(merged.serialize() == expected.serialize());
+    CHECK_THROWS_AS(merged += Histogram{3}.snapshot(), RuntimeException);
+
+    const auto data = merged.serialize();
+    MESSAGE(data.size() << " bytes for " << Histogram::bucket_count(merged.precision()) << " buckets");
+    CHECK(data.size() < 4000);
+    const auto copy = Histogram::Snapshot::deserialize(data);
+    CHECK(copy.count() == merged.count());
+    CHECK(copy.min() == merged.min());
+    CHECK(copy.max() == merged.max());
+    for (double p : {0., 50., 99., 99.9, 100.})
+        CHECK(copy.percentile(p) == merged.percentile(p));
+    CHECK(copy.serialize() == data);
+
+    const auto empty = Histogram::Snapshot::deserialize(Histogram::Snapshot{}.serialize());
+    CHECK(empty.empty());
+    CHECK_THROWS_AS(Histogram::Snapshot::deserialize(""), RuntimeException);
+    CHECK_THROWS_AS(Histogram::Snapshot::deserialize(data.substr(0, data.size() - 1) + "\x80"),
+                    RuntimeException);
+    const auto tooLong = std::string{"H\x07\x00\x00\xff\xff\x03", 7};  // a run past the buckets
+    CHECK_THROWS_AS(Histogram::Snapshot::deserialize(tooLong), RuntimeException);
+}
+
+TEST_CASE("Histogram times scopes")
+{
+    auto h = Histogram{};
+    for (int i = 0; i < 10; ++i) {
+        auto timed = Histogram::AutoRecord{h};
+    }
+    CHECK(h.snapshot().count() == 10);
+}
@@ -0,0 +1,144 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Test the run-time dispatched kernels of intutils.h
+// against simple reference implementations on every instruction set.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/intutils.h"
+#include "base/cpu.h"
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+
+namespace {
+/** feature sets to test, from the best to none */
+const uint32_t featureMasks[] = {base_CPU_ALL, base_CPU_ALL & ~(base_CPU_AVX512 | base_CPU_AVX512POPCNT),
+                                 base_CPU_SSE2, 0};
+}  // namespace
+
+TEST_CASE("int vector kernels")
+{
+    auto gen = std::mt19937{std::random_device{}()};
+    auto rnd = std::uniform_int_distribution<uint32_t>{};
+    for (auto mask : featureMasks) {
+        base_setCPUFeatureMask(mask);
+        for (size_t n = 0; n < 300; n += (n < 70 ? 1 : 23)) {
+            // +2 for guards around the data
+            auto data = std::vector<int32_t>(n + 2, 0x5a5a5a5a);
+            const uint32_t value = rnd(gen);
+            base_fill(data.data() + 1, data.data() + 1 + n, value);
+            CHECK(data.front() == 0x5a5a5a5a);
+            CHECK(data.back() == 0x5a5a5a5a);
+            CHECK(base_diff(data.data() + 1, n, value) == 0);
+
+            auto copy = data;
+            CHECK(base_areEqual(data.data() + 1, copy.data() + 1, n));
+            for (size_t i = 1; i <= n; ++i) {
+                const uint32_t bit = 1u << (rnd(gen) % 32);
+                copy[i] ^= bit;
+                CHECK(base_diff(copy.data() + 1, n, value) == bit);
+                CHECK_FALSE(base_areEqual(data.data() + 1, copy.data() + 1, n));
+                copy[i] ^= bit;
+            }
+            // the guards are not compared
+            copy.front() = copy.back() = 0;
+            CHECK(base_areEqual(data.data() + 1, copy.data() + 1, n));
+        }
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+    CHECK(base_areEqual(nullptr, nullptr, 4));
+    int32_t x[4] = {};
+    CHECK_FALSE(base_areEqual(x, nullptr, 4));
+}
+
+TEST_CASE("int vector first difference and compare")
+{
+    auto gen = std::mt19937{std::random_device{}()};
+    auto rnd = std::uniform_int_distribution<int32_t>{-1000, 1000};
+    for (auto mask : featureMasks) {
+        base_setCPUFeatureMask(mask);
+        for (size_t n = 0; n < 300; n += (n < 70 ? 1 : 23)) {
+            auto a = std::vector<int32_t>(n + 1);
+            for (auto& x : a)
+                x = rnd(gen);
+            auto b = a;
+            CHECK(base_firstDifference(a.data(), b.data(), n) == n);
+            CHECK(base_compare(a.data(), b.data(), n) == 0);
+            for (size_t i = 0; i < n; ++i) {
+                b[i] = a[i] + 1;
+                b[(i + n) / 2] = a[(i + n) / 2] - 1;  // later differences do not matter
+                if ((i + n) / 2 == i)
+                    b[i] = a[i] + 1;
+                CHECK(base_firstDifference(a.data(), b.data(), n) == i);
+                CHECK(base_compare(a.data(), b.data(), n) < 0);
+                CHECK(base_compare(b.data(), a.data(), n) > 0);
+                b[i] = INT32_MIN;  // signed order
+                CHECK(base_compare(a.data(), b.data(), n) > 0);
+                b = a;
+            }
+        }
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
+
+namespace {
+relation_t refRelation(const std::vector<int32_t>& a, const std::vector<int32_t>& b)
+{
+    bool le = true, ge = true;
+    for (size_t i = 0; i < a.size(); ++i) {
+        le = le && a[i] <= b[i];
+        ge = ge && a[i] >= b[i];
+    }
+    return (relation_t)((le ? base_SUBSET : 0) | (ge ? base_SUPERSET : 0));
+}
+}  // namespace
+
+TEST_CASE("int vector relations")
+{
+    auto gen = std::mt19937{std::random_device{}()};
+    auto rnd = std::uniform_int_distribution<int32_t>{-1000, 1000};
+    auto pos = std::uniform_int_distribution<size_t>{};
+    for (auto mask : featureMasks) {
+        base_setCPUFeatureMask(mask);
+        for (size_t n = 0; n < 300; n += (n < 70 ? 1 : 23)) {
+            auto a = std::vector<int32_t>(n);
+            for (auto& x : a)
+                x = rnd(gen);
+            // candidates: equal, larger, smaller, one or two changes
+            auto candidates = std::vector<std::vector<int32_t>>(8, a);
+            for (auto& x : candidates[1])
+                x += pos(gen) % 3;
+            for (auto& x : candidates[2])
+                x -= pos(gen) % 3;
+            if (n > 0) {
+                candidates[3][pos(gen) % n] += 1;
+                candidates[4][pos(gen) % n] -= 1;
+                candidates[5][pos(gen) % n] += 1;
+                candidates[5][pos(gen) % n] -= 1;
+                candidates[6][0] -= 1;
+                candidates[6][n - 1] += 1;
+                candidates[7][n - 1] = INT32_MIN;
+            }
+            auto pointers = std::vector<const int32_t*>{};
+            size_t included = 0;
+            for (auto& c : candidates) {
+                auto rel = refRelation(a, c);
+                CHECK(base_relation(a.data(), c.data(), n) == rel);
+                CHECK(base_relation(c.data(), a.data(), n) == base_symRelation(rel));
+                pointers.push_back(c.data());
+                included += (rel & base_SUBSET) != 0;
+            }
+            auto relations = std::vector<relation_t>(candidates.size());
+            CHECK(base_relations(a.data(), pointers.data(), pointers.size(), n, relations.data()) == included);
+            for (size_t k = 0; k < candidates.size(); ++k)
+                CHECK(relations[k] == refRelation(a, candidates[k]));
+        }
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
@@ -0,0 +1,92 @@
+#include "base/ProgressReporter.h"
+#include "base/exceptions.h"
+#include <doctest/doctest.h>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using base::ProgressReporter;
+using namespace std::chrono_literals;
+
+TEST_CASE("ProgressReporter sums the workers")
+{
+    auto reports = std::vector<ProgressReporter::Report>{};
+    auto reporter = ProgressReporter{[&](const auto& r) { reports.push_back(r); }, 0.02};
+    const auto states = reporter.add_counter("states", ProgressReporter::kind_t::count, 400000);
+    const auto waiting = reporter.add_counter("waiting", ProgressReporter::kind_t::level);
+    auto threads = std::vector<std::thread>{};
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&reporter, states, waiting] {
+            auto worker = reporter.worker();
+            const auto stop = std::chrono::steady_clock::now() + 100ms;
+            for (int i = 1; i <= 100000; ++i) {
+                worker.add(states);
+                worker.set(waiting, i % 100);
+                worker.tick();
+                if (i % 1000 == 0 && std::chrono::steady_clock::now() < stop)
+                    std::this_thread::sleep_for(1ms);  // spread over a few periods
+            }
+            worker.set(waiting, 0);
+        });
+    for (auto& t : threads)
+        t.join();
+    reporter.finish();
+    REQUIRE(reports.size() >= 2);
+    for (size_t i = 0; i + 1 < reports.size(); ++i) {
+        CHECK(!reports[i].final);
+        CHECK(reports[i].elapsed < reports[i + 1].elapsed);
+        CHECK(reports[i].counters[states].value <= reports[i + 1].counters[states].value);
+    }
+    const auto& last = reports.back();
+    CHECK(last.final);
+    REQUIRE(last.counters.size() == 2);
+    CHECK(last.counters[states].name == "states");
+    CHECK(last.counters[states].value == 400000);
+    CHECK(last.counters[states].eta == 0);
+    CHECK(last.counters[waiting].value == 0);
+    CHECK(last.counters[waiting].eta < 0);
+    // an intermediate report with a rate has an estimate
+    bool estimated = false;
+    for (const auto& r : reports)
+        if (!r.final && r.counters[states].rate > 0)
+            estimated = estimated || r.counters[states].eta > 0;
+    CHECK(estimated);
+    auto os = std::ostringstream{};
+    os << reports.front();
+    MESSAGE(reports.size() << " reports, first: " << os.str());
+    CHECK(os.str().find(" states ") != std::string::npos);
+    CHECK(os.str().find(" waiting ") != std::string::npos);
+}
+
+TEST_CASE("ProgressReporter reports on demand")
+{
+    auto reports = std::vector<ProgressReporter::Report>{};
+    auto reporter = ProgressReporter{[&](const auto& r) { reports.push_back(r); }, 3600};
+    const auto done = reporter.add_counter("done", ProgressReporter::kind_t::count, 10);
+    auto worker = reporter.worker();
+    for (int i = 0; i < 5; ++i) {
+        worker.add(done);
+        worker.tick();
+    }
+    CHECK(reports.empty());  // the period is long
+    std::this_thread::sleep_for(10ms);
+    reporter.report();
+    REQUIRE(reports.size() == 1);
+    const auto& c = reports[0].counters[done];
+    CHECK(c.value == 5);
+    CHECK(c.rate > 0);
+    CHECK(c.eta > 0);
+    auto os = std::ostringstream{};
+    os << reports[0];
+    CHECK(os.str().find("50%, ETA ") != std::string::npos);
+    reporter.set_total(done, 0);
+    reporter.finish();
+    CHECK(reports.back().counters[done].eta < 0);
+    CHECK_THROWS_AS(ProgressReporter({}, 0), RuntimeException);
+    for (size_t i = 1; i < ProgressReporter::MAX_COUNTERS; ++i)
+        reporter.add_counter("more");
+    CHECK_THROWS_AS(reporter.add_counter("too many"), RuntimeException);
+    CHECK_THROWS_AS(worker.add(ProgressReporter::MAX_COUNTERS), RuntimeException);
+    CHECK_THROWS_AS(worker.set(ProgressReporter::MAX_COUNTERS, 0), RuntimeException);
+}
@@ -1,6 +1,11 @@
 #include "base/random.h"
+#include "base/cpu.h"
+#include "base/random_engines.hpp"
 #include <doctest/doctest.h>
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <vector>
 
 auto rng = RandomGenerator{};
 
@@ -85,4 +90,116 @@ TEST_CASE("uniform floating point")
     CHECK(r < 0);
     r = rng.uni_r(0, std::numeric_limits<double>::max());
     CHECK(r >= 0);
-}
\ No newline at end of file
+}
+TEST_CASE("bulk variates")
+{
+    const size_t n = 1001;  // not a multiple of the vector or chunk sizes
+    auto values = std::vector<double>(n);
+    SUBCASE("uniform")
+    {
+        auto gen = RandomGenerator{5, 1};
+        gen.fill_uni_1(values.data(), n);
+        for (auto v : values) {
+            CHECK(0 <= v);
+            CHECK(v < 1);
+        }
+        // 53 upper bits of two engine outputs
+        auto engine = base::philox4x32{5, 1};
+        for (auto v : values) {
+            const uint64_t lo = engine();
+            const uint64_t w = lo | uint64_t{engine()} << 32;
+            CHECK(v == static_cast<double>(w >> 11) * 0x1.0p-53);
+        }
+    }
+    SUBCASE("exponential")
+    {
+        auto gen = RandomGenerator{5, 1};
+        gen.fill_exp(0.5, values.data(), n);
+        for (auto v : values)
+            CHECK(0 <= v);
+    }
+    SUBCASE("normal")
+    {
+        auto gen = RandomGenerator{5, 1};
+        gen.fill_normal(-3, 2, values.data(), n);
+        auto negative = std::count_if(values.begin(), values.end(), [](double v) { return v < -3; });
+        CHECK(negative > 400);
+        CHECK(negative < 600);
+    }
+}
+
+TEST_CASE("bulk variates do not depend on the kernels")
+{
+    const uint32_t featureMasks[] = {base_CPU_ALL, base_CPU_ALL & ~(base_CPU_AVX512 | base_CPU_AVX512POPCNT),
+                                     base_CPU_SSE2, 0};
+    const size_t n = 100003;
+    const auto generate = [n] {
+        auto res = std::vector<double>(3 * n);
+        auto gen = RandomGenerator{7, 3};
+        gen.fill_uni_1(res.data(), n);
+        gen.fill_exp(2, res.data() + n, n);
+        gen.fill_normal(1, 3, res.data() + 2 * n, n);
+        return res;
+    };
+    base_setCPUFeatureMask(0);
+    const auto expected = generate();
+    for (auto mask : featureMasks) {
+        base_setCPUFeatureMask(mask);
+        CHECK(generate() == expected);
+    }
+    base_setCPUFeatureMask(base_CPU_ALL);
+}
+
+TEST_CASE("bulk variates distribution")
+{
+    // mean and variance within 5 standard errors
+    const size_t n = 1000000;
+    auto values = std::vector<double>(n);
+    const auto check = [&](double mean, double variance, double kurtosis) {
+        double sum = 0, sumsq = 0;
+        for (auto v : values)
+            sum += v;
+        const double m = sum / n;
+        for (auto v : values)
+            sumsq += (v - m) * (v - m);
+        CHECK(std::abs(m - mean) < 5 * std::sqrt(variance / n));
+        // the variance of the sample variance is (kurtosis - 1) * variance^2 / n
+        CHECK(std::abs(sumsq / n - variance) < 5 * variance * std::sqrt((kurtosis - 1) / n));
+    };
+    auto gen = RandomGenerator{11, 0};
+    gen.fill_uni_1(values.data(), n);
+    check(0.5, 1. / 12, 1.8);
+    gen.fill_exp(4, values.data(), n);
+    check(0.25, 1. / 16, 9);
+    gen.fill_normal(10, 3, values.data(), n);
+    check(10, 9, 3);
+    // tails: the probability beyond 4 standard deviations is 6.3e-5
+    auto far = std::count_if(values.begin(), values.end(), [](double v) { return std::abs(v - 10) > 12; });
+    CHECK(far > 30);
+    CHECK(far < 100);
+}
+
+TEST_CASE("parameter-bound distributions")
+{
+    auto a = RandomGenerator{12, 0};
+    auto b = RandomGenerator{12, 0};
+    auto gamma = a.make_gamma(0.5, 2);
+    auto poisson = a.make_poisson(100);
+    auto weibull = a.make_weibull(2, 3);
+    auto beta = a.make_beta(2, 3);
+    auto arcsine = a.make_arcsine(-1, 1);
+    for (auto i = 0; i < 1000; ++i) {
+        // the same values as drawing from another generator of the same stream
+        CHECK(gamma() == b.draw(base::gamma_distribution{0.5, 2}));
+        CHECK(poisson() == b.draw(base::poisson_distribution{100}));
+        CHECK(weibull() == b.draw(base::weibull_distribution{2, 3}));
+        const auto x = beta();
+        CHECK(x == b.draw(base::beta_distribution{2, 3}));
+        CHECK(0 <= x);
+        CHECK(x <= 1);
+        const auto y = arcsine();
+        CHECK(y == b.draw(base::arcsine_distribution{-1, 1}));
+        CHECK(-1 <= y);
+        CHECK(y <= 1);
+    }
+}
@@ -0,0 +1,183 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+
+#include "base/random.h"
+#include "base/random_engines.hpp"
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+using base::philox4x32;
+
+TEST_CASE("Philox known answers")
+{
+    // test vectors of the Random123 reference implementation
+    using block = std::array<uint32_t, 4>;
+    CHECK(philox4x32::generate({0, 0, 0, 0}, {0, 0}) == block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    CHECK(philox4x32::generate({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}) ==
+          block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+    CHECK(philox4x32::generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}) ==
+          block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+}
+
+TEST_CASE("Philox jumps")
+{
+    for (uint64_t n : {0, 1, 3, 4, 5, 17, 1000}) {
+        auto a = philox4x32{7, 3};
+        auto b = a;
+        a();  // start inside a block
+        b();
+        for (uint64_t i = 0; i < n; ++i)
+            a();
+        b.discard(n);
+        CHECK(a.position() == b.position());
+        CHECK(a == b);
+        for (int i = 0; i < 9; ++i)
+            CHECK(a() == b());
+    }
+    // far jumps cross the 32-bit half of the counter
+    auto a = philox4x32{1};
+    a.discard(uint64_t{1} << 36);
+    CHECK(a.position() == uint64_t{1} << 36);
+    auto b = philox4x32{1};
+    b.discard((uint64_t{1} << 36) - 5);
+    for (int i = 0; i < 5; ++i)
+        b();
+    CHECK(a() == b());
+}
+
+TEST_CASE("PCG64 known answers")
+{
+    // pcg64(42, 54) of the reference implementation
+    auto gen = base::pcg64{42, 54};
+    for (uint64_t expected : {0x86b1da1d72062b68ull, 0x1304aa46c9853d39ull, 0xa3670e9e0dd50358ull,
+                              0xf9090e529a7dae00ull, 0xc85b9fd837996f2cull, 0x606121f8e3919196ull})
+        CHECK(gen() == expected);
+    for (uint64_t n : {0, 1, 2, 63, 1000}) {
+        auto a = base::pcg64{3, 1}, b = a;
+        for (uint64_t i = 0; i < n; ++i)
+            a();
+        b.discard(n);
+        CHECK(a == b);
+    }
+}
+
+TEST_CASE("xoshiro256++ streams")
+{
+    auto a = base::xoshiro256pp{1, 0}, b = base::xoshiro256pp{1, 0}, c = base::xoshiro256pp{1, 1};
+    CHECK(a == b);
+    CHECK(a() == b());
+    CHECK(base::xoshiro256pp{1, 0}() != c());
+    a.discard(10);
+    for (int i = 0; i < 10; ++i)
+        b();
+    CHECK(a == b);
+}
+
+TEST_CASE("Random engines")
+{
+    using engine_t = RandomGenerator::engine_t;
+    for (auto engine : {engine_t::philox, engine_t::xoshiro256pp, engine_t::pcg64, engine_t::mt19937}) {
+        INFO("engine " << static_cast<int>(engine));
+        auto a = RandomGenerator{42, 7, engine}, b = RandomGenerator{42, 7, engine};
+        CHECK(a.engine() == engine);
+        CHECK(a.uni(~0u) == b.uni(~0u));
+        auto a1 = a.split(), b1 = b.split();
+        CHECK(a1.engine() == engine);
+        CHECK(a1.uni_1() == b1.uni_1());
+        a.jump(1000);
+        for (int i = 0; i < 1000; ++i)
+            b.jump(1);
+        CHECK(a.uni(~0u) == b.uni(~0u));
+        auto values = std::vector<double>(100);
+        a.fill_normal(0, 1, values.data(), values.size());
+        auto other = values;
+        b.fill_normal(0, 1, other.data(), other.size());
+        CHECK(values == other);
+    }
+    // the legacy engine is seeded with seed + stream
+    auto legacy = RandomGenerator{5000, 489, engine_t::mt19937};
+    auto mt = std::mt19937{5489};
+    for (int i = 0; i < 10; ++i)
+        CHECK(legacy.uni(~0u) == mt());
+
+    RandomGenerator::set_engine(engine_t::pcg64);
+    CHECK(RandomGenerator{}.engine() == engine_t::pcg64);
+    CHECK(RandomGenerator(1, 2).engine() == engine_t::pcg64);
+    RandomGenerator::set_engine(engine_t::philox);
+    CHECK(RandomGenerator{}.engine() == engine_t::philox);
+}
+
+TEST_CASE("Random streams are reproducible")
+{
+    const auto draw = [](RandomGenerator& gen) {
+        auto res = std::vector<uint32_t>(100);
+        for (auto& x : res)
+            x = gen.uni(1000000u);
+        return res;
+    };
+    auto a = RandomGenerator{42, 1}, b = RandomGenerator{42, 1};
+    CHECK(draw(a) == draw(b));
+    auto c = RandomGenerator{42, 2};
+    CHECK(draw(c) != draw(b));
+
+    // splits depend on the parent stream and on the number of splits
+    auto pa = RandomGenerator{42, 5}, pb = RandomGenerator{42, 5};
+    auto a1 = pa.split(), a2 = pa.split();
+    auto b1 = pb.split();
+    CHECK(draw(a1) == draw(b1));
+    CHECK(draw(a2) != draw(b1));
+
+    auto j = RandomGenerator{9, 0}, k = RandomGenerator{9, 0};
+    j.jump(1000);
+    for (int i = 0; i < 1000; ++i)
+        k.uni(~0u);  // one engine output each
+    CHECK(draw(j) == draw(k));
+}
+
+TEST_CASE("Random streams are independent")
+{
+    // correlation of uniform variates between neighbor streams and splits
+    const size_t n = 100000;
+    auto parent = RandomGenerator{1, 0};
+    auto streams = std::vector<RandomGenerator>{};
+    streams.emplace_back(1, 0);
+    streams.emplace_back(1, 1);
+    streams.emplace_back(parent.split());
+    streams.emplace_back(parent.split());
+    auto values = std::vector<std::vector<double>>(streams.size(), std::vector<double>(n));
+    for (size_t s = 0; s < streams.size(); ++s)
+        for (auto& x : values[s])
+            x = streams[s].uni_1() - 0.5;
+    for (size_t s = 0; s < values.size(); ++s) {
+        for (size_t t = s + 1; t < values.size(); ++t) {
+            double cov = 0;
+            for (size_t i = 0; i < n; ++i)
+                cov += values[s][i] * values[t][i];
+            // variance of U(-0.5,0.5) is 1/12, 5 standard errors
+            CHECK(std::abs(cov / n * 12) < 5 / std::sqrt(n));
+        }
+    }
+}
+
+TEST_CASE("Default generators get distinct streams in parallel")
+{
+    RandomGenerator::set_seed(7);
+    const int threads = 8, each = 1000;
+    auto firsts = std::vector<std::vector<uint32_t>>(threads);
+    auto workers = std::vector<std::thread>{};
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&firsts, t] {
+            for (int i = 0; i < each; ++i)
+                firsts[t].push_back(RandomGenerator{}.uni(~0u));
+        });
+    for (auto& w : workers)
+        w.join();
+    auto all = std::set<uint32_t>{};
+    for (auto& f : firsts)
+        all.insert(f.begin(), f.end());
+    CHECK(all.size() == threads * each);  // collisions among 8000 32-bit values are unlikely
+}
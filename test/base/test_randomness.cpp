@@ -1,16 +1,21 @@
 // -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
 
 #include "base/random.h"
+#include "base/fast_random.hpp"
 
 #include <boost/math/distributions/chi_squared.hpp>
+#include <boost/math/distributions/normal.hpp>
 #include <boost/math/distributions/uniform.hpp>
 #include <boost/math/special_functions/beta.hpp>
+#include <boost/math/special_functions/gamma.hpp>
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <limits>
 #include <numeric>
 #include <random>
+#include <type_traits>
 #include <cmath>
 
 static double fracInRange(const std::vector<int>& values, double from, double till)
@@ -106,17 +111,16 @@ static bool frequency_analysis(int n, const std::vector<int>& values, double alp
 }
 
 /** returns true if passed, otherwise false. */
-static bool floating_point_test(int n, int range, int offset, double alpha)
+template <typename Rng>
+static bool floating_point_test(Rng& rand, int n, int range, int offset, double alpha)
 {
     auto values = std::vector<int>(range, 0);
-    auto rand = RandomGenerator{};
-    rand.seed((uint32_t)time(nullptr));
     cout << "_________________________________________" << endl;
     cout << "Random FLOATING POINT number test" << endl;
     cout << "Generating " << (n * range) << " random numbers from a range of " << range << "... ";
     cout.flush();
     for (int i = 0; i < n * range; ++i) {
-        int r = (int)floor(rand.uni(offset, offset + range)) - offset;
+        int r = (int)floor(rand.uni_r(offset, offset + range)) - offset;
         if (r >= 0 && r < range)
             values[r]++;
         else {
@@ -129,11 +133,10 @@ static bool floating_point_test(int n, int range, int offset, double alpha)
 }
 
 /** returns true if passed, otherwise false. */
-static bool integer_test(int n, int range, int offset, double alpha)
+template <typename Rng>
+static bool integer_test(Rng& rand, int n, int range, int offset, double alpha)
 {
     auto values = std::vector<int>(range, 0);
-    auto rand = RandomGenerator{};
-    rand.seed((uint32_t)time(nullptr));
     cout << "_________________________________________" << endl;
     cout << "Random INTEGER test" << endl;
     cout << "Generating " << (n * range) << " random numbers from a range of " << range << "... ";
@@ -181,15 +184,13 @@ std::ostream& operator<<(std::ostream& os, const std::vector<step_t>& fn)
     return os;
 }
 
-template <typename Generator>
-std::vector<step_t> histogram(Generator&& gen, size_t value_count, size_t bar_count = 30,
-                              double min_value = std::numeric_limits<double>::quiet_NaN(),
-                              double max_value = std::numeric_limits<double>::quiet_NaN())
+/** Histogram of values, the values beyond max_value are counted in the last bar. */
+std::vector<step_t> value_histogram(const std::vector<double>& values, size_t bar_count = 30,
+                                    double min_value = std::numeric_limits<double>::quiet_NaN(),
+                                    double max_value = std::numeric_limits<double>::quiet_NaN())
 {
-    if (value_count < 2)
+    if (values.size() < 2)
         throw std::logic_error{"need at least 2 values"};
-    auto values = std::vector<double>(value_count);
-    std::generate(std::begin(values), std::end(values), gen);
     if (std::isnan(min_value))
         min_value = *std::min_element(std::begin(values), std::end(values));
     if (std::isnan(max_value))
@@ -206,41 +207,62 @@ std::vector<step_t> histogram(Generator&& gen, size_t value_count, size_t bar_co
     }
     res.back().till = max_value;
     for (const auto& value : values) {
-        auto i = static_cast<size_t>((value - min_value) * bar_count / range);
-        if (i == bar_count)
-            i = bar_count - 1;
+        if (value < min_value)
+            throw std::logic_error{"value below the histogram"};
+        auto i = std::min(static_cast<size_t>((value - min_value) * bar_count / range), bar_count - 1);
         ++res[i].value;
     }
     return res;
 }
 
+template <typename Generator>
+std::vector<step_t> histogram(Generator&& gen, size_t value_count, size_t bar_count = 30,
+                              double min_value = std::numeric_limits<double>::quiet_NaN(),
+                              double max_value = std::numeric_limits<double>::quiet_NaN())
+{
+    auto values = std::vector<double>(value_count);
+    std::generate(std::begin(values), std::end(values), gen);
+    return value_histogram(values, bar_count, min_value, max_value);
+}
+
 /**
  * Computes the chi-squared statistic based on the expected distribution and compares it with chi-squared distribution.
+ * Neighbor bars are merged until they expect at least 5 values, as the test requires, and the last bar
+ * also expects the values beyond it (see histogram).
  * @tparam CumFn cummulative count function over the hist domain
  * @param hist histogram -- number of values falling into ranges
  * @param expected expected cummulative distribution function
+ * @param total number of values in hist
  * @param alpha the level of significance
  * @return
  */
 template <typename CumFn>
-void chi_squared_test(const std::vector<step_t>& hist, CumFn&& expected, const double alpha = 0.05)
+void chi_squared_test(const std::vector<step_t>& hist, CumFn&& expected, double total, const double alpha = 0.001)
 {
     if (hist.size() < 2)
         throw std::logic_error{"need at least 2 bars"};
     auto chi_sq = 0.;
+    auto bars = 0;
+    auto observe = 0., expect = 0.;
     for (auto& step : hist) {
-        auto observe = static_cast<double>(step.value);
         if (step.till <= step.from)
             throw std::logic_error("step width must be positive");
-        auto expect = expected(step.till) - expected(step.from);
-        if (expect < 0)
+        const auto till = &step == &hist.back() ? total : expected(step.till);
+        const auto e = till - expected(step.from);
+        if (e < 0)
             throw std::logic_error("expected CumFn must be monotonically increasing (PDF cannot be negative)");
-        if (expect == 0 && step.value > 0)
+        if (e == 0 && step.value > 0)
             throw std::logic_error("found data where the expected probability is zero");
-        auto diff = observe - expect;
-        chi_sq += diff * diff / expect;
+        observe += step.value;
+        expect += e;
+        if (expect >= 5 || &step == &hist.back()) {
+            auto diff = observe - expect;
+            chi_sq += expect > 0 ? diff * diff / expect : 0;
+            ++bars;
+            observe = expect = 0;
+        }
     }
-    auto chi_sq_dist = boost::math::chi_squared_distribution<double>{static_cast<double>(hist.size()) - 1};
+    auto chi_sq_dist = boost::math::chi_squared_distribution<double>{static_cast<double>(bars) - 1};
     auto lower_critical_value = quantile(chi_sq_dist, alpha / 2);
     auto upper_critical_value = quantile(chi_sq_dist, 1.0 - alpha / 2);
     if (chi_sq < lower_critical_value)
@@ -258,9 +280,8 @@ std::vector<step_t> normalize(std::vector<step_t> hist)
     return hist;
 }
 
-auto rng = RandomGenerator();
-
-void test_random_uniform(const size_t value_count = 10000, const double alpha = 0.05)
+template <typename Rng>
+void test_random_uniform(Rng& rng, const size_t value_count = 10000, const double alpha = 0.001)
 {
     constexpr auto from = -100.;
     constexpr auto till = 200.;
@@ -268,10 +289,11 @@ void test_random_uniform(const size_t value_count = 10000, const double alpha =
     auto uni_hist = histogram([&]() { return rng.uni_r(from, till); }, value_count, 30, from, till);
     // std::cout << uni_hist;
     auto uni_cum_fn = [&](double x) { return (x - from) / range * value_count; };
-    chi_squared_test(uni_hist, uni_cum_fn, alpha);
+    chi_squared_test(uni_hist, uni_cum_fn, value_count, alpha);
 }
 
-void test_random_triangular(const size_t value_count = 10000, const double alpha = 0.05)
+template <typename Rng>
+void test_random_triangular(Rng& rng, const size_t value_count = 10000, const double alpha = 0.001)
 {
     constexpr auto from = -100.;
     constexpr auto till = 200.;
@@ -285,87 +307,196 @@ void test_random_triangular(const size_t value_count = 10000, const double alpha
         else
             return (1. - (till - x) * (till - x) / range / (till - mode)) * value_count;
     };
-    chi_squared_test(tri_hist, tri_cum_fn, alpha);
+    chi_squared_test(tri_hist, tri_cum_fn, value_count, alpha);
 }
 
-void test_random_exponential(const size_t value_count = 20000, const double alpha = 0.05)
+template <typename Rng>
+void test_random_exponential(Rng& rng, const size_t value_count = 10000, const double alpha = 0.001)
 {
     constexpr auto rate = 0.5;
     auto exp_hist = histogram([&]() { return rng.exp(rate); }, value_count, 30, 0);
     // std::cout << exp_hist;
     auto exp_cum_fn = [&](double x) { return (1.0 - std::exp(-rate * x)) * value_count; };
-    chi_squared_test(exp_hist, exp_cum_fn, alpha);
+    chi_squared_test(exp_hist, exp_cum_fn, value_count, alpha);
 }
 
-void test_random_beta(const size_t value_count = 20000, const double alpha = 0.05)
+template <typename Rng>
+void test_random_beta(Rng& rng, const size_t value_count = 10000, const double alpha = 0.001)
 {
     constexpr auto a = 0.5;
     constexpr auto b = 0.5;
     auto beta_hist = histogram([&]() { return rng.beta(a, b); }, value_count, 30, 0, 1);
     // std::cout << beta_hist;
     auto beta_cum_fn = [&](double x) { return boost::math::ibeta(a, b, x) * value_count; };
-    chi_squared_test(beta_hist, beta_cum_fn, alpha);
+    chi_squared_test(beta_hist, beta_cum_fn, value_count, alpha);
+    chi_squared_test(histogram(rng.make_beta(a, b), value_count, 30, 0, 1), beta_cum_fn, value_count, alpha);
 }
 
-void test_random_gamma(const size_t value_count = 20000, const double alpha = 0.05)
+template <typename Rng>
+void test_random_gamma(Rng& rng, const size_t value_count = 10000, const double alpha = 0.001)
 {
-    constexpr auto shape = 2.;  // k
     constexpr auto scale = 2.;  // theta
-    auto gamma_hist = histogram([&]() { return rng.gamma(shape, scale); }, value_count, 30, 0);
-    std::cout << gamma_hist;
-    auto gamma_cum_fn = [&](double x) { return value_count; };
-    chi_squared_test(gamma_hist, gamma_cum_fn, alpha);
-}
-
-void test_random_poisson(const size_t value_count = 20000, const double alpha = 0.05)
-{
-    constexpr auto rate = 0.5;
-    auto poisson_hist = histogram([&]() { return rng.poisson(1. / rate); }, value_count, 30, 0);
-    // std::cout << exp_hist;
-    auto poisson_cum_fn = [&](double x) { return value_count; };
-    chi_squared_test(poisson_hist, poisson_cum_fn, alpha);
+    for (auto shape : {0.5, 2.}) {  // k, below 1 base::gamma_distribution boosts the shape
+        auto gamma_hist = histogram([&]() { return rng.gamma(shape, scale); }, value_count, 30, 0);
+        // std::cout << gamma_hist;
+        auto gamma_cum_fn = [&](double x) { return boost::math::gamma_p(shape, x / scale) * value_count; };
+        chi_squared_test(gamma_hist, gamma_cum_fn, value_count, alpha);
+        gamma_hist = histogram(rng.make_gamma(shape, scale), value_count, 30, 0);
+        chi_squared_test(gamma_hist, gamma_cum_fn, value_count, alpha);
+    }
 }
 
-void test_random_arcsine(const size_t value_count = 20000, const double alpha = 0.05)
+template <typename Rng>
+void test_random_arcsine(Rng& rng, const size_t value_count = 10000, const double alpha = 0.001)
 {
     constexpr auto from = -100.;
     constexpr auto till = 200.;
     constexpr auto range = till - from;
     auto arcsine_hist = histogram([&]() { return rng.arcsine(from, till); }, value_count, 30, from, till);
     // std::cout << arcsine_hist;
-    auto arcsine_cum_fn = [&](double x) { return 2. / M_PI * std::asin(std::sqrt(x)) * value_count; };
-    chi_squared_test(arcsine_hist, arcsine_cum_fn, alpha);
+    auto arcsine_cum_fn = [&](double x) { return 2. / M_PI * std::asin(std::sqrt((x - from) / range)) * value_count; };
+    chi_squared_test(arcsine_hist, arcsine_cum_fn, value_count, alpha);
+    arcsine_hist = histogram(rng.make_arcsine(from, till), value_count, 30, from, till);
+    chi_squared_test(arcsine_hist, arcsine_cum_fn, value_count, alpha);
 }
 
-void test_random_weibull(const size_t value_count = 20000, const double alpha = 0.05)
+template <typename Rng>
+void test_random_weibull(Rng& rng, const size_t value_count = 10000, const double alpha = 0.001)
 {
     constexpr auto shape = 1.5;  // k
     constexpr auto scale = 1.;   // lambda
     auto weibull_hist = histogram([&]() { return rng.weibull(shape, scale); }, value_count, 30, 0);
     // std::cout << weibull_hist;
     auto weibull_cum_fn = [&](double x) { return (1. - std::exp(-std::pow(x / scale, shape))) * value_count; };
-    chi_squared_test(weibull_hist, weibull_cum_fn, alpha);
+    chi_squared_test(weibull_hist, weibull_cum_fn, value_count, alpha);
+    weibull_hist = histogram(rng.make_weibull(shape, scale), value_count, 30, 0);
+    chi_squared_test(weibull_hist, weibull_cum_fn, value_count, alpha);
 }
 
-int main(const int, const char*[])
+template <typename Rng>
+void test_random_normal(Rng& rng, const size_t value_count = 10000, const double alpha = 0.001)
 {
-    test_random_uniform();
-    test_random_triangular();
-    test_random_exponential();
-    test_random_beta();
-    test_random_arcsine();
-    test_random_weibull();
-    const int n = 30000;
+    constexpr auto mean = 10.;
+    constexpr auto stddev = 3.;
+    auto normal_hist = histogram([&]() { return rng.normal(mean, stddev); }, value_count, 60, mean - 9 * stddev,
+                                 mean + 9 * stddev);
+    auto dist = boost::math::normal{mean, stddev};  // below 9 standard deviations with probability 1e-19
+    auto normal_cum_fn = [&](double x) { return cdf(dist, x) * value_count; };
+    chi_squared_test(normal_hist, normal_cum_fn, value_count, alpha);
+}
+
+template <typename Rng>
+void test_random_poisson(Rng& rng, const size_t value_count = 10000, const double alpha = 0.001)
+{
+    for (auto mean : {4., 40.}) {  // both methods of base::poisson_distribution
+        auto poisson_hist = histogram([&]() { return rng.poisson(mean); }, value_count, 4 * mean, -0.5, 4 * mean - 0.5);
+        // the bars are centered on the integers, P(X <= k) = Q(k+1, mean)
+        auto poisson_cum_fn = [&](double x) {
+            return x < 0 ? 0. : boost::math::gamma_q(std::floor(x) + 1, mean) * value_count;
+        };
+        chi_squared_test(poisson_hist, poisson_cum_fn, value_count, alpha);
+        poisson_hist = histogram(rng.make_poisson(mean), value_count, 4 * mean, -0.5, 4 * mean - 0.5);
+        chi_squared_test(poisson_hist, poisson_cum_fn, value_count, alpha);
+    }
+}
+
+/** the bulk variates with more values, as they are meant for many */
+template <typename Rng>
+void test_random_fill(Rng& rng, const size_t value_count = 100000, const double alpha = 0.001)
+{
+    auto values = std::vector<double>(value_count);
+    rng.fill_uni_1(values.data(), value_count);
+    chi_squared_test(value_histogram(values, 100, 0, 1), [&](double x) { return x * value_count; }, value_count, alpha);
+
+    constexpr auto rate = 0.5;
+    rng.fill_exp(rate, values.data(), value_count);
+    chi_squared_test(
+        value_histogram(values, 100, 0, 20 / rate),
+        [&](double x) { return (1.0 - std::exp(-rate * x)) * value_count; }, value_count, alpha);
+
+    constexpr auto mean = -1.;
+    constexpr auto stddev = 2.;
+    rng.fill_normal(mean, stddev, values.data(), value_count);
+    // the tails of the Ziggurat start beyond 3.65 standard deviations
+    auto dist = boost::math::normal{mean, stddev};
+    auto lowest = *std::min_element(values.begin(), values.end());
+    auto below = cdf(dist, lowest) * value_count;
+    chi_squared_test(
+        value_histogram(values, 100, lowest, mean + 6 * stddev),
+        [&](double x) { return cdf(dist, x) * value_count - below; }, value_count - below, alpha);
+}
+
+static const char* engine_name(RandomGenerator::engine_t engine)
+{
+    switch (engine) {
+    case RandomGenerator::engine_t::philox: return "philox";
+    case RandomGenerator::engine_t::xoshiro256pp: return "xoshiro256++";
+    case RandomGenerator::engine_t::pcg64: return "pcg64";
+    case RandomGenerator::engine_t::mt19937: return "mt19937";
+    }
+    return "unknown";
+}
+
+/** runs test(rng) and reports its failure */
+template <typename Test, typename Rng>
+static bool run_test(const char* name, Test&& test, Rng& rng)
+{
+    try {
+        test(rng);
+        return true;
+    } catch (const std::logic_error& e) {
+        cout << name << " failed: " << e.what() << endl;
+        return false;
+    }
+}
+
+/** @return true if all the tests passed with rng */
+template <typename Rng>
+static bool run_tests(Rng& rng)
+{
+    auto passed = true;
+    passed = run_test("uniform", [](auto& rng) { test_random_uniform(rng); }, rng) && passed;
+    passed = run_test("triangular", [](auto& rng) { test_random_triangular(rng); }, rng) && passed;
+    passed = run_test("exponential", [](auto& rng) { test_random_exponential(rng); }, rng) && passed;
+    passed = run_test("beta", [](auto& rng) { test_random_beta(rng); }, rng) && passed;
+    passed = run_test("gamma", [](auto& rng) { test_random_gamma(rng); }, rng) && passed;
+    passed = run_test("arcsine", [](auto& rng) { test_random_arcsine(rng); }, rng) && passed;
+    passed = run_test("weibull", [](auto& rng) { test_random_weibull(rng); }, rng) && passed;
+    passed = run_test("normal", [](auto& rng) { test_random_normal(rng); }, rng) && passed;
+    passed = run_test("poisson", [](auto& rng) { test_random_poisson(rng); }, rng) && passed;
+    if constexpr (std::is_same_v<Rng, RandomGenerator>)
+        passed = run_test("bulk", [](auto& rng) { test_random_fill(rng); }, rng) && passed;
+    const int n = 50;  // per value, small enough for the sanitizer builds
     const int range = 2000;
     const int offset = 5000;
-    const double alpha = 0.01;  // level of significance (probability of failure)
-    if (integer_test(n, range, offset, alpha)) {
-        if (floating_point_test(n, range, offset, alpha)) {
-            return 0;
-        } else {
-            return 1;
-        }
-    } else {
-        return 1;
+    const double alpha = 0.001;  // level of significance (probability of failure)
+    passed = integer_test(rng, n, range, offset, alpha) && passed;
+    passed = floating_point_test(rng, n, range, offset, alpha) && passed;
+    return passed;
+}
+
+template <typename Engine>
+static bool run_fast_tests(const char* name)
+{
+    cout << "=========================================" << endl;
+    cout << "FastRandom " << name << endl;
+    auto rng = base::FastRandom<Engine>{2026, 1};
+    return run_tests(rng);
+}
+
+int main(const int, const char*[])
+{
+    using engine_t = RandomGenerator::engine_t;
+    auto passed = true;
+    for (auto engine : {engine_t::philox, engine_t::xoshiro256pp, engine_t::pcg64, engine_t::mt19937}) {
+        cout << "=========================================" << endl;
+        cout << "Engine " << engine_name(engine) << endl;
+        // fixed seed for reproducible results, the significance accounts for the number of tests
+        auto rng = RandomGenerator{2026, 0, engine};
+        passed = run_tests(rng) && passed;
     }
+    passed = run_fast_tests<base::philox4x32>("philox") && passed;
+    passed = run_fast_tests<base::xoshiro256pp>("xoshiro256++") && passed;
+    passed = run_fast_tests<base::pcg64>("pcg64") && passed;
+    return passed ? 0 : 1;
 }
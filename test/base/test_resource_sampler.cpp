@@ -0,0 +1,61 @@
+#include "base/ResourceSampler.h"
+#include "base/exceptions.h"
+#include <doctest/doctest.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+using base::ResourceSampler;
+using namespace std::chrono_literals;
+
+TEST_CASE("ResourceSampler samples in the background")
+{
+    auto sampler = ResourceSampler{5ms, 8};
+    CHECK(sampler.count() == 1);
+    const auto first = sampler.latest();
+    CHECK(first.mem_virt >= first.mem_work);
+    CHECK(first.mem_work > 0);
+    std::this_thread::sleep_for(100ms);
+    CHECK(sampler.count() >= 5);
+    const auto series = sampler.series();
+    CHECK(series.size() == 8);  // the capacity
+    for (size_t i = 1; i < series.size(); ++i) {
+        CHECK(series[i - 1].time < series[i].time);
+        CHECK(series[i - 1].time_user <= series[i].time_user);
+    }
+    CHECK(series.back().time <= sampler.latest().time);
+    const auto recent = sampler.series(series[5].time);
+    CHECK(!recent.empty());
+    for (const auto& s : recent)
+        CHECK(s.time >= series[5].time);
+    CHECK(sampler.series(ResourceSampler::clock::now() + 1h).empty());
+}
+
+TEST_CASE("ResourceSampler catches the peaks between polls")
+{
+    auto sampler = ResourceSampler{2ms};
+    const auto before = sampler.peak().mem_work;
+    {
+        constexpr size_t size = 64 << 20;
+        auto block = std::make_unique<char[]>(size);
+        std::memset(block.get(), 1, size);  // touch the pages
+        std::this_thread::sleep_for(50ms);
+        CHECK(block[size / 2] == 1);
+    }
+    std::this_thread::sleep_for(20ms);
+    const auto peak = sampler.peak();
+    MESSAGE("working set " << before << " kB, peak " << peak.mem_work << " kB, now " << sampler.latest().mem_work
+                           << " kB, " << sampler.count() << " samples");
+    CHECK(peak.mem_work >= before + (48 << 10));
+    CHECK(peak.mem_virt >= peak.mem_work);
+#ifndef __SANITIZE_ADDRESS__  // which keeps the freed block in quarantine
+    CHECK(sampler.latest().mem_work < peak.mem_work);
+#endif
+}
+
+TEST_CASE("ResourceSampler checks the arguments")
+{
+    CHECK_THROWS_AS(ResourceSampler(0ms), RuntimeException);
+    CHECK_THROWS_AS(ResourceSampler(1ms, 0), RuntimeException);
+}
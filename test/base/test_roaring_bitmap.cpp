@@ -0,0 +1,272 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+////////////////////////////////////////////////////////////////////
+//
+// Test base::RoaringBitmap against std::set.
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2026, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////
+
+#include "base/RoaringBitmap.h"
+#include "base/bitstring.h"
+#include <doctest/doctest.h>
+#include <cstring>
+#include <random>
+#include <set>
+#include <type_traits>
+#include <vector>
+
+using base::RoaringBitmap;
+
+namespace {
+/** visitors writing and reading scalars as raw bytes */
+struct binary_writer
+{
+    std::vector<uint8_t> bytes;
+    template <typename T>
+    void visit(const T& data)
+    {
+        if constexpr (std::is_arithmetic_v<T>) {
+            auto* p = reinterpret_cast<const uint8_t*>(&data);
+            bytes.insert(bytes.end(), p, p + sizeof(T));
+        } else {
+            visitor::accepts_writer<T, binary_writer>::accept(data, *this);
+        }
+    }
+};
+
+struct binary_reader
+{
+    const std::vector<uint8_t>& bytes;
+    size_t pos{0};
+    template <typename T>
+    void visit(T& data)
+    {
+        if constexpr (std::is_arithmetic_v<T>) {
+            REQUIRE(pos + sizeof(T) <= bytes.size());
+            std::memcpy(&data, bytes.data() + pos, sizeof(T));
+            pos += sizeof(T);
+        } else {
+            visitor::accepts_reader<T, binary_reader>::accept(data, *this);
+        }
+    }
+};
+}  // namespace
+
+template <>
+struct visitor::is_visitor<binary_writer> : std::true_type
+{};
+template <>
+struct visitor::is_visitor<binary_reader> : std::true_type
+{};
+
+namespace {
+auto gen = std::mt19937{std::random_device{}()};
+
+/** values clustered in a few containers with different densities */
+std::set<uint32_t> randomSet(size_t count)
+{
+    auto key = std::uniform_int_distribution<uint32_t>{0, 7};
+    auto low = std::uniform_int_distribution<uint32_t>{0, 0xffff};
+    auto res = std::set<uint32_t>{};
+    for (size_t i = 0; i < count; ++i) {
+        auto k = key(gen);
+        res.insert((k << 16) | (low(gen) >> k));  // lower keys are sparser
+    }
+    return res;
+}
+
+RoaringBitmap toRoaring(const std::set<uint32_t>& values)
+{
+    auto res = RoaringBitmap{};
+    for (auto x : values)
+        res.add(x);
+    return res;
+}
+
+std::set<uint32_t> toSet(const RoaringBitmap& bitmap)
+{
+    auto res = std::set<uint32_t>{};
+    bitmap.forEach([&](uint32_t x) { res.insert(x); });
+    return res;
+}
+}  // namespace
+
+TEST_CASE("RoaringBitmap add, remove and contains")
+{
+    for (auto count : {0, 10, 3000, 20000, 100000}) {
+        auto ref = randomSet(count);
+        auto bitmap = toRoaring(ref);
+        CHECK(bitmap.cardinality() == ref.size());
+        CHECK(toSet(bitmap) == ref);
+        for (auto x : ref)
+            CHECK(bitmap.contains(x));
+        if (!ref.empty())
+            CHECK_FALSE(bitmap.add(*ref.begin()));
+        // removing most values converts bitmaps back to arrays
+        size_t i = 0;
+        for (auto it = ref.begin(); it != ref.end(); ++i) {
+            if (i % 8 != 0) {
+                CHECK(bitmap.remove(*it));
+                CHECK_FALSE(bitmap.contains(*it));
+                it = ref.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        CHECK(toSet(bitmap) == ref);
+        CHECK(bitmap == toRoaring(ref));
+    }
+}
+
+TEST_CASE("RoaringBitmap ranges and runs")
+{
+    auto bitmap = RoaringBitmap{};
+    bitmap.addRange(100, 200'000);
+    bitmap.addRange(300'000, 300'010);
+    bitmap.add(5);
+    CHECK(bitmap.cardinality() == 199'901 + 11 + 1);
+    auto ref = toSet(bitmap);
+    auto before = bitmap.memoryUsage();
+    CHECK(bitmap.runOptimize() > 0);
+    CHECK(bitmap.memoryUsage() < before);
+    CHECK(toSet(bitmap) == ref);
+    CHECK(bitmap.contains(100));
+    CHECK(bitmap.contains(200'000));
+    CHECK_FALSE(bitmap.contains(200'001));
+    CHECK_FALSE(bitmap.contains(99));
+
+    // updates on runs
+    CHECK(bitmap.remove(150'000));
+    CHECK(bitmap.add(250'000));
+    ref.erase(150'000);
+    ref.insert(250'000);
+    CHECK(toSet(bitmap) == ref);
+}
+
+TEST_CASE("RoaringBitmap union and intersection")
+{
+    for (auto count : {0, 100, 5000, 60000}) {
+        auto ra = randomSet(count);
+        auto rb = randomSet(count / 2 + 1);
+        auto runs = RoaringBitmap{};
+        runs.addRange(1000, 70000);
+        runs.addRange(200'000, 201'000);
+        runs.runOptimize();
+        auto rr = toSet(runs);
+        for (bool optimize : {false, true}) {
+            auto a = toRoaring(ra), b = toRoaring(rb);
+            if (optimize) {
+                a.runOptimize();
+                b.runOptimize();
+            }
+            auto ru = ra, ri = std::set<uint32_t>{};
+            ru.insert(rb.begin(), rb.end());
+            for (auto x : ra)
+                if (rb.count(x))
+                    ri.insert(x);
+            auto u = a;
+            u |= b;
+            CHECK(toSet(u) == ru);
+            CHECK(u.cardinality() == ru.size());
+            auto i = a;
+            i &= b;
+            CHECK(toSet(i) == ri);
+            CHECK(i.cardinality() == ri.size());
+
+            auto ur = a;
+            ur |= runs;
+            auto rur = ra;
+            rur.insert(rr.begin(), rr.end());
+            CHECK(toSet(ur) == rur);
+            auto ir = a;
+            ir &= runs;
+            auto rir = std::set<uint32_t>{};
+            for (auto x : ra)
+                if (rr.count(x))
+                    rir.insert(x);
+            CHECK(toSet(ir) == rir);
+            auto rr2 = runs;
+            rr2 &= runs;
+            CHECK(rr2 == runs);
+        }
+    }
+}
+
+TEST_CASE("RoaringBitmap bit strings and serialization")
+{
+    auto ref = randomSet(40000);
+    auto bitmap = toRoaring(ref);
+    bitmap.addRange(9 << 16, (9 << 16) + 5000);
+    bitmap.runOptimize();
+    ref = toSet(bitmap);
+
+    const size_t n = (10 << 16) / 32;
+    auto bits = std::vector<uint32_t>(n);
+    bitmap.toBits(bits.data(), n);
+    CHECK(base_countBitsN(bits.data(), n) == ref.size());
+    for (auto x : ref)
+        CHECK(base_getOneBit(bits.data(), x));
+    CHECK(RoaringBitmap::fromBits(bits.data(), n) == bitmap);
+
+    using visitor::operator<<;
+    using visitor::operator>>;
+    auto writer = binary_writer{};
+    writer << bitmap;
+    auto reader = binary_reader{writer.bytes};
+    auto copy = RoaringBitmap{};
+    reader >> copy;
+    CHECK(reader.pos == writer.bytes.size());
+    CHECK(copy == bitmap);
+    CHECK(toSet(copy) == ref);
+
+    writer.bytes[4 + 2] = 7;  // kind of the first container
+    auto bad = binary_reader{writer.bytes};
+    CHECK_THROWS_AS(bad >> copy, RuntimeException);
+}
+
+TEST_CASE("RoaringBitmap rejects malformed data and stays usable")
+{
+    using visitor::operator>>;
+    // one container of key 1 with the given kind, size and elements
+    auto container = [](uint8_t kind, uint32_t size, const std::vector<uint16_t>& elements) {
+        auto writer = binary_writer{};
+        writer.visit(uint32_t{1});
+        writer.visit(uint16_t{1});
+        writer.visit(kind);
+        writer.visit(size);
+        for (auto e : elements)
+            writer.visit(e);
+        return writer.bytes;
+    };
+    auto sparseBitmap = std::vector<uint16_t>(RoaringBitmap::CONTAINER_BITS / 16);  // as 64-bit words
+    for (size_t i = 0; i < 4000; ++i)
+        sparseBitmap[i / 16] |= uint16_t(1u << (i % 16));
+    const auto malformed = std::vector<std::vector<uint8_t>>{
+        container(0, 3, {1, 5, 5}),  // array duplicate
+        container(0, 3, {1, 7, 5}),  // array unsorted
+        container(1, 1024, std::vector<uint16_t>(4096)),  // bitmap empty
+        container(1, 1024, sparseBitmap),  // bitmap of an array size
+        container(2, 2, {10, 20, 15, 30}),  // runs overlap
+        container(2, 2, {40, 50, 10, 20}),  // runs unsorted
+        container(2, 1, {20, 10}),  // run reversed
+        container(7, 1, {0}),  // bad kind
+        {2, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 3, 0, 1, 0, 0, 1, 0, 0, 0, 3, 0},  // keys unsorted
+    };
+    for (const auto& bytes : malformed) {
+        auto bitmap = RoaringBitmap{};
+        for (uint32_t x = 0; x < 5 << 16; x += 7)
+            bitmap.add(x);
+        const auto before = toSet(bitmap);
+        auto reader = binary_reader{bytes};
+        CHECK_THROWS_AS(reader >> bitmap, RuntimeException);
+        CHECK(toSet(bitmap) == before);
+        CHECK(bitmap.contains(7 << 16 | 1) == false);
+        CHECK(bitmap.contains(7 * 40000));
+        CHECK(bitmap.add(9 << 16));
+        CHECK(bitmap.remove(7));
+        CHECK(bitmap.cardinality() == before.size());
+    }
+}
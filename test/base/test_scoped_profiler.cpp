@@ -0,0 +1,147 @@
+#include "base/ScopedProfiler.h"
+#include <doctest/doctest.h>
+#include <chrono>
+#include <latch>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using base::ScopedProfiler;
+using namespace std::chrono_literals;
+
+static const ScopedProfiler::Report* find(const ScopedProfiler::Report& node, const std::string& name)
+{
+    for (const auto& child : node.children)
+        if (child.name == name)
+            return &child;
+    return nullptr;
+}
+
+static void leaf() { BASE_PROFILE_ZONE("leaf"); }
+
+static void work(int depth)
+{
+    BASE_PROFILE_ZONE("work");
+    leaf();
+    if (depth > 0)
+        work(depth - 1);
+}
+
+static void sleepy()
+{
+    BASE_PROFILE_ZONE("sleepy");
+    std::this_thread::sleep_for(10ms);
+    {
+        BASE_PROFILE_ZONE("inner");
+        std::this_thread::sleep_for(20ms);
+    }
+}
+
+TEST_CASE("ScopedProfiler counts the calls of the zones")
+{
+    ScopedProfiler::reset();
+    for (int i = 0; i < 10; ++i)
+        work(2);
+    const auto all = ScopedProfiler::report();
+    const auto* w = find(all, "work");
+    REQUIRE(w != nullptr);
+    CHECK(w->calls == 10);
+    REQUIRE(find(*w, "leaf") != nullptr);
+    CHECK(find(*w, "leaf")->calls == 10);
+    // recursion makes deeper nodes
+    const auto* w2 = find(*w, "work");
+    REQUIRE(w2 != nullptr);
+    CHECK(w2->calls == 10);
+    REQUIRE(find(*w2, "work") != nullptr);
+    CHECK(find(*w2, "work")->calls == 10);
+    CHECK(find(*find(*w2, "work"), "work") == nullptr);
+    CHECK(w->inclusive >= w2->inclusive);
+    CHECK(w->exclusive <= w->inclusive);
+}
+
+TEST_CASE("ScopedProfiler measures inclusive and exclusive time")
+{
+    ScopedProfiler::reset();
+    sleepy();
+    const auto all = ScopedProfiler::report();
+    const auto* s = find(all, "sleepy");
+    REQUIRE(s != nullptr);
+    const auto* inner = find(*s, "inner");
+    REQUIRE(inner != nullptr);
+    CHECK(s->calls == 1);
+    CHECK(s->inclusive >= 0.029);
+    CHECK(s->exclusive >= 0.009);
+    CHECK(s->exclusive < s->inclusive - 0.019);
+    CHECK(inner->inclusive >= 0.019);
+    CHECK(inner->exclusive == inner->inclusive);
+    CHECK(all.inclusive >= s->inclusive);
+}
+
+TEST_CASE("ScopedProfiler merges the threads")
+{
+    ScopedProfiler::reset();
+    auto threads = std::vector<std::thread>{};
+    auto running = std::latch{3};  // at the same time, each with its own tree
+    for (int t = 0; t < 3; ++t)
+        threads.emplace_back([&running] {
+            for (int i = 0; i < 5; ++i)
+                work(0);
+            running.arrive_and_wait();
+        });
+    for (auto& t : threads)
+        t.join();
+    work(0);
+    const auto all = ScopedProfiler::report();
+    REQUIRE(find(all, "work") != nullptr);
+    CHECK(find(all, "work")->calls == 16);
+    CHECK(find(*find(all, "work"), "leaf")->calls == 16);
+    size_t withWork = 0;
+    for (const auto& thread : ScopedProfiler::threadReports())
+        if (const auto* w = find(thread, "work"); w && w->calls > 0)
+            ++withWork;
+    CHECK(withWork == 4);
+}
+
+TEST_CASE("ScopedProfiler reuses the trees of the finished threads")
+{
+    ScopedProfiler::reset();
+    auto run = [] {
+        auto other = std::thread{[] { work(1); }};
+        other.join();
+    };
+    run();
+    const auto nbTrees = ScopedProfiler::threadReports().size();
+    for (int i = 0; i < 20; ++i)
+        run();
+    CHECK(ScopedProfiler::threadReports().size() == nbTrees);
+    const auto all = ScopedProfiler::report();
+    REQUIRE(find(all, "work") != nullptr);
+    CHECK(find(all, "work")->calls == 21);
+    REQUIRE(find(*find(all, "work"), "work") != nullptr);
+    CHECK(find(*find(all, "work"), "work")->calls == 21);
+}
+
+TEST_CASE("ScopedProfiler exports")
+{
+    ScopedProfiler::reset();
+    sleepy();
+    auto tree = std::ostringstream{};
+    ScopedProfiler::writeTree(tree);
+    CHECK(tree.str().find("  sleepy\n") != std::string::npos);
+    CHECK(tree.str().find("    inner\n") != std::string::npos);
+
+    auto folded = std::ostringstream{};
+    ScopedProfiler::writeFolded(folded);
+    CHECK(folded.str().find("sleepy ") != std::string::npos);
+    CHECK(folded.str().find("sleepy;inner ") != std::string::npos);
+    CHECK(folded.str().find("work") == std::string::npos);  // no time since reset
+
+    auto trace = std::ostringstream{};
+    ScopedProfiler::writeChromeTrace(trace);
+    const auto json = trace.str();
+    CHECK(json.rfind("{\"traceEvents\":[", 0) == 0);
+    CHECK(json.find("{\"name\":\"inner\",\"ph\":\"X\"") != std::string::npos);
+    CHECK(json.find("\"ph\":\"M\"") != std::string::npos);
+    CHECK(json.find("\"displayTimeUnit\":\"ns\"}") != std::string::npos);
+    MESSAGE(folded.str());
+}
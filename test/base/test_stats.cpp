@@ -0,0 +1,80 @@
+#define SHOW_STATS
+#include "base/stats.h"
+#include <doctest/doctest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using base::stats;
+
+static void visit(int i)
+{
+    RECORD_STAT();
+    if (i % 4 == 0)
+        RECORD_SUBSTAT("quarter");
+    if (i % 2 == 0)
+        RECORD_SUBSTAT("half");
+}
+
+static const char* const visitName = "void visit(int)";
+
+TEST_CASE("Stats counts per site")
+{
+    const auto before = stats.get(visitName);
+    const auto beforeHalf = stats.get(visitName, "half");
+    for (int i = 0; i < 100; ++i)
+        visit(i);
+    CHECK(stats.get(visitName) - before == 100);
+    CHECK(stats.get(visitName, "half") - beforeHalf == 50);
+    CHECK(stats.get("no such stat") == 0);
+    CHECK(stats.get(visitName, "no such sub-stat") == 0);
+}
+
+TEST_CASE("Stats sums the threads")
+{
+    const auto before = stats.get(visitName);
+    const auto beforeQuarter = stats.get(visitName, "quarter");
+    auto threads = std::vector<std::thread>{};
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([] {
+            for (int i = 0; i < 10000; ++i)
+                visit(i);
+        });
+    for (auto& t : threads)
+        t.join();
+    CHECK(stats.get(visitName) - before == 40000);
+    CHECK(stats.get(visitName, "quarter") - beforeQuarter == 10000);
+}
+
+TEST_CASE("Stats keeps the counts of the finished threads")
+{
+    const auto before = stats.get(visitName);
+    const auto beforeHalf = stats.get(visitName, "half");
+    for (int t = 0; t < 50; ++t) {
+        auto other = std::thread{[] {
+            for (int i = 0; i < 100; ++i)
+                visit(i);
+        }};
+        other.join();  // the next thread continues its slots
+    }
+    CHECK(stats.get(visitName) - before == 5000);
+    CHECK(stats.get(visitName, "half") - beforeHalf == 2500);
+}
+
+TEST_CASE("Stats by name and printing")
+{
+    for (int i = 0; i < 8; ++i)
+        RECORD_NSTAT("printed", i % 2 ? "odd" : "even");  // the names vary at the site
+    stats.count("printed", "dynamic");
+    CHECK(stats.get("printed") == 8);
+    CHECK(stats.get("printed", "even") == 4);
+    CHECK(stats.get("printed", "odd") == 4);
+    CHECK(stats.get("printed", "dynamic") == 1);
+    auto os = std::ostringstream{};
+    stats.print(os);
+    const auto text = os.str();
+    CHECK(text.find("printed") != std::string::npos);
+    CHECK(text.find("dynamic") != std::string::npos);
+    CHECK(text.find("void visit(int)") != std::string::npos);
+}
@@ -0,0 +1,68 @@
+// Heap sampling of the new monitor: built with ENABLE_MONITOR and run with DEBUG_NEW_SAMPLE set.
+#include "debug/monitor.h"
+#include <doctest/doctest.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <dlfcn.h>
+
+using blocks_t = std::vector<std::unique_ptr<char[]>>;
+
+// the allocation sites, exported for dladdr
+
+[[gnu::noinline]] void allocate_site(blocks_t& blocks, size_t n, size_t size)
+{
+    for (size_t i = 0; i < n; ++i)
+        blocks.emplace_back(new char[size]);
+}
+
+[[gnu::noinline]] void allocate_elsewhere(blocks_t& blocks, size_t n, size_t size)
+{
+    for (size_t i = 0; i < n; ++i)
+        blocks.emplace_back(new char[size]);
+}
+
+namespace {
+/** @return whether the address is in the code of the function */
+bool within(uintptr_t address, void (*function)(blocks_t&, size_t, size_t))
+{
+    auto info = Dl_info{};
+    return dladdr(reinterpret_cast<void*>(address), &info) != 0 &&
+           info.dli_saddr == reinterpret_cast<void*>(function);
+}
+}  // namespace
+
+TEST_CASE("heap profile attributes the sampled bytes to their site")
+{
+    auto blocks = blocks_t{};
+    blocks.reserve(5000);
+    allocate_site(blocks, 4096, 4096);       // 16MiB
+    allocate_elsewhere(blocks, 512, 4096);   // 2MiB
+    auto file = std::unique_ptr<FILE, int (*)(FILE*)>{tmpfile(), &fclose};
+    REQUIRE(file);
+    REQUIRE(debug_writeHeapProfile(file.get()) == 1);  // DEBUG_NEW_SAMPLE is set
+    rewind(file.get());
+
+    size_t total = 0, site = 0, elsewhere = 0;
+    char line[4096];
+    REQUIRE(fgets(line, sizeof(line), file.get()) != nullptr);
+    CHECK(strstr(line, "@ heap_v2/") != nullptr);
+    while (fgets(line, sizeof(line), file.get()) && line[0] != '\n') {
+        size_t count, bytes;
+        uintptr_t caller;
+        REQUIRE(sscanf(line, "%zu: %zu [%*u: %*u] @ %" SCNxPTR, &count, &bytes, &caller) == 3);
+        total += bytes;
+        if (within(caller, &allocate_site))
+            site += bytes;
+        else if (within(caller, &allocate_elsewhere))
+            elsewhere += bytes;
+    }
+    REQUIRE(fgets(line, sizeof(line), file.get()) != nullptr);
+    CHECK(strncmp(line, "MAPPED_LIBRARIES:", 17) == 0);
+    // about 4096 samples of the site, 512 elsewhere, and few of the rest
+    CHECK(site > total * 3 / 4);
+    CHECK(elsewhere > 0);
+    CHECK(elsewhere < site / 4);
+}
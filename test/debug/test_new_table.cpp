@@ -0,0 +1,71 @@
+// Exact new monitor: built with ENABLE_MONITOR and run without DEBUG_NEW_SAMPLE.
+#include "debug/monitor.h"
+#include <doctest/doctest.h>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int nbThreads = 8;
+
+/** Allocate and delete blocks of random sizes, marking the deletes with the pushed position.
+ * @return the bytes left allocated: the blocks of the last round are kept in leaks.
+ */
+size_t churn(int id, std::vector<char*>& leaks)
+{
+    auto gen = std::mt19937{static_cast<unsigned>(id)};
+    auto size = std::uniform_int_distribution<size_t>{1, 1024};
+    auto live = std::vector<std::pair<char*, size_t>>{};
+    int user = id;  // a user pointer, registered without size
+    debug_pushPosition(__FILE__, id, __FUNCTION__);
+    for (int round = 0; round < 200; ++round) {
+        debug_remember(int*, &user);
+        for (int i = 0; i < 64; ++i) {
+            const auto n = size(gen);
+            live.emplace_back(new char[n], n);
+        }
+        debug_forget(&user);
+        if (round + 1 == 200)
+            break;
+        for (auto& [p, n] : live) {
+            debug_pop();
+            delete[] p;
+        }
+        live.clear();
+    }
+    size_t left = 0;
+    for (auto& [p, n] : live) {
+        leaks.push_back(p);
+        left += n;
+    }
+    return left;
+}
+}  // namespace
+
+TEST_CASE("new monitor accounts the allocations of concurrent threads")
+{
+    auto leaks = std::vector<std::vector<char*>>(nbThreads);
+    auto left = std::vector<size_t>(nbThreads);
+    for (auto& l : leaks)
+        l.reserve(64);
+    auto threads = std::vector<std::thread>{};
+    threads.reserve(nbThreads);
+    const size_t before = debug_allocatedMemory();
+    for (int t = 0; t < nbThreads; ++t)
+        threads.emplace_back([t, &leaks, &left] { left[t] = churn(t, leaks[t]); });
+    for (auto& t : threads)
+        t.join();
+    threads.clear();
+    size_t leaked = 0;
+    for (auto n : left)
+        leaked += n;
+    CHECK(leaked > 0);
+    CHECK(debug_allocatedMemory() == before + leaked);
+    for (auto& l : leaks) {
+        for (auto* p : l) {
+            delete[] p;
+        }
+    }
+    CHECK(debug_allocatedMemory() == before);
+}
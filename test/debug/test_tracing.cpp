@@ -0,0 +1,207 @@
+#define TRACING_LEVEL 3  // without level_t::trace, to check that it is removed
+#include "debug/tracing.h"
+#include <doctest/doctest.h>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+std::vector<std::string> lines(const std::string& text)
+{
+    auto res = std::vector<std::string>{};
+    auto is = std::istringstream{text};
+    for (auto line = std::string{}; std::getline(is, line);)
+        res.push_back(line);
+    return res;
+}
+
+struct point_t
+{
+    int x, y;
+};
+std::ostream& operator<<(std::ostream& os, const point_t& p) { return os << '(' << p.x << ',' << p.y << ')'; }
+
+struct text_t  // not trivially copyable
+{
+    std::string text;
+};
+std::ostream& operator<<(std::ostream& os, const text_t& t) { return os << t.text; }
+}  // namespace
+
+TEST_CASE("trace_t logs synchronously by default")
+{
+    auto os = std::ostringstream{};
+    auto trace = tracing::trace_t{os};
+    const auto a = trace.add("A");
+    trace.async(a, "x=", 1);
+    CHECK(os.str() == "[A] x=1\n");
+}
+
+TEST_CASE("trace_buffer decodes the arguments")
+{
+    auto os = std::ostringstream{};
+    auto trace = tracing::trace_t{os};
+    trace.set_async(4096);
+    const auto a = trace.add("A");
+    const auto hidden = trace.add_("H");
+    auto name = std::string{"name"};
+    const char* literal = "literal";
+    trace.async(a, name, ' ', literal, ' ', 42, ' ', 2.5, ' ', point_t{1, 2}, ' ', text_t{"text"});
+    trace.async(hidden, "not shown");
+    CHECK(os.str().empty());
+    trace.flush();
+    CHECK(os.str() == "[A] name literal 42 2.5 (1,2) text\n");
+    CHECK(trace.dropped() == 0);
+}
+
+TEST_CASE("trace_buffer merges the threads in time order")
+{
+    auto os = std::ostringstream{};
+    auto trace = tracing::trace_t{os};
+    trace.set_async();
+    const auto a = trace.add("A");
+    const auto b = trace.add("B");
+    trace.async(a, 0);
+    auto other = std::thread{[&] { trace.async(b, 1); }};
+    other.join();
+    trace.async(a, 2);
+    trace.flush();
+    CHECK(os.str() == "[A] 0\n[B] 1\n[A] 2\n");
+}
+
+TEST_CASE("trace_buffer drops what does not fit")
+{
+    auto os = std::ostringstream{};
+    auto trace = tracing::trace_t{os};
+    trace.set_async(256);
+    const auto a = trace.add("A");
+    for (int i = 0; i < 100; ++i)
+        trace.async(a, i);
+    trace.flush();
+    const auto shown = lines(os.str()).size();
+    CHECK(shown > 0);
+    CHECK(shown < 100);
+    CHECK(shown + trace.dropped() == 100);
+    // the space is reused after the flush
+    trace.async(a, "again");
+    trace.flush();
+    CHECK(lines(os.str()).back() == "[A] again");
+}
+
+TEST_CASE("trace_t writer formats in the background")
+{
+    auto os = std::ostringstream{};
+    {
+        auto trace = tracing::trace_t{os};
+        trace.set_async();
+        const auto a = trace.add("A");
+        trace.start_writer(1ms);
+        auto threads = std::vector<std::thread>{};
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&trace, a, t] {
+                for (int i = 0; i < 1000; ++i) {
+                    trace.async(a, t, ':', i);
+                    if (i % 100 == 0)
+                        std::this_thread::sleep_for(1ms);
+                }
+            });
+        for (auto& t : threads)
+            t.join();
+        CHECK(trace.dropped() == 0);
+    }  // the rest is flushed by the destructor
+    const auto all = lines(os.str());
+    REQUIRE(all.size() == 4000);
+    // the messages of each thread keep their order
+    auto next = std::vector<int>(4, 0);
+    for (const auto& line : all) {
+        const auto t = line[4] - '0';
+        REQUIRE(t >= 0);
+        REQUIRE(t < 4);
+        CHECK(line == "[A] " + std::to_string(t) + ":" + std::to_string(next[t]));
+        ++next[t];
+    }
+}
+
+TEST_CASE("trace_t formats by the format string")
+{
+    auto os = std::ostringstream{};
+    auto trace = tracing::trace_t{os};
+    const auto a = trace.add("A");
+    trace.format(a, "x = {}, p = {} {{}}", 1, point_t{2, 3});
+    trace.format(a, "no arguments");
+    trace.format(a, "{}{}", "a", std::string{"b"});
+    CHECK(os.str() == "[A] x = 1, p = (2,3) {}\n[A] no arguments\n[A] ab\n");
+}
+
+TEST_CASE("trace_t skips the hidden actors")
+{
+    auto os = std::ostringstream{};
+    auto trace = tracing::trace_t{os};
+    const auto a = trace.add("A");
+    const auto hidden = trace.add_("H");
+    auto evaluated = 0;
+    auto value = [&evaluated] { return ++evaluated; };
+    TRACE(trace, hidden, "{}", value());
+    CHECK(evaluated == 0);
+    TRACE(trace, a, "{}", value());
+    CHECK(evaluated == 1);
+    // above the compiled level: removed even if shown
+    TRACE_AT(tracing::level_t::trace, trace, a, "{}", value());
+    CHECK(evaluated == 1);
+    TRACE_AT(tracing::level_t::debug, trace, a, "{}", value());
+    CHECK(evaluated == 2);
+    CHECK(!tracing::compiled(tracing::level_t::trace));
+    CHECK(os.str() == "[A] 1\n[A] 2\n");
+}
+
+TEST_CASE("trace_t records the hidden actors")
+{
+    auto os = std::ostringstream{};
+    auto trace = tracing::trace_t{os, true};
+    const auto hidden = trace.add_("H");
+    auto evaluated = 0;
+    TRACE(trace, hidden, "{}", ++evaluated);
+    CHECK(evaluated == 1);
+    CHECK(os.str().empty());
+    trace.show(hidden, true);
+    trace.dump(os);
+    CHECK(os.str() == "[H] 1\n");
+}
+
+TEST_CASE("trace_buffer reuses the rings of the exited threads")
+{
+    auto os = std::ostringstream{};
+    auto trace = tracing::trace_t{os};
+    trace.set_async(4096);
+    const auto a = trace.add("A");
+    for (int t = 0; t < 10; ++t) {
+        auto other = std::thread{[&trace, a, t] { trace.async(a, t); }};
+        other.join();
+    }
+    auto buffer = tracing::trace_buffer{4096};
+    for (int t = 0; t < 10; ++t) {
+        auto other = std::thread{[&buffer] { buffer.record(0, 1); }};
+        other.join();
+    }
+    CHECK(buffer.nb_rings() == 1);
+    trace.flush();
+    CHECK(lines(os.str()).size() == 10);
+    CHECK(lines(os.str()).back() == "[A] 9");
+}
+
+TEST_CASE("trace_buffer forgets the destroyed buffers")
+{
+    for (int i = 0; i < 3; ++i) {
+        auto buffer = tracing::trace_buffer{4096};
+        buffer.record(0, i);
+        auto taken = std::vector<std::string>{};
+        buffer.drain([&taken](auto, uint32_t, std::string_view msg) { taken.emplace_back(msg); });
+        REQUIRE(taken.size() == 1);
+        CHECK(taken.front() == std::to_string(i));
+        CHECK(buffer.nb_rings() == 1);
+    }
+}